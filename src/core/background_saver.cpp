@@ -0,0 +1,209 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "background_saver.h"
+#include "data.h"
+#include "file_io.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "sqlite_store.h"
+
+#include <utility>
+
+using namespace pointless::core;
+
+BackgroundSaver::BackgroundSaver()
+    : _thread([this](const std::stop_token &stopToken) { run(stopToken); })
+{
+}
+
+BackgroundSaver::~BackgroundSaver()
+{
+    if (auto result = flush(); !result) {
+        P_LOG_ERROR("Failed to save data to disk: {}", result.error());
+    }
+}
+
+void BackgroundSaver::enqueue(Request request)
+{
+    std::unique_lock lock(_mutex);
+
+    // Requests for different files can't be merged
+    if (_pending && _pending->filename != request.filename) {
+        _condition.wait(lock, [this] { return !_pending; });
+    }
+
+    if (!_pending || request.snapshot) {
+        // A snapshot already contains whatever the pending request would have written
+        _pending = std::move(request);
+    } else {
+        auto &records = _pending->records;
+        records.insert(records.end(), std::make_move_iterator(request.records.begin()), std::make_move_iterator(request.records.end()));
+    }
+
+    _condition.notify_all();
+}
+
+std::expected<void, std::string> BackgroundSaver::flush()
+{
+    std::unique_lock lock(_mutex);
+    _condition.wait(lock, [this] { return !_pending && !_busy; });
+
+    if (auto error = std::exchange(_error, std::nullopt)) {
+        return std::unexpected(*error);
+    }
+    return {};
+}
+
+bool BackgroundSaver::isWritingSnapshot()
+{
+    std::lock_guard lock(_mutex);
+    return _busyWithSnapshot || (_pending && _pending->snapshot);
+}
+
+bool BackgroundSaver::isOwnWrite(const std::string &path)
+{
+    const auto stamp = fileStamp(path);
+    std::lock_guard lock(_mutex);
+    const auto it = _writtenStamps.find(path);
+    return it != _writtenStamps.end() && it->second == stamp;
+}
+
+bool BackgroundSaver::takeFailure()
+{
+    std::lock_guard lock(_mutex);
+    return std::exchange(_failed, false);
+}
+
+void BackgroundSaver::run(const std::stop_token &stopToken)
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _condition.wait(lock, stopToken, [this] { return _pending.has_value(); });
+        if (!_pending)
+            return;
+
+        const Request request = std::move(*_pending);
+        _pending.reset();
+        _busy = true;
+        _busyWithSnapshot = request.snapshot != nullptr;
+        lock.unlock();
+
+        auto result = process(request);
+        std::vector<std::pair<std::string, std::optional<FileStamp>>> stamps;
+        for (auto &path : writtenFiles(request.filename, request.sqlite)) {
+            auto stamp = fileStamp(path);
+            stamps.emplace_back(std::move(path), stamp);
+        }
+
+        lock.lock();
+        for (auto &[path, stamp] : stamps)
+            _writtenStamps[std::move(path)] = stamp;
+        _busy = false;
+        _busyWithSnapshot = false;
+        if (!result) {
+            P_LOG_ERROR("Failed to save data to disk: {}", result.error());
+            _failed = true;
+            if (!_error)
+                _error = result.error();
+        }
+        _condition.notify_all();
+    }
+}
+
+std::vector<std::string> BackgroundSaver::writtenFiles(const std::string &filename, bool sqlite)
+{
+    if (sqlite) {
+        // In WAL mode a write lands in the -wal file, and in the database itself once checkpointed
+        const auto database = SqliteStore::pathFor(filename);
+        return { database, database + "-wal" };
+    }
+
+    return { filename, OperationLog::pathFor(filename) };
+}
+
+std::expected<void, std::string> BackgroundSaver::process(const Request &request)
+{
+    if (request.sqlite)
+        return processInDatabase(request);
+
+    OperationLog &log = _logs.try_emplace(request.filename, OperationLog::pathFor(request.filename)).first->second;
+
+    if (request.snapshot) {
+        auto result = writeSnapshot(*request.snapshot, request.filename, request.binary);
+        if (!result)
+            return result;
+
+        // If this is lost in a crash the log still names the previous snapshot, so it isn't replayed
+        log.remove();
+    }
+
+    if (!request.records.empty()) {
+        auto snapshot = snapshotIdOf(request.filename);
+        if (!snapshot)
+            return std::unexpected(snapshot.error());
+
+        P_LOG_DEBUG("Appending {} records to operation log", request.records.size());
+        return log.append(request.records, *snapshot);
+    }
+
+    return {};
+}
+
+std::expected<OperationLog::SnapshotId, std::string> BackgroundSaver::snapshotIdOf(const std::string &filename)
+{
+    const auto stamp = fileStamp(filename);
+    if (!stamp) {
+        // Loading finds no snapshot and doesn't replay the log either
+        return OperationLog::SnapshotId {};
+    }
+
+    if (auto it = _knownSnapshots.find(filename); it != _knownSnapshots.end() && it->second.stamp == *stamp) {
+        return it->second.id;
+    }
+
+    auto file = MappedFile::open(filename);
+    if (!file)
+        return std::unexpected(file.error());
+
+    const auto id = OperationLog::snapshotIdOf(file->contents());
+    _knownSnapshots[filename] = { .stamp = *stamp, .id = id };
+    return id;
+}
+
+std::expected<void, std::string> BackgroundSaver::processInDatabase(const Request &request)
+{
+    auto store = SqliteStore::open(SqliteStore::pathFor(request.filename));
+    if (!store)
+        return std::unexpected(store.error());
+
+    if (request.snapshot) {
+        P_LOG_INFO("Importing data into database, numTasks={}, revision={}", request.snapshot->taskCount(), request.snapshot->revision());
+        if (auto result = store->importData(*request.snapshot); !result)
+            return result;
+    }
+
+    if (!request.records.empty()) {
+        P_LOG_DEBUG("Applying {} records to database", request.records.size());
+        return store->apply(request.records);
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> BackgroundSaver::writeSnapshot(const Data &data, const std::string &filename, bool binary)
+{
+    P_LOG_INFO("Saving data to disk, numTasks={}, revision={}", data.taskCount(), data.revision());
+
+    if (!binary) {
+        // Streamed into the file, the document is never built in memory
+        return writeFileAtomically(filename, [&data](OutputSink &sink) { return data.writeJson(sink); });
+    }
+
+    const auto encoded = data.toBinary();
+    if (!encoded) {
+        return std::unexpected(encoded.error());
+    }
+
+    return writeFileAtomically(filename, *encoded);
+}
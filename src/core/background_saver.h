@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "file_io.h"
+#include "operation_log.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pointless::core {
+
+class Data;
+
+/// Writes the local data file on a worker thread, in request order.
+/// A request made while another one is still waiting is merged into it, so a burst of saves
+/// costs one write. Destruction flushes.
+class BackgroundSaver
+{
+public:
+    struct Request
+    {
+        std::string filename;
+
+        /// Written first when set, replacing the data file and dropping its operation log
+        std::shared_ptr<const Data> snapshot;
+        bool binary = false;
+
+        /// Written to the SQLite store instead, the snapshot as a full import and the records as row updates
+        bool sqlite = false;
+
+        /// Appended to the operation log, after the snapshot if there is one
+        std::vector<OperationLog::Record> records;
+    };
+
+    BackgroundSaver();
+    ~BackgroundSaver();
+
+    BackgroundSaver(const BackgroundSaver &) = delete;
+    BackgroundSaver &operator=(const BackgroundSaver &) = delete;
+    BackgroundSaver(BackgroundSaver &&) = delete;
+    BackgroundSaver &operator=(BackgroundSaver &&) = delete;
+
+    void enqueue(Request request);
+
+    /// Blocks until every request is on disk. Returns the first failure since the previous flush
+    [[nodiscard]] std::expected<void, std::string> flush();
+
+    /// Whether a write failed since the last call. The operation log may then be missing edits
+    [[nodiscard]] bool takeFailure();
+
+    /// Whether a snapshot is queued or being written, so the log is about to be dropped
+    [[nodiscard]] bool isWritingSnapshot();
+
+    /// Whether @p path is still as the last write left it, to tell our own saves from other
+    /// processes writing the file. False for files not written yet
+    [[nodiscard]] bool isOwnWrite(const std::string &path);
+
+    /// The files a request for @p filename writes, where other processes' writes to the data show up too
+    static std::vector<std::string> writtenFiles(const std::string &filename, bool sqlite);
+
+    static std::expected<void, std::string> writeSnapshot(const Data &data, const std::string &filename, bool binary);
+
+private:
+    struct KnownSnapshot
+    {
+        FileStamp stamp;
+        OperationLog::SnapshotId id;
+    };
+
+    void run(const std::stop_token &stopToken);
+    std::expected<void, std::string> process(const Request &request);
+    static std::expected<void, std::string> processInDatabase(const Request &request);
+
+    /// What the log appended to @p filename has to name. Cached while the file is unchanged, a
+    /// snapshot is only read back when a new log is started after it
+    std::expected<OperationLog::SnapshotId, std::string> snapshotIdOf(const std::string &filename);
+
+    std::mutex _mutex;
+    std::condition_variable_any _condition;
+    std::optional<Request> _pending;
+    bool _busy = false;
+    bool _busyWithSnapshot = false;
+    bool _failed = false;
+    std::optional<std::string> _error;
+    std::unordered_map<std::string, std::optional<FileStamp>> _writtenStamps;
+
+    // Only used by the worker. The logs are kept so each append knows whether the file is still
+    // as its previous one left it, and only checks it for a torn tail when it isn't
+    std::unordered_map<std::string, KnownSnapshot> _knownSnapshots;
+    std::unordered_map<std::string, OperationLog> _logs;
+
+    // Last, so the worker stops before the state above goes away
+    std::jthread _thread;
+};
+
+}
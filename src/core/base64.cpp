@@ -0,0 +1,339 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "base64.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define POINTLESS_X86_DISPATCH
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define POINTLESS_NEON
+#endif
+
+using namespace pointless::core;
+
+namespace {
+
+constexpr auto DecodeTable = [] {
+    std::array<int8_t, 256> values {};
+    values.fill(Base64::InvalidValue);
+    for (size_t i = 0; i < Base64::Alphabet.size(); ++i) {
+        values[static_cast<uint8_t>(Base64::Alphabet[i])] = static_cast<int8_t>(i);
+    }
+    return values;
+}();
+
+// The SIMD kernels work on whole blocks and return how much input they consumed, a multiple of
+// 3 bytes or 4 characters. Decoding stops before a block with a character outside the alphabet,
+// the scalar code finishes what's left and finds the exact offset
+using EncodeKernel = size_t (*)(const uint8_t *input, size_t size, char *output);
+using DecodeKernel = size_t (*)(const char *input, size_t size, uint8_t *output);
+
+size_t encodeNone(const uint8_t * /*input*/, size_t /*size*/, char * /*output*/)
+{
+    return 0;
+}
+
+size_t decodeNone(const char * /*input*/, size_t /*size*/, uint8_t * /*output*/)
+{
+    return 0;
+}
+
+#ifdef POINTLESS_X86_DISPATCH
+
+// Wojciech Muła's and Daniel Lemire's pshufb based codec, the AVX2 kernels run the same steps
+// on both 128-bit lanes
+
+__attribute__((target("ssse3"))) __m128i encodeIndicesSsse3(__m128i input)
+{
+    // Each 32-bit lane gets the 3 bytes of one triple, then the 4 indices are moved into place
+    input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3"))) __m128i encodeCharsSsse3(__m128i indices)
+{
+    // 0-25 map to 13, 26-51 to 0, 52-61 to 1-10, 62 to 11 and 63 to 12, each selecting its offset
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+__attribute__((target("ssse3"))) size_t encodeSsse3(const uint8_t *input, size_t size, char *output)
+{
+    // 12 bytes per block, loaded as 16
+    size_t i = 0;
+    for (; i + 16 <= size; i += 12) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)); // NOLINT
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + (i / 3 * 4)), encodeCharsSsse3(encodeIndicesSsse3(block))); // NOLINT
+    }
+    return i;
+}
+
+// Zero for a valid character, the high nibble selects a bit that the low nibble's entry has
+// set when the character isn't in the alphabet
+__attribute__((target("ssse3"))) bool decodeBlockSsse3(const char *input, uint8_t *output)
+{
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input)); // NOLINT
+    const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), _mm_set1_epi8(0x0f));
+    const __m128i lowNibbles = _mm_and_si128(chars, _mm_set1_epi8(0x0f));
+
+    const __m128i lowLut = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i highLut = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lowLut, lowNibbles), _mm_shuffle_epi8(highLut, highNibbles));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+
+    // '/' is the only character whose range isn't given by its high nibble
+    const __m128i rollLut = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i isSlash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    const __m128i values = _mm_add_epi8(chars, _mm_shuffle_epi8(rollLut, _mm_add_epi8(isSlash, highNibbles)));
+
+    // Packs 4 6-bit values into 3 bytes per 32-bit lane, then the lanes' bytes together
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i packed = _mm_shuffle_epi8(lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    alignas(16) std::array<uint8_t, 16> bytes {};
+    _mm_store_si128(reinterpret_cast<__m128i *>(bytes.data()), packed); // NOLINT
+    std::memcpy(output, bytes.data(), 12);
+    return true;
+}
+
+__attribute__((target("ssse3"))) size_t decodeSsse3(const char *input, size_t size, uint8_t *output)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        if (!decodeBlockSsse3(input + i, output + (i / 4 * 3)))
+            break;
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) __m256i broadcast(__m128i value)
+{
+    return _mm256_broadcastsi128_si256(value);
+}
+
+__attribute__((target("avx2"))) size_t encodeAvx2(const uint8_t *input, size_t size, char *output)
+{
+    const __m256i shuffle = broadcast(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i offsets = broadcast(_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                    '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+
+    // 24 bytes per block, 12 in each lane
+    size_t i = 0;
+    for (; i + 28 <= size; i += 24) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)); // NOLINT
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i + 12)); // NOLINT
+        const __m256i block = _mm256_shuffle_epi8(_mm256_set_m128i(high, low), shuffle);
+
+        const __m256i t0 = _mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        range = _mm256_or_si256(range, _mm256_and_si256(isUpper, _mm256_set1_epi8(13)));
+        const __m256i chars = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + (i / 3 * 4)), chars); // NOLINT
+    }
+
+    return i + encodeSsse3(input + i, size - i, output + (i / 3 * 4));
+}
+
+__attribute__((target("avx2"))) size_t decodeAvx2(const char *input, size_t size, uint8_t *output)
+{
+    const __m256i lowLut = broadcast(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A));
+    const __m256i highLut = broadcast(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+    const __m256i rollLut = broadcast(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i packShuffle = broadcast(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    // 32 characters per block, 16 in each lane
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i)); // NOLINT
+        const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(chars, 4), _mm256_set1_epi8(0x0f));
+        const __m256i lowNibbles = _mm256_and_si256(chars, _mm256_set1_epi8(0x0f));
+        const __m256i invalid = _mm256_and_si256(_mm256_shuffle_epi8(lowLut, lowNibbles), _mm256_shuffle_epi8(highLut, highNibbles));
+        if (!_mm256_testz_si256(invalid, invalid))
+            break;
+
+        const __m256i isSlash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+        const __m256i values = _mm256_add_epi8(chars, _mm256_shuffle_epi8(rollLut, _mm256_add_epi8(isSlash, highNibbles)));
+        const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i lanes = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        const __m256i packed = _mm256_shuffle_epi8(lanes, packShuffle);
+
+        alignas(32) std::array<uint8_t, 32> bytes {};
+        _mm256_store_si256(reinterpret_cast<__m256i *>(bytes.data()), packed); // NOLINT
+        uint8_t *out = output + (i / 4 * 3);
+        std::memcpy(out, bytes.data(), 12);
+        std::memcpy(out + 12, bytes.data() + 16, 12);
+    }
+
+    return i + decodeSsse3(input + i, size - i, output + (i / 4 * 3));
+}
+
+#endif
+
+#ifdef POINTLESS_NEON
+
+constexpr auto NeonDecodeTable = [] {
+    std::array<uint8_t, 128> values {};
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<uint8_t>(DecodeTable[i]); // 0xFF when invalid
+    }
+    return values;
+}();
+
+uint8x16x4_t loadTable(const uint8_t *table)
+{
+    return { { vld1q_u8(table), vld1q_u8(table + 16), vld1q_u8(table + 32), vld1q_u8(table + 48) } };
+}
+
+size_t encodeNeon(const uint8_t *input, size_t size, char *output)
+{
+    const uint8x16x4_t alphabet = loadTable(reinterpret_cast<const uint8_t *>(Base64::Alphabet.data())); // NOLINT
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+    // 48 bytes per block, deinterleaved into the first, second and third byte of 16 triples
+    size_t i = 0;
+    for (; i + 48 <= size; i += 48) {
+        const uint8x16x3_t triples = vld3q_u8(input + i);
+        uint8x16x4_t quads;
+        quads.val[0] = vshrq_n_u8(triples.val[0], 2);
+        quads.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(triples.val[0], 4), vshrq_n_u8(triples.val[1], 4)), mask);
+        quads.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(triples.val[1], 2), vshrq_n_u8(triples.val[2], 6)), mask);
+        quads.val[3] = vandq_u8(triples.val[2], mask);
+        for (auto &chars : quads.val) {
+            chars = vqtbl4q_u8(alphabet, chars);
+        }
+        vst4q_u8(reinterpret_cast<uint8_t *>(output + (i / 3 * 4)), quads); // NOLINT
+    }
+    return i;
+}
+
+size_t decodeNeon(const char *input, size_t size, uint8_t *output)
+{
+    const uint8x16x4_t lowTable = loadTable(NeonDecodeTable.data());
+    const uint8x16x4_t highTable = loadTable(NeonDecodeTable.data() + 64);
+
+    // 64 characters per block, deinterleaved into the 4 characters of 16 quads
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint8x16x4_t quads = vld4q_u8(reinterpret_cast<const uint8_t *>(input + i)); // NOLINT
+        uint8x16_t invalid = vdupq_n_u8(0);
+        for (auto &value : quads.val) {
+            const uint8x16_t chars = value;
+            // Out of range indices give 0 with tbl and keep the value with tbx, non-ASCII is flagged apart
+            value = vqtbl4q_u8(lowTable, chars);
+            value = vqtbx4q_u8(value, highTable, veorq_u8(chars, vdupq_n_u8(0x40)));
+            value = vorrq_u8(value, vcgeq_u8(chars, vdupq_n_u8(0x80)));
+            invalid = vorrq_u8(invalid, value);
+        }
+        if (vmaxvq_u8(invalid) > 0x3F)
+            break;
+
+        uint8x16x3_t bytes;
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(quads.val[0], 2), vshrq_n_u8(quads.val[1], 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(quads.val[1], 4), vshrq_n_u8(quads.val[2], 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(quads.val[2], 6), quads.val[3]);
+        vst3q_u8(output + (i / 4 * 3), bytes);
+    }
+    return i;
+}
+
+#endif
+
+struct Kernels
+{
+    EncodeKernel encode = encodeNone;
+    DecodeKernel decode = decodeNone;
+    const char *name = "scalar";
+};
+
+const Kernels &kernels()
+{
+    static const Kernels picked = [] {
+#if defined(POINTLESS_X86_DISPATCH)
+        if (__builtin_cpu_supports("avx2"))
+            return Kernels { encodeAvx2, decodeAvx2, "avx2" };
+        if (__builtin_cpu_supports("ssse3"))
+            return Kernels { encodeSsse3, decodeSsse3, "ssse3" };
+#elif defined(POINTLESS_NEON)
+        return Kernels { encodeNeon, decodeNeon, "neon" };
+#endif
+        return Kernels {};
+    }();
+    return picked;
+}
+
+}
+
+int8_t Base64::valueOf(char c)
+{
+    return DecodeTable[static_cast<uint8_t>(c)];
+}
+
+void Base64::encodeTriplesScalar(std::span<const uint8_t> input, char *output)
+{
+    for (size_t i = 0; i + 3 <= input.size(); i += 3, output += 4) {
+        const uint32_t value = (uint32_t(input[i]) << 16U) | (uint32_t(input[i + 1]) << 8U) | uint32_t(input[i + 2]);
+        output[0] = Alphabet[(value >> 18U) & 0x3FU];
+        output[1] = Alphabet[(value >> 12U) & 0x3FU];
+        output[2] = Alphabet[(value >> 6U) & 0x3FU];
+        output[3] = Alphabet[value & 0x3FU];
+    }
+}
+
+std::optional<size_t> Base64::decodeQuadsScalar(std::string_view input, uint8_t *output)
+{
+    for (size_t i = 0; i + 4 <= input.size(); i += 4, output += 3) {
+        uint32_t quad = 0;
+        for (size_t j = 0; j < 4; ++j) {
+            const int8_t value = DecodeTable[static_cast<uint8_t>(input[i + j])];
+            if (value == InvalidValue)
+                return i + j;
+            quad = (quad << 6U) | static_cast<uint32_t>(value);
+        }
+        output[0] = static_cast<uint8_t>(quad >> 16U);
+        output[1] = static_cast<uint8_t>(quad >> 8U);
+        output[2] = static_cast<uint8_t>(quad);
+    }
+    return std::nullopt;
+}
+
+void Base64::encodeTriples(std::span<const uint8_t> input, char *output)
+{
+    const size_t done = kernels().encode(input.data(), input.size(), output);
+    encodeTriplesScalar(input.subspan(done), output + (done / 3 * 4));
+}
+
+std::optional<size_t> Base64::decodeQuads(std::string_view input, uint8_t *output)
+{
+    const size_t done = kernels().decode(input.data(), input.size(), output);
+    if (auto invalid = decodeQuadsScalar(input.substr(done), output + (done / 4 * 3)))
+        return done + *invalid;
+    return std::nullopt;
+}
+
+const char *Base64::kernelName()
+{
+    return kernels().name;
+}
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace pointless::core::Base64 {
+
+/// Standard alphabet
+constexpr std::string_view Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr int8_t InvalidValue = -1;
+
+/// 0-63 for a character of the alphabet, InvalidValue otherwise
+[[nodiscard]] int8_t valueOf(char c);
+
+/// Encodes @p input, a multiple of 3 bytes, into 4/3 as many characters at @p output
+void encodeTriples(std::span<const uint8_t> input, char *output);
+
+/// Decodes @p input, a multiple of 4 characters without padding, into 3/4 as many bytes at @p output.
+/// Returns the offset of the first character outside the alphabet, the quads before it are decoded
+[[nodiscard]] std::optional<size_t> decodeQuads(std::string_view input, uint8_t *output);
+
+/// The same, a byte at a time with a lookup table, for comparison
+void encodeTriplesScalar(std::span<const uint8_t> input, char *output);
+[[nodiscard]] std::optional<size_t> decodeQuadsScalar(std::string_view input, uint8_t *output);
+
+/// Name of the kernel picked for this CPU, for logs and tests
+const char *kernelName();
+
+}
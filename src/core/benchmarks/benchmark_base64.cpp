@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+// Base64 throughput of the kernel picked for this CPU, the scalar code and the decoder
+// SupabaseProvider used before, on about the size of a large pushed document. Not a test, run it
+// by hand:
+//   benchmark_base64
+
+#include "base64.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pointless::core;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t size, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto &byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+// What SupabaseProvider decoded with before
+std::vector<uint8_t> previousDecode(const std::string &input)
+{
+    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<uint8_t> result;
+
+    uint32_t val = 0;
+    int32_t valb = -8;
+    for (unsigned char c : input) {
+        auto pos = chars.find(static_cast<char>(c));
+        if (pos == std::string::npos)
+            break;
+        val = (val << 6U) + static_cast<uint32_t>(pos);
+        valb += 6;
+        if (valb >= 0) {
+            result.push_back(static_cast<uint8_t>((val >> static_cast<uint32_t>(valb)) & 0xFFU));
+            valb -= 8;
+        }
+    }
+    return result;
+}
+
+template<typename Function>
+double megabytesPerSecond(size_t bytes, int iterations, Function &&function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(bytes) * iterations / elapsed.count() / 1e6;
+}
+
+}
+
+int main()
+{
+    const auto bytes = randomBytes(3 * 1024 * 1024, 7);
+    std::string encoded(bytes.size() / 3 * 4, '\0');
+    Base64::encodeTriples(bytes, encoded.data());
+    std::vector<uint8_t> decoded(bytes.size());
+    std::string reencoded(encoded.size(), '\0');
+
+    bool ok = true;
+    const double previous = megabytesPerSecond(encoded.size(), 3, [&] {
+        ok = ok && previousDecode(encoded) == bytes;
+    });
+    const double scalarDecode = megabytesPerSecond(encoded.size(), 10, [&] {
+        ok = ok && !Base64::decodeQuadsScalar(encoded, decoded.data());
+    });
+    const double kernelDecode = megabytesPerSecond(encoded.size(), 10, [&] {
+        ok = ok && !Base64::decodeQuads(encoded, decoded.data());
+    });
+    const double scalarEncode = megabytesPerSecond(bytes.size(), 10, [&] {
+        Base64::encodeTriplesScalar(bytes, reencoded.data());
+    });
+    const double kernelEncode = megabytesPerSecond(bytes.size(), 10, [&] {
+        Base64::encodeTriples(bytes, reencoded.data());
+    });
+
+    if (!ok || decoded != bytes || reencoded != encoded) {
+        std::cerr << "Base64 round trip failed with " << Base64::kernelName() << "\n";
+        return 1;
+    }
+
+    std::cout << "Base64 MB/s with " << Base64::kernelName() << ":\n"
+              << "  decode: previous " << previous << ", scalar " << scalarDecode << ", kernel " << kernelDecode << "\n"
+              << "  encode: scalar " << scalarEncode << ", kernel " << kernelEncode << "\n";
+    return 0;
+}
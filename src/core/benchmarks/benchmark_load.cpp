@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+// Compares loading the data from a JSON file with loading it from a binary snapshot, for the
+// tests/test.json fixture scaled up to 100k tasks. Not a test, run it by hand:
+//   benchmark_load [task_count] [runs]
+
+#include "context.h"
+#include "data.h"
+#include "local_data.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace pointless;
+
+namespace {
+
+constexpr size_t kDefaultTaskCount = 100000;
+constexpr int kDefaultRuns = 5;
+
+/// The best of @p runs loads of @p path, or a negative duration if a load failed
+std::chrono::milliseconds timeLoad(const core::LocalData &localData, const std::filesystem::path &path, size_t taskCount, int runs)
+{
+    auto best = std::chrono::milliseconds::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        auto loaded = localData.loadDataFromFile(path.string());
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        if (!loaded || loaded->taskCount() != taskCount) {
+            P_LOG_ERROR("Failed to load {}: {}", path.string(), loaded ? "wrong task count" : loaded.error());
+            return std::chrono::milliseconds(-1);
+        }
+        best = std::min(best, elapsed);
+    }
+
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    try {
+        core::Logger::initLogLevel();
+
+        const size_t taskCount = argc > 1 ? std::stoul(argv[1]) : kDefaultTaskCount;
+        const int runs = argc > 2 ? std::stoi(argv[2]) : kDefaultRuns;
+
+        const std::filesystem::path dir = std::filesystem::temp_directory_path() / "pointless_benchmark_load";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        core::Context::setContext(core::Context(IDataProvider::Type::TestsLocal, dir / "pointless.json"));
+
+        core::LocalData localData;
+        const auto fixture = localData.loadDataFromFile(POINTLESS_SOURCE_DIR "/src/core/tests/test.json");
+        if (!fixture || fixture->taskCount() == 0) {
+            P_LOG_ERROR("Failed to load the test.json fixture");
+            return 1;
+        }
+
+        core::Data scaled = *fixture;
+        scaled.clearTasks();
+        for (size_t i = 0; i < taskCount; ++i) {
+            core::Task task = fixture->taskAt(i % fixture->taskCount());
+            task.uuid = "task-" + std::to_string(i);
+            scaled.addTask(task);
+        }
+
+        const auto jsonFile = dir / "data.json";
+        const auto binaryFile = dir / "data.bin";
+        std::ofstream(jsonFile, std::ios::binary) << scaled.toJson().value_or("");
+        std::ofstream(binaryFile, std::ios::binary) << scaled.toBinary().value_or("");
+
+        const auto jsonTime = timeLoad(localData, jsonFile, taskCount, runs);
+        const auto binaryTime = timeLoad(localData, binaryFile, taskCount, runs);
+        const auto jsonSize = std::filesystem::file_size(jsonFile);
+        const auto binarySize = std::filesystem::file_size(binaryFile);
+        std::filesystem::remove_all(dir);
+        if (jsonTime.count() < 0 || binaryTime.count() < 0)
+            return 1;
+
+        std::cout << "Loading " << taskCount << " tasks, best of " << runs << " runs:\n"
+                  << "  JSON   " << jsonTime.count() << "ms, " << jsonSize << " bytes\n"
+                  << "  binary " << binaryTime.count() << "ms, " << binarySize << " bytes\n";
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
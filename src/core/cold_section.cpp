@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "cold_section.h"
+#include "logger.h"
+#include "task.h"
+
+#include <glaze/glaze.hpp>
+
+#include <optional>
+
+using namespace pointless::core;
+
+namespace {
+
+struct EncodedEntry
+{
+    std::optional<std::string_view> description;
+    std::vector<int> lastCompletions;
+};
+
+struct DecodedEntry
+{
+    std::optional<std::string> description;
+    std::vector<int> lastCompletions;
+};
+
+constexpr size_t U64Size = 8;
+
+void putU64(std::string &out, uint64_t value)
+{
+    for (size_t i = 0; i < U64Size; ++i) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+uint64_t getU64(std::string_view in)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < U64Size; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (i * 8);
+    }
+    return value;
+}
+
+}
+
+template<>
+struct glz::meta<EncodedEntry>
+{
+    using T = EncodedEntry;
+    static constexpr auto value = object("description", &T::description, "lastCompletions", &T::lastCompletions);
+};
+
+template<>
+struct glz::meta<DecodedEntry>
+{
+    using T = DecodedEntry;
+    static constexpr auto value = object("description", &T::description, "lastCompletions", &T::lastCompletions);
+};
+
+// Layout: the entry count, then the offset of each entry and the end of the last one, relative to
+// the first entry, then the entries as BEVE. All integers are 64-bit little endian
+std::expected<std::shared_ptr<const ColdSection>, std::string> ColdSection::open(std::string bytes, size_t taskCount)
+{
+    if (bytes.size() < U64Size || getU64(bytes) != taskCount) {
+        return std::unexpected("Cold section doesn't match the tasks");
+    }
+
+    const size_t tableSize = (taskCount + 1) * U64Size;
+    if (bytes.size() - U64Size < tableSize) {
+        return std::unexpected("Truncated cold section");
+    }
+
+    const size_t entriesStart = U64Size + tableSize;
+    std::vector<uint64_t> offsets;
+    offsets.reserve(taskCount + 1);
+    for (size_t i = 0; i <= taskCount; ++i) {
+        const uint64_t offset = entriesStart + getU64(std::string_view(bytes).substr(U64Size + (i * U64Size)));
+        if (offset > bytes.size() || (!offsets.empty() && offset < offsets.back())) {
+            return std::unexpected("Corrupt cold section offsets");
+        }
+        offsets.push_back(offset);
+    }
+
+    return std::make_shared<const ColdSection>(std::move(bytes), std::move(offsets));
+}
+
+std::expected<void, std::string> ColdSection::encode(std::span<const Task> tasks, std::string &out)
+{
+    putU64(out, tasks.size());
+    const size_t tableStart = out.size();
+    out.append((tasks.size() + 1) * U64Size, '\0');
+    const size_t entriesStart = out.size();
+
+    const auto setOffset = [&out, tableStart, entriesStart](size_t index) {
+        std::string offset;
+        putU64(offset, out.size() - entriesStart);
+        out.replace(tableStart + (index * U64Size), U64Size, offset);
+    };
+
+    std::string buffer;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        setOffset(i);
+        const Task &task = tasks[i];
+
+        // Untouched since they were loaded, so still encoded as they were
+        const Ref ref = task.description.coldRef();
+        if (ref.section != nullptr && ref == task.lastCompletions.coldRef()) {
+            out.append(ref.section->encodedEntry(ref.index));
+            continue;
+        }
+
+        const EncodedEntry entry {
+            .description = task.description ? std::optional<std::string_view>(*task.description) : std::nullopt,
+            .lastCompletions = task.lastCompletions.values(),
+        };
+        if (glz::write_beve(entry, buffer)) {
+            return std::unexpected("Failed to serialize the notes of task " + task.uuid.toString());
+        }
+        out.append(buffer);
+    }
+    setOffset(tasks.size());
+
+    return {};
+}
+
+ColdSection::ColdSection(std::string bytes, std::vector<uint64_t> offsets)
+    : _bytes(std::move(bytes))
+    , _offsets(std::move(offsets))
+    , _decoded(std::make_unique<std::once_flag[]>(_offsets.size() - 1))
+    , _entries(std::make_unique<Entry[]>(_offsets.size() - 1))
+{
+}
+
+const ColdSection::Entry &ColdSection::entry(uint32_t index) const
+{
+    Entry &entry = _entries[index];
+    std::call_once(_decoded[index], [this, index, &entry] {
+        DecodedEntry decoded;
+        if (auto error = glz::read_beve(decoded, encodedEntry(index))) {
+            P_LOG_WARNING_NOABORT("Failed to read the notes of task {} in the snapshot: {}", index, glz::format_error(error));
+            return;
+        }
+        if (decoded.description) {
+            entry.description = std::make_shared<const std::string>(std::move(*decoded.description));
+        }
+        entry.lastCompletions = std::move(decoded.lastCompletions);
+    });
+
+    return entry;
+}
+
+std::string_view ColdSection::encodedEntry(uint32_t index) const
+{
+    return std::string_view(_bytes).substr(_offsets[index], _offsets[index + 1] - _offsets[index]);
+}
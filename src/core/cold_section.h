@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pointless::core {
+
+class Task;
+
+/// The rarely read fields of the tasks of a binary snapshot, their notes and completion history,
+/// stored after the tasks themselves. A task keeps a handle to its entry, which is only decoded
+/// the first time it's read. Immutable once open, entries can be read from any thread.
+class ColdSection
+{
+public:
+    struct Entry
+    {
+        std::shared_ptr<const std::string> description;
+        std::vector<int> lastCompletions;
+    };
+
+    /// Where a task's cold fields are, unset while they are in memory
+    struct Ref
+    {
+        const ColdSection *section = nullptr;
+        uint32_t index = 0;
+
+        bool operator==(const Ref &other) const = default;
+    };
+
+    /// @p bytes as encode() wrote them, for @p taskCount tasks
+    static std::expected<std::shared_ptr<const ColdSection>, std::string> open(std::string bytes, size_t taskCount);
+
+    /// Appends the section for @p tasks to @p out. Entries still in another section are copied
+    /// without being decoded
+    static std::expected<void, std::string> encode(std::span<const Task> tasks, std::string &out);
+
+    explicit ColdSection(std::string bytes, std::vector<uint64_t> offsets);
+
+    /// Decoded on first use. Empty if the entry is corrupt
+    [[nodiscard]] const Entry &entry(uint32_t index) const;
+
+private:
+    [[nodiscard]] std::string_view encodedEntry(uint32_t index) const;
+
+    std::string _bytes;
+    std::vector<uint64_t> _offsets; // Of each entry in _bytes, plus the end of the last one
+    std::unique_ptr<std::once_flag[]> _decoded;
+    std::unique_ptr<Entry[]> _entries;
+};
+
+}
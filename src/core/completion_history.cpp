@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "completion_history.h"
+
+using namespace pointless::core;
+
+CompletionHistory::CompletionHistory(std::vector<int> values)
+    : _values(std::move(values))
+{
+}
+
+const std::vector<int> &CompletionHistory::values() const
+{
+    if (_deferred && _section)
+        return _section->entry(_index).lastCompletions;
+    return _values;
+}
+
+bool CompletionHistory::empty() const
+{
+    return !_deferred && _values.empty();
+}
+
+bool CompletionHistory::operator==(const CompletionHistory &other) const
+{
+    if (empty() || other.empty())
+        return empty() == other.empty();
+    const auto ref = coldRef();
+    if (ref.section != nullptr && ref == other.coldRef())
+        return true;
+    return values() == other.values();
+}
+
+CompletionHistory CompletionHistory::deferred(bool empty)
+{
+    CompletionHistory history;
+    history._deferred = !empty;
+    return history;
+}
+
+void CompletionHistory::setColdSection(const std::shared_ptr<const ColdSection> &section, uint32_t index)
+{
+    _section = section;
+    _index = index;
+}
+
+ColdSection::Ref CompletionHistory::coldRef() const
+{
+    if (!_section)
+        return {};
+    return { .section = _section.get(), .index = _index };
+}
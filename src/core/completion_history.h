@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "cold_section.h"
+
+#include <glaze/glaze.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pointless::core {
+
+/// When a recurring task was last completed. Rarely read, so like TaskNotes it stays in the cold
+/// section of a binary snapshot until it's first asked for. JSON reads and writes the plain array.
+class CompletionHistory
+{
+public:
+    CompletionHistory() = default;
+    CompletionHistory(std::vector<int> values); // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] const std::vector<int> &values() const;
+    [[nodiscard]] bool empty() const;
+
+    bool operator==(const CompletionHistory &other) const;
+
+    /// A history still in a cold section, see setColdSection()
+    static CompletionHistory deferred(bool empty);
+
+    /// Where a deferred history is read from
+    void setColdSection(const std::shared_ptr<const ColdSection> &section, uint32_t index);
+    [[nodiscard]] ColdSection::Ref coldRef() const;
+
+private:
+    std::vector<int> _values;
+
+    // Deferred and not empty, read from the section
+    std::shared_ptr<const ColdSection> _section;
+    uint32_t _index = 0;
+    bool _deferred = false;
+};
+
+}
+
+namespace glz {
+
+template<>
+struct from<JSON, pointless::core::CompletionHistory>
+{
+    template<auto Opts>
+    static void op(pointless::core::CompletionHistory &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::vector<int> values;
+        parse<JSON>::op<Opts>(values, ctx, it, end);
+        value = std::move(values);
+    }
+};
+
+template<>
+struct to<JSON, pointless::core::CompletionHistory>
+{
+    template<auto Opts>
+    static void op(const pointless::core::CompletionHistory &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        serialize<JSON>::op<Opts>(value.values(), ctx, b, ix);
+    }
+};
+
+// A binary snapshot keeps only whether there is a history with the task, Data::toBinary() writes
+// the values to its cold section
+template<>
+struct from<BEVE, pointless::core::CompletionHistory>
+{
+    template<auto Opts>
+    static void op(pointless::core::CompletionHistory &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        bool empty = true;
+        parse<BEVE>::op<Opts>(empty, ctx, it, end);
+        value = pointless::core::CompletionHistory::deferred(empty);
+    }
+};
+
+template<>
+struct to<BEVE, pointless::core::CompletionHistory>
+{
+    template<auto Opts>
+    static void op(const pointless::core::CompletionHistory &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        const bool empty = value.empty();
+        serialize<BEVE>::op<Opts>(empty, ctx, b, ix);
+    }
+};
+
+}
@@ -14,7 +14,10 @@ struct Context
 {
     enum class StartupOption : uint8_t {
         None = 0,
-        RestoreAuth = 1
+        RestoreAuth = 1,
+        BinarySnapshot = 2, // Write the local data file as a binary snapshot instead of JSON
+        SqliteStorage = 4, // Keep local data in an SQLite database next to the data file instead
+        DeltaSync = 8 // Exchange only changed tasks with the server, via its change log
     };
     static void setContext(const Context &context);
     static Context self();
@@ -40,6 +43,21 @@ struct Context
         return (_startupOptions & static_cast<unsigned int>(StartupOption::RestoreAuth)) != 0U;
     }
 
+    [[nodiscard]] bool binarySnapshot() const
+    {
+        return (_startupOptions & static_cast<unsigned int>(StartupOption::BinarySnapshot)) != 0U;
+    }
+
+    [[nodiscard]] bool sqliteStorage() const
+    {
+        return (_startupOptions & static_cast<unsigned int>(StartupOption::SqliteStorage)) != 0U;
+    }
+
+    [[nodiscard]] bool deltaSync() const
+    {
+        return (_startupOptions & static_cast<unsigned int>(StartupOption::DeltaSync)) != 0U;
+    }
+
     [[nodiscard]] bool readOnly() const
     {
         return _readOnly;
@@ -2,34 +2,112 @@
 // SPDX-License-Identifier: MIT
 
 #include "data.h"
+#include "cold_section.h"
+#include "date_utils.h"
+#include "json_scan.h"
 #include "logger.h"
+#include "output_sink.h"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <map>
+#include <thread>
 
 namespace pointless::core {
 
+namespace {
+
+constexpr auto JsonReadOpts = glz::opts {
+    .null_terminated = false, // may point into a mapped file
+    .error_on_unknown_keys = true,
+    // .error_on_missing_keys = true,
+    .skip_null_members = false,
+};
+
+// Below this the threads cost more than they save
+constexpr size_t ParallelParseThreshold = 1024 * 1024;
+constexpr size_t MinTasksPerChunk = 256;
+
+}
+
 Data::Data() = default;
 
-void Data::addTask(const Task &task)
+bool Data::addTask(const Task &task)
 {
     auto it = findTaskByUuid(task.uuid);
     if (it == _data.tasks.end()) {
         _data.tasks.push_back(task);
+        _taskIndex.insert(_data.tasks, _data.tasks.size() - 1);
+        _tagIndex.add(_data.tasks.back(), _data.tasks.size() - 1);
+        _dueDateIndex.add(_data.tasks.back(), _data.tasks.size() - 1);
+        _dirtyTasks.add(_data.tasks.back(), _data.tasks.size() - 1);
+        _columns.append(_data.tasks.back());
+        return true;
     }
+    return false;
 }
 
-bool Data::removeTask(const std::string &uuid)
+bool Data::removeTask(const Uuid &uuid)
 {
     auto it = findTaskByUuid(uuid);
     if (it != _data.tasks.end()) {
         _data.tasks.erase(it);
+        rebuildIndexes();
         return true;
     }
     return false;
 }
 
-std::optional<Task> Data::getTask(const std::string &uuid) const
+std::vector<Uuid> Data::removeTasks(std::span<const Uuid> uuids)
+{
+    std::vector<bool> doomed(_data.tasks.size());
+    size_t count = 0;
+    for (const Uuid &uuid : uuids) {
+        const auto index = indexOfTask(uuid);
+        if (index && !doomed[*index]) {
+            doomed[*index] = true;
+            ++count;
+        }
+    }
+
+    std::vector<Uuid> removed;
+    if (count == 0)
+        return removed;
+
+    removed.reserve(count);
+    size_t kept = 0;
+    for (size_t i = 0; i < _data.tasks.size(); ++i) {
+        if (doomed[i]) {
+            removed.push_back(_data.tasks[i].uuid);
+            continue;
+        }
+        if (kept != i)
+            _data.tasks[kept] = std::move(_data.tasks[i]);
+        ++kept;
+    }
+    _data.tasks.erase(_data.tasks.begin() + static_cast<std::ptrdiff_t>(kept), _data.tasks.end());
+
+    rebuildIndexes();
+    return removed;
+}
+
+void Data::deferIndexUpdates()
+{
+    _dueDateIndex.deferAdds();
+}
+
+void Data::flushIndexUpdates()
+{
+    _dueDateIndex.flushDeferred();
+}
+
+bool Data::isDeferringIndexUpdates() const
+{
+    return _dueDateIndex.isDeferring();
+}
+
+std::optional<Task> Data::getTask(const Uuid &uuid) const
 {
     auto it = findTaskByUuid(uuid);
     if (it != _data.tasks.end()) {
@@ -47,10 +125,18 @@ bool Data::updateTask(const Task &task, bool incrementTaskRevision)
 {
     auto it = findTaskByUuid(task.uuid);
     if (it != _data.tasks.end()) {
+        const auto position = static_cast<size_t>(it - _data.tasks.begin());
+        _tagIndex.remove(*it, position);
+        _dueDateIndex.remove(*it, position);
+        _dirtyTasks.remove(*it, position);
         *it = task;
         if (incrementTaskRevision) {
             it->revision++;
         }
+        _tagIndex.add(*it, position);
+        _dueDateIndex.add(*it, position);
+        _dirtyTasks.add(*it, position);
+        _columns.assign(position, *it);
         return true;
     }
     return false;
@@ -61,7 +147,15 @@ bool Data::setTask(const Task &task)
     P_LOG_DEBUG("Setting task '{}' Data={}", task.uuid, static_cast<void *>(this));
     auto it = findTaskByUuid(task.uuid);
     if (it != _data.tasks.end()) {
+        const auto position = static_cast<size_t>(it - _data.tasks.begin());
+        _tagIndex.remove(*it, position);
+        _dueDateIndex.remove(*it, position);
+        _dirtyTasks.remove(*it, position);
         *it = task;
+        _tagIndex.add(*it, position);
+        _dueDateIndex.add(*it, position);
+        _dirtyTasks.add(*it, position);
+        _columns.assign(position, *it);
         return true;
     }
     return false;
@@ -70,6 +164,11 @@ bool Data::setTask(const Task &task)
 void Data::clearTasks()
 {
     _data.tasks.clear();
+    _taskIndex.clear();
+    _tagIndex.clear();
+    _dueDateIndex.clear();
+    _dirtyTasks.clear();
+    _columns.clear();
 }
 
 size_t Data::taskCount() const
@@ -79,59 +178,8 @@ size_t Data::taskCount() const
 
 std::vector<Task> Data::getTasksByTag(const std::string &tagName) const
 {
-    std::vector<Task> result;
-    result.reserve(_data.tasks.size());
-    for (const auto &task : _data.tasks) {
-        auto tagIt = std::ranges::find(task.tags, tagName);
-        if (tagIt != task.tags.end()) {
-            result.push_back(task);
-        }
-    }
-    return result;
-}
-
-std::vector<Task> Data::getCompletedTasks() const
-{
-    std::vector<Task> result;
-    for (const auto &task : _data.tasks) {
-        if (task.isDone) {
-            result.push_back(task);
-        }
-    }
-    return result;
-}
-
-std::vector<Task> Data::getPendingTasks() const
-{
-    std::vector<Task> result;
-    for (const auto &task : _data.tasks) {
-        if (!task.isDone) {
-            result.push_back(task);
-        }
-    }
-    return result;
-}
-
-std::vector<Task> Data::getImportantTasks() const
-{
-    std::vector<Task> result;
-    for (const auto &task : _data.tasks) {
-        if (task.isImportant) {
-            result.push_back(task);
-        }
-    }
-    return result;
-}
-
-std::vector<Task> Data::getTasksByParent(const std::string &parentUuid) const
-{
-    std::vector<Task> result;
-    for (const auto &task : _data.tasks) {
-        if (task.parentUuid && *task.parentUuid == parentUuid) {
-            result.push_back(task);
-        }
-    }
-    return result;
+    auto view = tasksByTagView(tagName);
+    return { view.begin(), view.end() };
 }
 
 void Data::addTag(const Tag &tag)
@@ -174,23 +222,14 @@ bool Data::containsTag(const std::string &tagName) const
 std::vector<Task> Data::newTasks() const
 {
     std::vector<Task> result;
-    result.reserve(_data.tasks.size());
-
-    std::ranges::copy_if(_data.tasks, std::back_inserter(result), [](const Task &task) {
-        return task.revision == -1;
-    });
-
+    std::ranges::copy(newTasksView(), std::back_inserter(result));
     return result;
 }
 
 std::vector<Task> Data::modifiedTasks() const
 {
     std::vector<Task> result;
-    result.reserve(_data.tasks.size());
-
-    std::ranges::copy_if(_data.tasks, std::back_inserter(result),
-                         [](const Task &task) { return task.needsSyncToServer; });
-
+    std::ranges::copy(modifiedTasksView(), std::back_inserter(result));
     return result;
 }
 
@@ -199,21 +238,24 @@ const Task &Data::taskAt(size_t index) const
     return _data.tasks.at(index);
 }
 
-const Task *Data::taskForUuid(const std::string &uuid) const
+std::optional<size_t> Data::indexOfTask(const Uuid &uuid) const
 {
-    auto it = std::ranges::find_if(_data.tasks, [&uuid](const Task &task) {
-        return task.uuid == uuid;
-    });
+    return _taskIndex.find(_data.tasks, uuid);
+}
+
+const Task *Data::taskForUuid(const Uuid &uuid) const
+{
+    auto it = findTaskByUuid(uuid);
     if (it != _data.tasks.end()) {
         return &(*it);
     }
     return nullptr;
 }
 
-Task *Data::taskForUuid(const std::string &uuid)
+const Task *Data::taskForUuidInDeviceCalendar(std::string_view eventId) const
 {
-    auto it = std::ranges::find_if(_data.tasks, [&uuid](const Task &task) {
-        return task.uuid == uuid;
+    auto it = std::ranges::find_if(_data.tasks, [eventId](const Task &task) {
+        return task.uuidInDeviceCalendar.has_value() && *task.uuidInDeviceCalendar == eventId;
     });
     if (it != _data.tasks.end()) {
         return &(*it);
@@ -275,12 +317,20 @@ bool Data::renameTag(const std::string &oldName, const std::string &newName)
     it->revision = -1;
     it->needsSyncToServer = true;
 
-    for (auto &task : _data.tasks) {
-        auto tagIt = std::ranges::find(task.tags, oldName);
-        if (tagIt != task.tags.end()) {
-            *tagIt = newName;
+    const TagId oldId = TagDictionary::intern(oldName);
+    const TagId newId = TagDictionary::intern(newName);
+    const auto affected = _tagIndex.positions(oldId);
+    const std::vector<size_t> positions(affected.begin(), affected.end());
+    for (size_t position : positions) {
+        auto &task = _data.tasks[position];
+        _tagIndex.remove(task, position);
+        _dirtyTasks.remove(task, position);
+        if (task.tags.replace(oldId, newId)) {
             task.needsSyncToServer = true;
         }
+        _tagIndex.add(task, position);
+        _dirtyTasks.add(task, position);
+        _columns.assign(position, task);
     }
 
     addDeletedTagName(oldName);
@@ -291,55 +341,102 @@ bool Data::renameTag(const std::string &oldName, const std::string &newName)
 std::vector<Tag> Data::getUsedTags() const
 {
     std::vector<Tag> result;
-    for (const auto &tag : _data.tags) {
-        bool isUsed = false;
-        for (const auto &task : _data.tasks) {
-            auto tagIt = std::ranges::find(task.tags, tag.name);
-            if (tagIt != task.tags.end()) {
-                isUsed = true;
-                break;
-            }
-        }
-        if (isUsed) {
-            result.push_back(tag);
-        }
-    }
+    std::ranges::copy_if(_data.tags, std::back_inserter(result), [this](const Tag &tag) {
+        return _tagIndex.taskCount(tag.name) > 0;
+    });
     return result;
 }
 
 std::vector<Tag> Data::getUnusedTags() const
 {
     std::vector<Tag> result;
-    for (const auto &tag : _data.tags) {
-        bool isUsed = false;
-        for (const auto &task : _data.tasks) {
-            auto tagIt = std::ranges::find(task.tags, tag.name);
-            if (tagIt != task.tags.end()) {
-                isUsed = true;
-                break;
-            }
-        }
-        if (!isUsed) {
-            result.push_back(tag);
-        }
-    }
+    std::ranges::copy_if(_data.tags, std::back_inserter(result), [this](const Tag &tag) {
+        return _tagIndex.taskCount(tag.name) == 0;
+    });
     return result;
 }
 
 void Data::removeUnusedTags()
 {
-    auto unusedTags = getUnusedTags();
-    for (const auto &tag : unusedTags) {
-        removeTag(tag.name);
+    std::erase_if(_data.tags, [this](const Tag &tag) {
+        return _tagIndex.taskCount(tag.name) == 0;
+    });
+}
+
+int Data::taskCountForTag(const std::string &tagName) const
+{
+    return _tagIndex.taskCount(tagName);
+}
+
+int Data::visibleTaskCountForTag(const std::string &tagName) const
+{
+    return _tagIndex.visibleTaskCount(tagName);
+}
+
+TaskSelection Data::selectDueBetween(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const
+{
+    TaskSelection result(_columns, false);
+    for (const auto &entry : _dueDateIndex.range(from, to)) {
+        result.add(entry.position);
+    }
+    return result;
+}
+
+TaskSelection Data::selectOverdue(std::chrono::system_clock::time_point now) const
+{
+    TaskSelection result(_columns, false);
+    for (const auto &entry : _dueDateIndex.before(now)) {
+        result.add(entry.position);
     }
+    return result.without(TaskColumn::Done);
+}
+
+TaskSelection Data::selectCurrent(std::chrono::system_clock::time_point now) const
+{
+    const auto monday = DateUtils::thisWeeksMonday(now);
+
+    TaskSelection result(_columns);
+    result.with(TaskColumn::TagCurrent);
+    return result.unite(selectDueBetween(monday, DateUtils::nextMonday(monday))).unite(selectOverdue(now));
+}
+
+TaskSelection Data::selectSoon(std::chrono::system_clock::time_point now) const
+{
+    // Task::isDueIn() includes the upper bound
+    const auto end = now + std::chrono::days(15) + std::chrono::system_clock::duration(1);
+
+    TaskSelection result(_columns);
+    result.with(TaskColumn::TagSoon);
+    return result.unite(selectDueBetween(now, end)).subtract(selectCurrent(now));
+}
+
+TaskSelection Data::selectLater(std::chrono::system_clock::time_point now) const
+{
+    TaskSelection result(_columns);
+    return result.subtract(selectCurrent(now)).subtract(selectSoon(now));
 }
 
-void Data::addDeletedTaskUuid(const std::string &uuid)
+size_t Data::newTaskCount() const
+{
+    return _dirtyTasks.newCount();
+}
+
+size_t Data::modifiedTaskCount() const
+{
+    return _dirtyTasks.modifiedCount();
+}
+
+size_t Data::pendingChangeCount() const
+{
+    return _dirtyTasks.size() + _data.deletedTaskUuids.size() + _data.deletedTagNames.size();
+}
+
+void Data::addDeletedTaskUuid(const Uuid &uuid)
 {
     _data.deletedTaskUuids.push_back(uuid);
 }
 
-const std::vector<std::string> &Data::deletedTaskUuids() const
+const std::vector<Uuid> &Data::deletedTaskUuids() const
 {
     return _data.deletedTaskUuids;
 }
@@ -355,18 +452,86 @@ const std::vector<std::string> &Data::deletedTagNames() const
 }
 
 
-std::expected<Data, std::string> Data::fromJson(const std::string &json_str)
+std::expected<Data, std::string> Data::fromJson(std::string_view json_str)
+{
+    if (json_str.size() >= ParallelParseThreshold)
+        return fromJsonInParallel(json_str);
+
+    return fromJsonOnOneThread(json_str);
+}
+
+std::expected<Data, std::string> Data::fromJsonOnOneThread(std::string_view json_str)
 {
     Data manager;
-    auto result = glz::read<glz::opts {
-        .error_on_unknown_keys = true,
-        // .error_on_missing_keys = true,
-        .skip_null_members = false,
-    }>(manager._data, json_str);
+    auto result = glz::read<JsonReadOpts>(manager._data, json_str);
     if (result != glz::error_code::none) {
         return std::unexpected("Failed to parse JSON: " + std::string(glz::format_error(result, json_str)));
     }
 
+    manager.rebuildIndexes();
+    return manager;
+}
+
+std::expected<Data, std::string> Data::fromJsonInParallel(std::string_view json_str, unsigned threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+
+    const auto layout = findTopLevelArray(json_str, "tasks");
+    if (!layout || threadCount < 2 || layout->elements.size() < 2 * MinTasksPerChunk)
+        return fromJsonOnOneThread(json_str);
+
+    const auto &elements = layout->elements;
+    const size_t chunkCount = std::min<size_t>(threadCount * 4, elements.size() / MinTasksPerChunk);
+    const size_t chunkSize = (elements.size() + chunkCount - 1) / chunkCount;
+    std::vector<std::vector<Task>> chunks(chunkCount);
+    std::atomic<size_t> nextChunk = 0;
+    std::atomic<bool> failed = false;
+
+    auto parseChunks = [&] {
+        for (size_t chunk = nextChunk++; chunk < chunkCount && !failed; chunk = nextChunk++) {
+            const size_t first = chunk * chunkSize;
+            const size_t last = std::min(first + chunkSize, elements.size());
+            auto &tasks = chunks[chunk];
+            tasks.resize(last - first);
+            for (size_t i = first; i < last; ++i) {
+                if (glz::read<JsonReadOpts>(tasks[i - first], elements[i]) != glz::error_code::none) {
+                    failed = true;
+                    return;
+                }
+            }
+        }
+    };
+
+    Data manager;
+    bool restFailed = false;
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back(parseChunks);
+        }
+
+        // Everything but the tasks is small, parsed here with an empty tasks array in its place
+        std::string rest;
+        rest.reserve(json_str.size() - (layout->end - layout->begin) + 2);
+        rest.append(json_str.substr(0, layout->begin));
+        rest.append("[]");
+        rest.append(json_str.substr(layout->end));
+        restFailed = glz::read<JsonReadOpts>(manager._data, rest) != glz::error_code::none;
+
+        parseChunks();
+    }
+
+    if (failed || restFailed)
+        return fromJsonOnOneThread(json_str);
+
+    manager._data.tasks.reserve(elements.size());
+    for (auto &chunk : chunks) {
+        std::ranges::move(chunk, std::back_inserter(manager._data.tasks));
+    }
+
+    manager.rebuildIndexes();
     return manager;
 }
 
@@ -384,16 +549,166 @@ std::expected<std::string, std::string> Data::toJson() const
     return buffer;
 }
 
-std::vector<Task>::iterator Data::findTaskByUuid(const std::string &uuid)
+std::expected<void, std::string> Data::writeJson(OutputSink &sink, size_t chunkSize) const
+{
+    static constexpr auto Opts = glz::opts {
+        .skip_null_members = false,
+    };
+
+    std::string chunk;
+    chunk.reserve(chunkSize);
+    std::string scratch;
+
+    auto flush = [&](size_t threshold) -> std::expected<void, std::string> {
+        if (chunk.empty() || chunk.size() < threshold)
+            return {};
+        auto result = sink.write(chunk);
+        chunk.clear();
+        return result;
+    };
+
+    auto append = [&](const auto &value) -> std::expected<void, std::string> {
+        if (glz::write<Opts>(value, scratch)) {
+            return std::unexpected("Failed to serialize to JSON");
+        }
+        chunk.append(scratch);
+        return flush(chunkSize);
+    };
+
+    // Keys in the order glz::meta<DataPayload> declares them. Only tasks are split up, the rest is small
+    chunk.append(R"({"tasks":[)");
+    for (size_t i = 0; i < _data.tasks.size(); ++i) {
+        if (i > 0)
+            chunk.push_back(',');
+        if (auto result = append(_data.tasks[i]); !result)
+            return result;
+    }
+
+    chunk.append(R"(],"tags":)");
+    if (auto result = append(_data.tags); !result)
+        return result;
+
+    chunk.append(R"(,"revision":)");
+    if (auto result = append(_data.revision); !result)
+        return result;
+
+    chunk.append(R"(,"deletedTaskUuids":)");
+    if (auto result = append(_data.deletedTaskUuids); !result)
+        return result;
+
+    chunk.append(R"(,"deletedTagNames":)");
+    if (auto result = append(_data.deletedTagNames); !result)
+        return result;
+
+    chunk.push_back('}');
+    return flush(0);
+}
+
+namespace {
+
+constexpr std::string_view BinaryMagic = "PLBS";
+constexpr uint32_t BinaryVersion = 2;
+constexpr size_t BinaryHeaderSize = BinaryMagic.size() + sizeof(uint32_t) + sizeof(uint64_t);
+
+template<typename T>
+T readLittleEndian(std::string_view bytes)
+{
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<unsigned char>(bytes[i])) << (i * 8);
+    }
+    return value;
+}
+
+template<typename T>
+void appendLittleEndian(std::string &out, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+}
+
+bool Data::isBinary(std::string_view bytes)
+{
+    return bytes.starts_with(BinaryMagic);
+}
+
+std::expected<Data, std::string> Data::fromBinary(std::string_view bytes)
+{
+    if (!isBinary(bytes) || bytes.size() < BinaryHeaderSize) {
+        return std::unexpected("Not a binary snapshot");
+    }
+
+    const auto version = readLittleEndian<uint32_t>(bytes.substr(BinaryMagic.size()));
+    if (version != BinaryVersion) {
+        return std::unexpected("Unsupported binary snapshot version " + std::to_string(version));
+    }
+
+    const auto tasksSize = readLittleEndian<uint64_t>(bytes.substr(BinaryMagic.size() + sizeof(uint32_t)));
+    if (tasksSize > bytes.size() - BinaryHeaderSize) {
+        return std::unexpected("Truncated binary snapshot");
+    }
+
+    Data manager;
+    auto result = glz::read_beve(manager._data, bytes.substr(BinaryHeaderSize, tasksSize));
+    if (result) {
+        return std::unexpected("Failed to parse binary snapshot: " + std::string(glz::format_error(result)));
+    }
+
+    // Copied out, so the snapshot file doesn't need to stay mapped, but only decoded when read
+    auto cold = ColdSection::open(std::string(bytes.substr(BinaryHeaderSize + tasksSize)), manager._data.tasks.size());
+    if (!cold) {
+        return std::unexpected("Failed to parse binary snapshot: " + cold.error());
+    }
+    for (uint32_t i = 0; i < manager._data.tasks.size(); ++i) {
+        Task &task = manager._data.tasks[i];
+        task.description.setColdSection(*cold, i);
+        task.lastCompletions.setColdSection(*cold, i);
+    }
+
+    manager.rebuildIndexes();
+    return manager;
+}
+
+std::expected<std::string, std::string> Data::toBinary() const
+{
+    std::string tasks;
+    if (glz::write_beve(_data, tasks)) {
+        return std::unexpected("Failed to serialize binary snapshot");
+    }
+
+    std::string buffer(BinaryMagic);
+    appendLittleEndian(buffer, BinaryVersion);
+    appendLittleEndian(buffer, static_cast<uint64_t>(tasks.size()));
+    buffer += tasks;
+    if (auto result = ColdSection::encode(_data.tasks, buffer); !result) {
+        return std::unexpected(result.error());
+    }
+
+    return buffer;
+}
+
+void Data::rebuildIndexes()
+{
+    _taskIndex.rebuild(_data.tasks);
+    _tagIndex.rebuild(_data.tasks);
+    _dueDateIndex.rebuild(_data.tasks);
+    _dirtyTasks.rebuild(_data.tasks);
+    _columns.rebuild(_data.tasks);
+}
+
+std::vector<Task>::iterator Data::findTaskByUuid(const Uuid &uuid)
 {
-    return std::ranges::find_if(_data.tasks,
-                                [&uuid](const Task &task) { return task.uuid == uuid; });
+    const auto index = _taskIndex.find(_data.tasks, uuid);
+    return index ? _data.tasks.begin() + static_cast<std::ptrdiff_t>(*index) : _data.tasks.end();
 }
 
-std::vector<Task>::const_iterator Data::findTaskByUuid(const std::string &uuid) const
+std::vector<Task>::const_iterator Data::findTaskByUuid(const Uuid &uuid) const
 {
-    return std::ranges::find_if(_data.tasks,
-                                [&uuid](const Task &task) { return task.uuid == uuid; });
+    const auto index = _taskIndex.find(_data.tasks, uuid);
+    return index ? _data.tasks.cbegin() + static_cast<std::ptrdiff_t>(*index) : _data.tasks.cend();
 }
 
 std::vector<Tag>::iterator Data::findTagByName(const std::string &tagName)
@@ -410,11 +725,16 @@ std::vector<Tag>::const_iterator Data::findTagByName(const std::string &tagName)
 
 void Data::clearServerSyncBits()
 {
-    for (auto &task : _data.tasks) {
+    for (size_t position : _dirtyTasks.positions()) {
+        auto &task = _data.tasks[position];
+        _tagIndex.remove(task, position);
         if (task.revision == -1)
             task.revision = 0;
         task.needsSyncToServer = false;
+        _tagIndex.add(task, position);
+        _columns.assign(position, task);
     }
+    _dirtyTasks.clear();
     for (auto &tag : _data.tags) {
         if (tag.revision == -1)
             tag.revision = 0;
@@ -451,12 +771,12 @@ std::string Data::debug_taskUids() const
 {
     std::string result;
     for (const auto &task : _data.tasks) {
-        result += task.uuid + " ";
+        result += task.uuid.toString() + " ";
     }
     return result;
 }
 
-std::vector<std::string> Data::findDuplicateCalendarTaskUuids() const
+std::vector<Uuid> Data::findDuplicateCalendarTaskUuids() const
 {
     using Key = std::tuple<std::string, std::string, std::optional<std::chrono::system_clock::time_point>>;
     std::map<Key, std::vector<size_t>> groups;
@@ -470,7 +790,7 @@ std::vector<std::string> Data::findDuplicateCalendarTaskUuids() const
         groups[key].push_back(i);
     }
 
-    std::vector<std::string> duplicateUuids;
+    std::vector<Uuid> duplicateUuids;
     for (const auto &[key, indices] : groups) {
         if (indices.size() < 2)
             continue;
@@ -3,23 +3,34 @@
 
 #pragma once
 
+#include "dirty_set.h"
+#include "due_date_index.h"
 #include "tag.h"
+#include "tag_index.h"
 #include "task.h"
+#include "task_columns.h"
+#include "uuid_index.h"
 
 #include <glaze/glaze.hpp>
 
+#include <chrono>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace pointless::core {
 
+class OutputSink;
+
 struct DataPayload
 {
     int revision = -1;
     std::vector<Task> tasks;
     std::vector<Tag> tags;
-    std::vector<std::string> deletedTaskUuids;
+    std::vector<Uuid> deletedTaskUuids;
     std::vector<std::string> deletedTagNames;
 };
 
@@ -29,9 +40,23 @@ public:
     Data();
 
     // Task management methods
-    void addTask(const Task &task);
-    bool removeTask(const std::string &uuid);
-    [[nodiscard]] std::optional<Task> getTask(const std::string &uuid) const;
+    /// Returns false, leaving the existing task alone, if a task with the same uuid exists
+    bool addTask(const Task &task);
+
+    /// Rebuilds the indexes, which is O(N). Loops should collect the uuids and call removeTasks()
+    bool removeTask(const Uuid &uuid);
+
+    /// Removes all tasks in @p uuids in a single pass and rebuilds the indexes once.
+    /// Returns the uuids that were found, in task order
+    std::vector<Uuid> removeTasks(std::span<const Uuid> uuids);
+
+    /// For bulk adds: tasks added until flushIndexUpdates() are sorted into the due date index at
+    /// once, and due date queries don't see them until then. The other indexes update in place
+    void deferIndexUpdates();
+    void flushIndexUpdates();
+    [[nodiscard]] bool isDeferringIndexUpdates() const;
+
+    [[nodiscard]] std::optional<Task> getTask(const Uuid &uuid) const;
     [[nodiscard]] std::vector<Task> getAllTasks() const;
     bool updateTask(const Task &task, bool incrementTaskRevision);
     bool setTask(const Task &task);
@@ -42,16 +67,13 @@ public:
 
     // Task filtering methods
     [[nodiscard]] std::vector<Task> getTasksByTag(const std::string &tagName) const;
-    [[nodiscard]] std::vector<Task> getCompletedTasks() const;
-    [[nodiscard]] std::vector<Task> getPendingTasks() const;
-    [[nodiscard]] std::vector<Task> getImportantTasks() const;
-    [[nodiscard]] std::vector<Task> getTasksByParent(const std::string &parentUuid) const;
     [[nodiscard]] const Task &taskAt(size_t index) const;
-    [[nodiscard]] const Task *taskForUuid(const std::string &uuid) const;
-    [[nodiscard]] Task *taskForUuid(const std::string &uuid);
+    [[nodiscard]] std::optional<size_t> indexOfTask(const Uuid &uuid) const;
+    [[nodiscard]] const Task *taskForUuid(const Uuid &uuid) const;
     [[nodiscard]] const Task *taskForTitle(const std::string &title) const;
+    [[nodiscard]] const Task *taskForUuidInDeviceCalendar(std::string_view eventId) const;
     [[nodiscard]] std::string debug_taskUids() const;
-    [[nodiscard]] std::vector<std::string> findDuplicateCalendarTaskUuids() const;
+    [[nodiscard]] std::vector<Uuid> findDuplicateCalendarTaskUuids() const;
 
     // Tag management methods
     void addTag(const Tag &tag);
@@ -68,10 +90,116 @@ public:
     [[nodiscard]] std::vector<Tag> getUsedTags() const;
     [[nodiscard]] std::vector<Tag> getUnusedTags() const;
     void removeUnusedTags();
+    [[nodiscard]] int taskCountForTag(const std::string &tagName) const;
+    [[nodiscard]] int visibleTaskCountForTag(const std::string &tagName) const;
+
+    // Non-allocating queries. Views are invalidated by any task mutation, like iterators.
+    [[nodiscard]] std::span<const Task> tasks() const
+    {
+        return _data.tasks;
+    }
+
+    [[nodiscard]] std::span<const Tag> tags() const
+    {
+        return _data.tags;
+    }
+
+    [[nodiscard]] auto tasksByTagView(std::string_view tagName) const
+    {
+        return _tagIndex.positions(tagName) | std::views::transform([this](size_t position) -> const Task & {
+                   return _data.tasks[position];
+               });
+    }
+
+    [[nodiscard]] auto dirtyTasksWhere(TaskColumn column) const
+    {
+        return _dirtyTasks.positions() | std::views::filter([this, column](size_t position) {
+                   return _columns.test(column, position);
+               }) | std::views::transform([this](size_t position) -> const Task & {
+                   return _data.tasks[position];
+               });
+    }
+
+    /// Tasks at the positions of a column or TaskSelection
+    [[nodiscard]] auto tasksAt(PositionRange positions) const
+    {
+        return positions | std::views::transform([this](size_t position) -> const Task & {
+                   return _data.tasks[position];
+               });
+    }
+
+    [[nodiscard]] auto completedTasksView() const
+    {
+        return tasksAt(_columns.positions(TaskColumn::Done));
+    }
+
+    [[nodiscard]] auto pendingTasksView() const
+    {
+        return tasksAt(_columns.positions(TaskColumn::Done, false));
+    }
+
+    [[nodiscard]] auto importantTasksView() const
+    {
+        return tasksAt(_columns.positions(TaskColumn::Important));
+    }
+
+    [[nodiscard]] auto tasksByParentView(Uuid parentUuid) const
+    {
+        return tasks() | std::views::filter([parentUuid](const Task &task) {
+                   return task.parentUuid && *task.parentUuid == parentUuid;
+               });
+    }
+
+    [[nodiscard]] auto newTasksView() const
+    {
+        return dirtyTasksWhere(TaskColumn::New);
+    }
+
+    [[nodiscard]] auto modifiedTasksView() const
+    {
+        return dirtyTasksWhere(TaskColumn::NeedsSyncToServer);
+    }
+
+    [[nodiscard]] size_t newTaskCount() const;
+    [[nodiscard]] size_t modifiedTaskCount() const;
+
+    /// Local changes the server doesn't have yet: dirty tasks plus task and tag deletions. O(1)
+    [[nodiscard]] size_t pendingChangeCount() const;
+
+    /// Tasks due in [from, to), in due date order. O(log N) to find the range
+    [[nodiscard]] auto tasksDueBetweenView(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const
+    {
+        return _dueDateIndex.range(from, to) | std::views::transform([this](const DueDateIndex::Entry &entry) -> const Task & {
+                   return _data.tasks[entry.position];
+               });
+    }
+
+    /// Pending tasks due before @p now, like Task::isOverdue()
+    [[nodiscard]] auto overdueTasksView(std::chrono::system_clock::time_point now) const
+    {
+        return _dueDateIndex.before(now) | std::views::filter([this](const DueDateIndex::Entry &entry) {
+                   return !_columns.test(TaskColumn::Done, entry.position);
+               }) | std::views::transform([this](const DueDateIndex::Entry &entry) -> const Task & {
+                   return _data.tasks[entry.position];
+               });
+    }
+
+    // Bucket selections, same semantics as the Task predicates, with due date ranges from the index
+    [[nodiscard]] TaskSelection selectDueBetween(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to) const;
+    [[nodiscard]] TaskSelection selectOverdue(std::chrono::system_clock::time_point now) const;
+    [[nodiscard]] TaskSelection selectCurrent(std::chrono::system_clock::time_point now) const;
+    [[nodiscard]] TaskSelection selectSoon(std::chrono::system_clock::time_point now) const;
+    [[nodiscard]] TaskSelection selectLater(std::chrono::system_clock::time_point now) const;
+
+    /// Hot fields of every task, parallel to tasks(). For bulk filtering with TaskSelection
+    [[nodiscard]] const TaskColumns &columns() const
+    {
+        return _columns;
+    }
 
     // Deleted items management
-    void addDeletedTaskUuid(const std::string &uuid);
-    [[nodiscard]] const std::vector<std::string> &deletedTaskUuids() const;
+    void addDeletedTaskUuid(const Uuid &uuid);
+    [[nodiscard]] const std::vector<Uuid> &deletedTaskUuids() const;
 
     void addDeletedTagName(const std::string &tagName);
     [[nodiscard]] const std::vector<std::string> &deletedTagNames() const;
@@ -80,8 +208,26 @@ public:
     void setRevision(int revision);
     [[nodiscard]] int revision() const;
 
-    static std::expected<Data, std::string> fromJson(const std::string &json_str);
+    /// Large documents are parsed with fromJsonInParallel()
+    static std::expected<Data, std::string> fromJson(std::string_view json_str);
+
+    /// Same result as a single-threaded parse. The tasks array is split at element boundaries by a
+    /// structural pre-scan and its chunks are parsed on @p threadCount threads (0 for one per core),
+    /// while the rest of the document is parsed on the calling thread. Anything unexpected, errors
+    /// included, is re-parsed on one thread so the outcome and messages don't change
+    static std::expected<Data, std::string> fromJsonInParallel(std::string_view json_str, unsigned threadCount = 0);
     [[nodiscard]] std::expected<std::string, std::string> toJson() const;
+
+    /// Writes the same bytes as toJson() to @p sink, one task at a time through a buffer of about
+    /// @p chunkSize bytes, so saves and pushes never hold the whole document in memory
+    [[nodiscard]] std::expected<void, std::string> writeJson(OutputSink &sink, size_t chunkSize = 64 * 1024) const;
+
+    /// Local snapshot encoding: a magic and format version followed by the payload as BEVE, with the
+    /// notes and completion history of the tasks in a cold section after it, decoded when first read.
+    /// Much faster to load than JSON, which stays the format for export and the server
+    static std::expected<Data, std::string> fromBinary(std::string_view bytes);
+    [[nodiscard]] std::expected<std::string, std::string> toBinary() const;
+    static bool isBinary(std::string_view bytes);
     [[nodiscard]] bool isEmpty() const;
     [[nodiscard]] bool isValid() const;
 
@@ -89,12 +235,26 @@ public:
     mutable bool needsUpload = false;
     mutable bool needsLocalSave = false;
 
+    /// The server document this data was pulled from or pushed as, see IDataProvider::documentVersion().
+    /// Not saved, so the first refresh after a load always downloads the document
+    std::string remoteDocumentVersion;
+
 private:
+    static std::expected<Data, std::string> fromJsonOnOneThread(std::string_view json_str);
+
+    void rebuildIndexes();
+
     // Helper methods
-    std::vector<Task>::iterator findTaskByUuid(const std::string &uuid);
-    [[nodiscard]] std::vector<Task>::const_iterator findTaskByUuid(const std::string &uuid) const;
+    std::vector<Task>::iterator findTaskByUuid(const Uuid &uuid);
+    [[nodiscard]] std::vector<Task>::const_iterator findTaskByUuid(const Uuid &uuid) const;
     std::vector<Tag>::iterator findTagByName(const std::string &tagName);
     [[nodiscard]] std::vector<Tag>::const_iterator findTagByName(const std::string &tagName) const;
+
+    UuidIndex _taskIndex;
+    TagIndex _tagIndex;
+    DueDateIndex _dueDateIndex;
+    DirtyTaskSet _dirtyTasks;
+    TaskColumns _columns;
 };
 
 } // namespace pointless::core
@@ -42,3 +42,39 @@ std::unique_ptr<IDataProvider> IDataProvider::createProvider()
     pointless::abort("invalid IDataProvider::Type enum value");
     return {};
 }
+
+std::expected<void, TraceableError> IDataProvider::pushDocument(const pointless::core::DocumentWriter &writeDocument)
+{
+    std::string document;
+    pointless::core::StringSink sink(document);
+    if (auto result = writeDocument(sink); !result) {
+        return TraceableError::create(result.error());
+    }
+
+    return pushData(document);
+}
+
+std::expected<std::string, TraceableError> IDataProvider::pullDocumentVersion()
+{
+    return std::string();
+}
+
+std::string IDataProvider::documentVersion() const
+{
+    return {};
+}
+
+std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> IDataProvider::pullChanges(int /*sinceRevision*/)
+{
+    return TraceableError::create("Delta sync isn't supported by this provider");
+}
+
+std::expected<void, TraceableError> IDataProvider::pushChanges(const pointless::core::ChangeSet & /*changes*/)
+{
+    return TraceableError::create("Delta sync isn't supported by this provider");
+}
+
+std::expected<void, TraceableError> IDataProvider::pruneChanges(int /*beforeRevision*/)
+{
+    return TraceableError::create("Delta sync isn't supported by this provider");
+}
@@ -5,10 +5,13 @@
 
 #include "utils.h"
 #include "error.h"
+#include "output_sink.h"
+#include "delta_sync.h"
 
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include <cstdlib>
 #include <expected>
 
@@ -38,6 +41,29 @@ public:
     virtual std::expected<std::string, TraceableError> pullData() = 0;
     virtual std::expected<void, TraceableError> pushData(const std::string &data) = 0;
 
+    /// Pushes the document @p writeDocument produces. Providers that can consume it in chunks
+    /// override this, the default collects it into a string for pushData()
+    virtual std::expected<void, TraceableError> pushDocument(const pointless::core::DocumentWriter &writeDocument);
+
+    /// Identifies the document on the server without downloading it. Derived from the stored
+    /// contents, so a push by any client changes it, whether or not it knows about versions.
+    /// Empty if it isn't known, the document has to be pulled then. That's the default
+    virtual std::expected<std::string, TraceableError> pullDocumentVersion();
+
+    /// The version of the document this provider last pulled or pushed, to compare with
+    /// pullDocumentVersion() later. Empty if it isn't known
+    [[nodiscard]] virtual std::string documentVersion() const;
+
+    /// Delta sync, see ChangeSet. Providers without a change log fail these, the whole document
+    /// is synced instead
+    virtual std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> pullChanges(int sinceRevision);
+
+    /// Fails if another client pushed @p changes.revision first
+    virtual std::expected<void, TraceableError> pushChanges(const pointless::core::ChangeSet &changes);
+
+    /// Drops the change sets before @p revision, once a full document at that revision was pushed
+    virtual std::expected<void, TraceableError> pruneChanges(int beforeRevision);
+
     [[nodiscard]] virtual std::string accessToken() const = 0;
     [[nodiscard]] virtual std::string refreshToken() const = 0;
     [[nodiscard]] virtual std::string userId() const = 0;
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "delta_sync.h"
+
+#include <unordered_set>
+
+using namespace pointless::core;
+
+bool ChangeSet::isEmpty() const
+{
+    return !snapshot && tasks.empty() && tags.empty() && deletedTaskUuids.empty() && deletedTagNames.empty();
+}
+
+Data pointless::core::serverViewOf(const Data &local)
+{
+    Data view = local;
+
+    std::vector<Uuid> unpushed;
+    unpushed.reserve(local.newTaskCount());
+    for (const Task &task : local.newTasksView()) {
+        unpushed.push_back(task.uuid);
+    }
+    view.removeTasks(unpushed);
+
+    for (const Tag &tag : local.newTags()) {
+        view.removeTag(tag.name);
+    }
+
+    // The server still has what was deleted locally. Stand-ins are enough, the merge only needs
+    // something to delete so the deletion gets uploaded
+    view.clearServerSyncBits();
+    for (const Uuid &uuid : local.deletedTaskUuids()) {
+        if (view.taskForUuid(uuid) != nullptr)
+            continue;
+        Task deleted;
+        deleted.uuid = uuid;
+        deleted.revision = 0;
+        view.addTask(deleted);
+    }
+    for (const std::string &tagName : local.deletedTagNames()) {
+        if (view.containsTag(tagName))
+            continue;
+        view.addTag(Tag { .revision = 0, .name = tagName });
+    }
+    return view;
+}
+
+std::expected<void, std::string> pointless::core::applyChangeSets(Data &data, std::span<const ChangeSet> changes)
+{
+    for (const ChangeSet &change : changes) {
+        if (change.revision != data.revision() + 1) {
+            return std::unexpected("Change log jumps from revision " + std::to_string(data.revision()) + " to " + std::to_string(change.revision));
+        }
+        if (change.snapshot) {
+            return std::unexpected("Change log was compacted at revision " + std::to_string(change.revision));
+        }
+
+        for (const Task &task : change.tasks) {
+            if (!data.setTask(task)) {
+                data.addTask(task);
+            }
+        }
+        data.removeTasks(change.deletedTaskUuids);
+
+        for (const Tag &tag : change.tags) {
+            data.addTag(tag);
+        }
+        for (const std::string &tagName : change.deletedTagNames) {
+            data.removeTag(tagName);
+        }
+
+        data.setRevision(change.revision);
+    }
+
+    return {};
+}
+
+ChangeSet pointless::core::changeSetBetween(const Data &remote, const Data &merged, const Data &local)
+{
+    ChangeSet changes;
+
+    for (const Task &task : merged.tasks()) {
+        const Task *remoteTask = remote.taskForUuid(task.uuid);
+        if (remoteTask == nullptr || remoteTask->revision != task.revision) {
+            changes.tasks.push_back(task);
+            changes.tasks.back().needsSyncToServer = false;
+        }
+    }
+
+    for (const Tag &tag : merged.tags()) {
+        if (!remote.containsTag(tag.name)) {
+            changes.tags.push_back(tag);
+            changes.tags.back().needsSyncToServer = false;
+        }
+    }
+
+    // The tombstones go first, the tasks are already gone from the server view as well
+    changes.deletedTaskUuids = local.deletedTaskUuids();
+    std::unordered_set<Uuid> deletedTasks(changes.deletedTaskUuids.begin(), changes.deletedTaskUuids.end());
+    for (const Task &task : remote.tasks()) {
+        if (merged.taskForUuid(task.uuid) == nullptr && deletedTasks.insert(task.uuid).second)
+            changes.deletedTaskUuids.push_back(task.uuid);
+    }
+
+    changes.deletedTagNames = local.deletedTagNames();
+    std::unordered_set<std::string> deletedTags(changes.deletedTagNames.begin(), changes.deletedTagNames.end());
+    for (const Tag &tag : remote.tags()) {
+        if (!merged.containsTag(tag.name) && deletedTags.insert(tag.name).second)
+            changes.deletedTagNames.push_back(tag.name);
+    }
+
+    return changes;
+}
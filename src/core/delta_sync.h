@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "data.h"
+
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace pointless::core {
+
+/// Every this many revisions the whole document is pushed instead and the change log pruned
+constexpr int DELTA_SYNC_COMPACTION_INTERVAL = 64;
+
+/// What one sync changed on the server, a row of its change log keyed by revision.
+/// Clients that know revision N download the rows after it instead of the whole document.
+/// A snapshot row marks a full document push, the rows before it may be pruned
+struct ChangeSet
+{
+    int revision = -1;
+    bool snapshot = false;
+
+    /// Added or modified, whole
+    std::vector<Task> tasks;
+    std::vector<Tag> tags;
+    std::vector<Uuid> deletedTaskUuids;
+    std::vector<std::string> deletedTagNames;
+
+    [[nodiscard]] bool isEmpty() const;
+};
+
+/// The server's data at @p local's revision, as far as @p local knows it: everything except what
+/// was never pushed, plus placeholders for what was deleted locally. Modified tasks keep their
+/// local contents, the merge only looks at their revision
+[[nodiscard]] Data serverViewOf(const Data &local);
+
+/// Brings @p data from its revision to the last of @p changes, which are in revision order.
+/// Fails on a gap or a snapshot, the whole document has to be pulled then
+[[nodiscard]] std::expected<void, std::string> applyChangeSets(Data &data, std::span<const ChangeSet> changes);
+
+/// What the server, at @p remote, needs so it ends up as @p merged. Deletions come from the
+/// tombstones in @p local, as the tasks are already gone from both
+[[nodiscard]] ChangeSet changeSetBetween(const Data &remote, const Data &merged, const Data &local);
+
+}
+
+template<>
+struct glz::meta<pointless::core::ChangeSet>
+{
+    using T = pointless::core::ChangeSet;
+    static constexpr auto value = object(
+        "revision", &T::revision,
+        "snapshot", &T::snapshot,
+        "tasks", &T::tasks,
+        "tags", &T::tags,
+        "deletedTaskUuids", &T::deletedTaskUuids,
+        "deletedTagNames", &T::deletedTagNames);
+};
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "dirty_set.h"
+
+#include <algorithm>
+
+using namespace pointless::core;
+
+void DirtyTaskSet::rebuild(const std::vector<Task> &tasks)
+{
+    clear();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        add(tasks[i], i);
+    }
+}
+
+void DirtyTaskSet::add(const Task &task, size_t position)
+{
+    if (!isDirty(task))
+        return;
+
+    auto it = std::ranges::lower_bound(_positions, position);
+    if (it != _positions.end() && *it == position)
+        return;
+
+    _positions.insert(it, position);
+    _newCount += isNew(task) ? 1 : 0;
+    _modifiedCount += task.needsSyncToServer ? 1 : 0;
+}
+
+void DirtyTaskSet::remove(const Task &task, size_t position)
+{
+    auto it = std::ranges::lower_bound(_positions, position);
+    if (it == _positions.end() || *it != position)
+        return;
+
+    _positions.erase(it);
+    _newCount -= isNew(task) ? 1 : 0;
+    _modifiedCount -= task.needsSyncToServer ? 1 : 0;
+}
+
+void DirtyTaskSet::clear()
+{
+    _positions.clear();
+    _newCount = 0;
+    _modifiedCount = 0;
+}
+
+std::span<const size_t> DirtyTaskSet::positions() const
+{
+    return _positions;
+}
+
+size_t DirtyTaskSet::size() const
+{
+    return _positions.size();
+}
+
+size_t DirtyTaskSet::newCount() const
+{
+    return _newCount;
+}
+
+size_t DirtyTaskSet::modifiedCount() const
+{
+    return _modifiedCount;
+}
+
+bool DirtyTaskSet::isNew(const Task &task)
+{
+    return task.revision == -1;
+}
+
+bool DirtyTaskSet::isDirty(const Task &task)
+{
+    return isNew(task) || task.needsSyncToServer;
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <span>
+#include <vector>
+
+namespace pointless::core {
+
+/// Sorted positions of the tasks that are new or need syncing to the server,
+/// so sync and its bookkeeping only visit what changed.
+class DirtyTaskSet
+{
+public:
+    void rebuild(const std::vector<Task> &tasks);
+    void add(const Task &task, size_t position);
+    void remove(const Task &task, size_t position);
+    void clear();
+
+    [[nodiscard]] std::span<const size_t> positions() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t newCount() const;
+    [[nodiscard]] size_t modifiedCount() const;
+
+    [[nodiscard]] static bool isNew(const Task &task);
+    [[nodiscard]] static bool isDirty(const Task &task);
+
+private:
+    std::vector<size_t> _positions;
+    size_t _newCount = 0;
+    size_t _modifiedCount = 0;
+};
+
+}
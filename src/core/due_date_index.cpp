@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "due_date_index.h"
+
+#include <algorithm>
+
+using namespace pointless::core;
+
+DueDateIndex::DueDateIndex(const DueDateIndex &other)
+    : _entries(other._entries)
+    , _deferred(other._deferred)
+    , _deferring(other._deferring)
+{
+    mergeDeferred();
+}
+
+DueDateIndex &DueDateIndex::operator=(const DueDateIndex &other)
+{
+    if (this != &other) {
+        _entries = other._entries;
+        _deferred = other._deferred;
+        _deferring = other._deferring;
+        mergeDeferred();
+    }
+    return *this;
+}
+
+void DueDateIndex::rebuild(const std::vector<Task> &tasks)
+{
+    clear();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (tasks[i].dueDate)
+            _entries.push_back({ .dueDate = *tasks[i].dueDate, .position = i });
+    }
+    std::ranges::sort(_entries);
+}
+
+void DueDateIndex::add(const Task &task, size_t position)
+{
+    if (!task.dueDate)
+        return;
+
+    const Entry entry { .dueDate = *task.dueDate, .position = position };
+    if (_deferring) {
+        _deferred.push_back(entry);
+        return;
+    }
+    _entries.insert(std::ranges::lower_bound(_entries, entry), entry);
+}
+
+void DueDateIndex::remove(const Task &task, size_t position)
+{
+    if (!task.dueDate)
+        return;
+
+    const Entry entry { .dueDate = *task.dueDate, .position = position };
+    auto it = std::ranges::lower_bound(_entries, entry);
+    if (it != _entries.end() && *it == entry) {
+        _entries.erase(it);
+    } else if (auto deferred = std::ranges::find(_deferred, entry); deferred != _deferred.end()) {
+        *deferred = _deferred.back();
+        _deferred.pop_back();
+    }
+}
+
+void DueDateIndex::clear()
+{
+    _entries.clear();
+    _deferred.clear();
+}
+
+void DueDateIndex::deferAdds()
+{
+    _deferring = true;
+}
+
+void DueDateIndex::flushDeferred()
+{
+    _deferring = false;
+    mergeDeferred();
+}
+
+bool DueDateIndex::isDeferring() const
+{
+    return _deferring;
+}
+
+void DueDateIndex::mergeDeferred()
+{
+    if (_deferred.empty())
+        return;
+
+    std::ranges::sort(_deferred);
+    const auto middle = static_cast<std::ptrdiff_t>(_entries.size());
+    _entries.insert(_entries.end(), _deferred.begin(), _deferred.end());
+    std::inplace_merge(_entries.begin(), _entries.begin() + middle, _entries.end());
+    _deferred.clear();
+}
+
+std::span<const DueDateIndex::Entry> DueDateIndex::range(TimePoint from, TimePoint to) const
+{
+    if (to <= from)
+        return {};
+
+    const auto first = std::ranges::lower_bound(_entries, from, {}, &Entry::dueDate);
+    const auto last = std::ranges::lower_bound(first, _entries.end(), to, {}, &Entry::dueDate);
+    return { first, last };
+}
+
+std::span<const DueDateIndex::Entry> DueDateIndex::before(TimePoint time) const
+{
+    const auto last = std::ranges::lower_bound(_entries, time, {}, &Entry::dueDate);
+    return { _entries.begin(), last };
+}
+
+size_t DueDateIndex::size() const
+{
+    return _entries.size();
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+namespace pointless::core {
+
+/// Tasks that have a due date, sorted by it, so date ranges are a binary search away.
+/// Tasks without a due date aren't indexed.
+/// Bulk inserts can be deferred: entries added meanwhile aren't seen by queries until flushDeferred()
+/// sorts them in at once, instead of each insert shifting the whole index. Copies are always flushed.
+class DueDateIndex
+{
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    DueDateIndex() = default;
+    ~DueDateIndex() = default;
+    DueDateIndex(const DueDateIndex &other);
+    DueDateIndex &operator=(const DueDateIndex &other);
+    DueDateIndex(DueDateIndex &&) noexcept = default;
+    DueDateIndex &operator=(DueDateIndex &&) noexcept = default;
+
+    struct Entry
+    {
+        TimePoint dueDate;
+        size_t position = 0;
+
+        auto operator<=>(const Entry &other) const = default;
+    };
+
+    void rebuild(const std::vector<Task> &tasks);
+    void add(const Task &task, size_t position);
+    void remove(const Task &task, size_t position);
+    void clear();
+
+    void deferAdds();
+    void flushDeferred();
+    [[nodiscard]] bool isDeferring() const;
+
+    /// Entries with a due date in [from, to)
+    [[nodiscard]] std::span<const Entry> range(TimePoint from, TimePoint to) const;
+
+    /// Entries with a due date before @p time
+    [[nodiscard]] std::span<const Entry> before(TimePoint time) const;
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    void mergeDeferred();
+
+    std::vector<Entry> _entries;
+    std::vector<Entry> _deferred; // Unsorted
+    bool _deferring = false;
+};
+
+}
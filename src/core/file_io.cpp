@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "file_io.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+using namespace pointless::core;
+
+namespace {
+
+std::string errorString(const std::string &what, const std::string &path)
+{
+    const int error = errno;
+    return what + " " + path + ": " + std::strerror(error);
+}
+
+bool writeAll(int fd, std::string_view contents)
+{
+    while (!contents.empty()) {
+        const ssize_t written = ::write(fd, contents.data(), contents.size());
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        contents.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+std::expected<void, std::string> syncAndClose(int fd, const std::string &path)
+{
+    if (::fsync(fd) != 0) {
+        auto error = errorString("Failed to sync", path);
+        ::close(fd);
+        return std::unexpected(error);
+    }
+
+    if (::close(fd) != 0) {
+        return std::unexpected(errorString("Failed to close", path));
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> writeAndSync(int fd, std::string_view contents, const std::string &path)
+{
+    if (!writeAll(fd, contents)) {
+        auto error = errorString("Failed to write to", path);
+        ::close(fd);
+        return std::unexpected(error);
+    }
+
+    return syncAndClose(fd, path);
+}
+
+class FileDescriptorSink : public OutputSink
+{
+public:
+    FileDescriptorSink(int fd, const std::string &path)
+        : _fd(fd)
+        , _path(path)
+    {
+    }
+
+    std::expected<void, std::string> write(std::string_view bytes) override
+    {
+        if (!writeAll(_fd, bytes))
+            return std::unexpected(errorString("Failed to write to", _path));
+        return {};
+    }
+
+private:
+    const int _fd;
+    const std::string &_path;
+};
+
+}
+
+std::expected<void, std::string> pointless::core::writeFileAtomically(const std::string &path, std::string_view contents)
+{
+    return writeFileAtomically(path, [contents](OutputSink &sink) { return sink.write(contents); });
+}
+
+std::expected<void, std::string> pointless::core::writeFileAtomically(const std::string &path, const DocumentWriter &writeContents)
+{
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(errorString("Failed to open file for writing:", tmpPath));
+    }
+
+    FileDescriptorSink sink(fd, tmpPath);
+    if (auto result = writeContents(sink); !result) {
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return result;
+    }
+
+    if (auto result = syncAndClose(fd, tmpPath); !result) {
+        ::unlink(tmpPath.c_str());
+        return result;
+    }
+
+    if (::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        auto error = errorString("Failed to replace", path);
+        ::unlink(tmpPath.c_str());
+        return std::unexpected(error);
+    }
+
+    // Makes the rename itself durable
+    return syncParentDirectory(path);
+}
+
+std::expected<void, std::string> pointless::core::appendToFile(const std::string &path, std::string_view contents)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(errorString("Failed to open file for appending:", path));
+    }
+
+    return writeAndSync(fd, contents, path);
+}
+
+std::optional<FileStamp> pointless::core::fileStamp(const std::string &path)
+{
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    return FileStamp { modified, size };
+}
+
+std::expected<void, std::string> pointless::core::syncParentDirectory(const std::string &path)
+{
+    auto dir = std::filesystem::path(path).parent_path();
+    if (dir.empty())
+        dir = ".";
+
+    const int dirFd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dirFd < 0) {
+        return std::unexpected(errorString("Failed to open directory", dir.string()));
+    }
+
+    const bool synced = ::fsync(dirFd) == 0;
+    auto error = synced ? std::string() : errorString("Failed to sync directory", dir.string());
+    ::close(dirFd);
+    if (!synced) {
+        return std::unexpected(error);
+    }
+    return {};
+}
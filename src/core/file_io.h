@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "output_sink.h"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace pointless::core {
+
+/// Replaces @p path so that a crash leaves either the old or the new contents: writes a temp
+/// file next to it, fsyncs it, renames it over @p path and fsyncs the directory.
+[[nodiscard]] std::expected<void, std::string> writeFileAtomically(const std::string &path, std::string_view contents);
+
+/// Same, with the contents produced in chunks by @p writeContents. Each chunk goes straight to the
+/// file descriptor, so the whole file never has to be in memory
+[[nodiscard]] std::expected<void, std::string> writeFileAtomically(const std::string &path, const DocumentWriter &writeContents);
+
+/// Enough to tell whether a file was written since it was last looked at
+struct FileStamp
+{
+    std::filesystem::file_time_type modified;
+    std::uintmax_t size = 0;
+
+    bool operator==(const FileStamp &other) const = default;
+};
+
+/// Nullopt when @p path doesn't exist
+[[nodiscard]] std::optional<FileStamp> fileStamp(const std::string &path);
+
+/// Appends to @p path, creating it if needed, and fsyncs before returning
+[[nodiscard]] std::expected<void, std::string> appendToFile(const std::string &path, std::string_view contents);
+
+/// Fsyncs the directory containing @p path, which makes creating, renaming or removing it durable
+[[nodiscard]] std::expected<void, std::string> syncParentDirectory(const std::string &path);
+
+}
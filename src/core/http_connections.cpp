@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "http_connections.h"
+#include "logger.h"
+
+#include <cpr/cpr.h>
+#include <curl/curl.h>
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+using namespace pointless::core;
+
+namespace {
+
+// Idle sessions kept per kind, more than the requests a client runs at once
+constexpr size_t kMaxIdleSessions = 4;
+
+void lockShare(CURL * /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void *userptr)
+{
+    static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST> *>(userptr)->at(data).lock();
+}
+
+void unlockShare(CURL * /*handle*/, curl_lock_data data, void *userptr)
+{
+    static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST> *>(userptr)->at(data).unlock();
+}
+
+}
+
+struct HttpConnections::Share
+{
+    CURLSH *handle = nullptr;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> mutexes;
+
+    std::mutex poolMutex;
+    // Indexed by Kind
+    std::array<std::vector<std::unique_ptr<cpr::Session>>, 2> idleSessions;
+};
+
+HttpConnections::HttpConnections()
+    : _share(std::make_unique<Share>())
+{
+    _share->handle = curl_share_init();
+    if (_share->handle == nullptr) {
+        P_LOG_WARNING_NOABORT("curl_share_init failed, requests won't share TLS sessions");
+        return;
+    }
+
+    curl_share_setopt(_share->handle, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(_share->handle, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(_share->handle, CURLSHOPT_USERDATA, &_share->mutexes);
+    curl_share_setopt(_share->handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(_share->handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpConnections::~HttpConnections()
+{
+    // The sessions use the share handle, so they go first
+    for (auto &sessions : _share->idleSessions)
+        sessions.clear();
+
+    if (_share->handle != nullptr)
+        curl_share_cleanup(_share->handle);
+}
+
+HttpConnections::Lease HttpConnections::checkOut(Kind kind)
+{
+    const CheckIn checkIn { .pool = this, .kind = kind };
+    {
+        std::lock_guard lock(_share->poolMutex);
+        auto &idle = _share->idleSessions.at(static_cast<size_t>(kind));
+        if (!idle.empty()) {
+            Lease lease(idle.back().release(), checkIn);
+            idle.pop_back();
+            return lease;
+        }
+    }
+
+    auto session = std::make_unique<cpr::Session>();
+    if (_share->handle != nullptr)
+        curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_SHARE, _share->handle);
+
+    // Falls back to HTTP/1.1 without TLS, or when the server or libcurl don't do HTTP/2
+    session->SetHttpVersion(cpr::HttpVersion { cpr::HttpVersionCode::VERSION_2_0_TLS });
+
+    return { session.release(), checkIn };
+}
+
+void HttpConnections::CheckIn::operator()(cpr::Session *session) const
+{
+    std::unique_ptr<cpr::Session> owned(session);
+
+    std::lock_guard lock(pool->_share->poolMutex);
+    auto &idle = pool->_share->idleSessions.at(static_cast<size_t>(kind));
+    if (idle.size() < kMaxIdleSessions)
+        idle.push_back(std::move(owned));
+}
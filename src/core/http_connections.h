@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <memory>
+
+namespace cpr {
+class Session;
+}
+
+namespace pointless::core {
+
+/// A pool of sessions shared by the requests of one client. A request checks a session out and
+/// gives it back when done, so the next request reuses its open connection instead of connecting
+/// again. Each session keeps its own connection cache, libcurl doesn't support using a shared one
+/// from several threads at once. TLS sessions and DNS lookups are shared by all of them, so a new
+/// session resumes TLS instead of doing a full handshake. Safe to use from several threads
+class HttpConnections
+{
+public:
+    /// Sessions with a body are kept apart, cpr has no way to take a body off a session again
+    enum class Kind {
+        WithoutBody,
+        WithBody
+    };
+
+    /// Gives a checked out session back to the pool
+    struct CheckIn
+    {
+        HttpConnections *pool = nullptr;
+        Kind kind = Kind::WithoutBody;
+
+        void operator()(cpr::Session *session) const;
+    };
+
+    /// A checked out session, back in the pool when destroyed
+    using Lease = std::unique_ptr<cpr::Session, CheckIn>;
+
+    HttpConnections();
+    ~HttpConnections();
+
+    HttpConnections(const HttpConnections &) = delete;
+    HttpConnections &operator=(const HttpConnections &) = delete;
+    HttpConnections(HttpConnections &&) = delete;
+    HttpConnections &operator=(HttpConnections &&) = delete;
+
+    /// An idle session from the pool, or a new one using the shared TLS sessions and DNS cache, and
+    /// HTTP/2 where the server offers it. Leases must not outlive the pool
+    [[nodiscard]] Lease checkOut(Kind kind);
+
+private:
+    struct Share;
+    std::unique_ptr<Share> _share;
+};
+
+}
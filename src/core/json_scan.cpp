@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "json_scan.h"
+
+using namespace pointless::core;
+
+namespace {
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+void skipWhitespace(std::string_view json, size_t &pos)
+{
+    while (pos < json.size() && isWhitespace(json[pos])) {
+        ++pos;
+    }
+}
+
+/// @p pos is at the opening quote. Leaves it one past the closing quote
+bool skipString(std::string_view json, size_t &pos, bool *hasEscapes = nullptr)
+{
+    ++pos;
+    while (true) {
+        pos = json.find_first_of("\"\\", pos);
+        if (pos == std::string_view::npos)
+            return false;
+
+        if (json[pos] == '"') {
+            ++pos;
+            return true;
+        }
+
+        if (hasEscapes)
+            *hasEscapes = true;
+        pos += 2;
+    }
+}
+
+/// Skips one value of any kind. Leaves @p pos one past it
+bool skipValue(std::string_view json, size_t &pos)
+{
+    if (pos >= json.size())
+        return false;
+
+    const char first = json[pos];
+    if (first == '"')
+        return skipString(json, pos);
+
+    if (first != '{' && first != '[') {
+        // Number, true, false or null
+        while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' && !isWhitespace(json[pos])) {
+            ++pos;
+        }
+        return true;
+    }
+
+    size_t depth = 0;
+    while (pos < json.size()) {
+        switch (json[pos]) {
+        case '"':
+            if (!skipString(json, pos))
+                return false;
+            continue;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0) {
+                ++pos;
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+        ++pos;
+    }
+
+    return false;
+}
+
+std::optional<std::vector<std::string_view>> splitArray(std::string_view json, size_t &pos)
+{
+    std::vector<std::string_view> elements;
+    ++pos;
+    skipWhitespace(json, pos);
+    if (pos < json.size() && json[pos] == ']') {
+        ++pos;
+        return elements;
+    }
+
+    while (pos < json.size()) {
+        const size_t start = pos;
+        if (!skipValue(json, pos))
+            return std::nullopt;
+        elements.push_back(json.substr(start, pos - start));
+
+        skipWhitespace(json, pos);
+        if (pos >= json.size())
+            return std::nullopt;
+
+        if (json[pos] == ']') {
+            ++pos;
+            return elements;
+        }
+
+        if (json[pos] != ',')
+            return std::nullopt;
+        ++pos;
+        skipWhitespace(json, pos);
+    }
+
+    return std::nullopt;
+}
+
+}
+
+std::optional<JsonArrayLayout> pointless::core::findTopLevelArray(std::string_view json, std::string_view key)
+{
+    size_t pos = 0;
+    skipWhitespace(json, pos);
+    if (pos >= json.size() || json[pos] != '{')
+        return std::nullopt;
+    ++pos;
+
+    std::optional<JsonArrayLayout> result;
+    while (true) {
+        skipWhitespace(json, pos);
+        if (pos >= json.size())
+            return std::nullopt;
+
+        if (json[pos] == '}')
+            break;
+
+        if (json[pos] != '"')
+            return std::nullopt;
+
+        const size_t keyStart = pos + 1;
+        bool hasEscapes = false;
+        if (!skipString(json, pos, &hasEscapes) || hasEscapes)
+            return std::nullopt;
+        const std::string_view name = json.substr(keyStart, pos - keyStart - 1);
+
+        skipWhitespace(json, pos);
+        if (pos >= json.size() || json[pos] != ':')
+            return std::nullopt;
+        ++pos;
+        skipWhitespace(json, pos);
+
+        if (name == key) {
+            if (result || pos >= json.size() || json[pos] != '[')
+                return std::nullopt;
+
+            JsonArrayLayout layout;
+            layout.begin = pos;
+            auto elements = splitArray(json, pos);
+            if (!elements)
+                return std::nullopt;
+            layout.end = pos;
+            layout.elements = std::move(*elements);
+            result = std::move(layout);
+        } else if (!skipValue(json, pos)) {
+            return std::nullopt;
+        }
+
+        skipWhitespace(json, pos);
+        if (pos < json.size() && json[pos] == ',') {
+            ++pos;
+        } else if (pos >= json.size() || json[pos] != '}') {
+            return std::nullopt;
+        }
+    }
+
+    return result;
+}
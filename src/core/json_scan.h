@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace pointless::core {
+
+/// Where an array member of the top-level JSON object sits, and where each of its elements is
+struct JsonArrayLayout
+{
+    size_t begin = 0; // the '['
+    size_t end = 0; // one past the ']'
+    std::vector<std::string_view> elements; // without surrounding whitespace
+};
+
+/// Finds the array called @p key in the top-level object of @p json with a structural scan, which
+/// only follows strings and nesting and doesn't parse any values.
+/// Returns nullopt if the document isn't shaped as expected, the key is missing or repeated, or
+/// any key has escapes, so callers can fall back to a regular parse.
+std::optional<JsonArrayLayout> findTopLevelArray(std::string_view json, std::string_view key);
+
+}
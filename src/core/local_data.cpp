@@ -4,77 +4,264 @@
 #include "local_data.h"
 #include "context.h"
 #include "logger.h"
+#include "mapped_file.h"
+#include "sqlite_store.h"
 #include "Clock.h"
 
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
 #include <cstdlib>
+#include <ranges>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 
 using namespace pointless;
 using namespace pointless::core;
 
+namespace {
+
+// Log compaction starts once the log outgrows this fraction of the snapshot
+constexpr uint64_t CompactionRatio = 4;
+constexpr uint64_t MinCompactionSize = 64 * 1024;
+
+// The data file keeps time points in milliseconds, what's finer in memory isn't a change
+Task atFilePrecision(Task task)
+{
+    auto truncate = [](std::chrono::system_clock::time_point &timePoint) {
+        timePoint = std::chrono::time_point_cast<std::chrono::milliseconds>(timePoint);
+    };
+
+    truncate(task.creationTimestamp);
+    for (auto *timePoint : { &task.modificationTimestamp, &task.lastPomodoroDate, &task.dueDate, &task.completionDate }) {
+        if (*timePoint)
+            truncate(**timePoint);
+    }
+    return task;
+}
+
+}
+
 LocalData::LocalData() = default;
 
 std::expected<void, TraceableError> LocalData::loadDataFromFile()
 {
-    auto result = loadDataFromFile(getDataFilePath());
+    if (auto flushed = flushSaves(); !flushed) {
+        P_LOG_ERROR("Failed to save data before loading: {}", flushed.error());
+    }
+
+    const auto filename = getDataFilePath();
+    auto result = loadDataFromFile(filename);
+    _unloggedEdits.clear();
     if (result) {
-        _data = result.value();
+        _data = std::make_shared<Data>(std::move(*result));
+        // A JSON file not imported into the database yet gets migrated by the first save
+        const bool sqlite = Context::self().sqliteStorage();
+        _needsSnapshot = !std::filesystem::exists(sqlite ? SqliteStore::pathFor(filename) : filename);
         return {};
     }
 
-    _data = {};
+    _data = std::make_shared<Data>();
+    _needsSnapshot = true;
     return TraceableError::create(result.error());
 }
 
 std::expected<pointless::core::Data, std::string> LocalData::loadDataFromFile(const std::string &filename) const
 {
+    if (Context::self().sqliteStorage()) {
+        const auto databasePath = SqliteStore::pathFor(filename);
+        if (std::filesystem::exists(databasePath)) {
+            auto store = SqliteStore::open(databasePath);
+            if (!store)
+                return std::unexpected(store.error());
+            return store->exportData();
+        }
+    }
+
     if (!std::filesystem::exists(filename)) {
         return Data {};
     }
 
-    std::ifstream file(filename);
+    // Parsed straight from the mapping, the file is never copied into memory
+    auto file = MappedFile::open(filename);
     if (!file) {
-        return std::unexpected("Failed to open file: " + filename);
+        return std::unexpected(file.error());
+    }
+
+    const std::string_view content = file->contents();
+    if (content.empty()) {
+        return std::unexpected("Failed to read data from file: " + filename);
     }
 
-    std::string json_content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    file.close();
+    // Whichever format the file was last written in, the next snapshot uses the configured one
+    auto data = Data::isBinary(content) ? Data::fromBinary(content) : Data::fromJson(content);
+    if (!data)
+        return data;
+
+    const OperationLog log(OperationLog::pathFor(filename));
+    replayLog(*data, log, OperationLog::snapshotIdOf(content));
 
-    if (json_content.empty()) {
-        return std::unexpected("Failed to read JSON from file: " + filename);
+    return data;
+}
+
+void LocalData::replayLog(Data &data, const OperationLog &log, const OperationLog::SnapshotId &snapshot) const
+{
+    auto records = log.readAll(snapshot);
+    if (!records) {
+        P_LOG_ERROR("Failed to read operation log: {}", records.error());
+        return;
     }
 
-    return Data::fromJson(json_content);
+    for (const auto &record : *records) {
+        if (auto edit = fromLogRecord(record)) {
+            replayEdit(data, *edit);
+        } else {
+            P_LOG_WARNING("Skipping unreadable record of type {} in {}", static_cast<int>(record.type), log.path());
+        }
+    }
+
+    if (!records->empty()) {
+        P_LOG_INFO("Replayed {} records from {}", records->size(), log.path());
+    }
 }
 
-std::expected<void, std::string> LocalData::save() const
+std::expected<void, std::string> LocalData::save()
+{
+    saveInBackground();
+    return flushSaves();
+}
+
+void LocalData::saveInBackground()
 {
     if (Context::self().readOnly()) {
         P_LOG_INFO("Skipping save, context is read-only");
-        return {};
+        return;
     }
 
-    P_LOG_INFO("Saving data to disk, numTasks={}, revision={}", _data.taskCount(), _data.revision());
+    if (_saver.takeFailure()) {
+        // Edits of the failed write may be missing from the log
+        _needsSnapshot = true;
+    }
 
     const auto filename = getDataFilePath();
-    std::ofstream file(filename);
-    if (!file) {
-        return std::unexpected("Failed to open file for writing: " + filename);
+    BackgroundSaver::Request request;
+    request.filename = filename;
+    request.binary = Context::self().binarySnapshot();
+    request.sqlite = Context::self().sqliteStorage();
+
+    std::vector<OperationLog::Record> records;
+    if (!_needsSnapshot) {
+        records.reserve(_unloggedEdits.size());
+        for (const auto &edit : _unloggedEdits) {
+            records.push_back(toLogRecord(edit));
+        }
     }
 
-    const auto jsonResult = _data.toJson();
-    if (!jsonResult) {
-        return std::unexpected(jsonResult.error());
+    // The database has no log to compact, but tag renames are only saved with a full import
+    // Bookkeeping, not part of what's saved, so it doesn't unshare a snapshot still being written
+    _data->needsLocalSave = false;
+
+    const bool needsSnapshot = _needsSnapshot || (request.sqlite ? !SqliteStore::canApply(records) : logNeedsCompaction(filename));
+    if (needsSnapshot) {
+        request.snapshot = snapshot();
+        _needsSnapshot = false;
+    } else {
+        request.records = std::move(records);
     }
 
-    file << jsonResult.value();
-    if (!file) {
-        return std::unexpected("Failed to write to file: " + filename);
+    _unloggedEdits.clear();
+    _saver.enqueue(std::move(request));
+}
+
+std::expected<void, std::string> LocalData::flushSaves()
+{
+    return _saver.flush();
+}
+
+bool LocalData::logNeedsCompaction(const std::string &filename)
+{
+    if (_saver.isWritingSnapshot())
+        return false;
+
+    std::error_code ec;
+    const uint64_t logSize = std::filesystem::file_size(OperationLog::pathFor(filename), ec);
+    if (ec)
+        return false;
+
+    const uint64_t snapshotSize = std::filesystem::file_size(filename, ec);
+    if (logSize < std::max(MinCompactionSize, ec ? 0 : snapshotSize / CompactionRatio))
+        return false;
+
+    P_LOG_INFO("Compacting operation log of {} bytes", logSize);
+    return true;
+}
+
+OperationLog::Record LocalData::toLogRecord(const Edit &edit)
+{
+    using Type = OperationLog::RecordType;
+
+    if (const auto *added = std::get_if<TaskAdded>(&edit)) {
+        return { Type::TaskUpsert, glz::write_json(added->task).value_or("") };
+    }
+    if (const auto *updated = std::get_if<TaskUpdated>(&edit)) {
+        return { Type::TaskUpsert, glz::write_json(updated->task).value_or("") };
+    }
+    if (const auto *removed = std::get_if<TaskRemoved>(&edit)) {
+        std::string body;
+        for (const Uuid &uuid : removed->uuids) {
+            body += uuid.toString();
+            body += '\n';
+        }
+        return { Type::TaskDelete, std::move(body) };
+    }
+    if (const auto *tagAdded = std::get_if<TagAdded>(&edit)) {
+        return { Type::TagAdd, glz::write_json(tagAdded->tag).value_or("") };
+    }
+    if (const auto *tagRemoved = std::get_if<TagRemoved>(&edit)) {
+        return { Type::TagRemove, tagRemoved->name };
+    }
+
+    const auto &renamed = std::get<TagRenamed>(edit);
+    return { Type::TagRename, renamed.oldName + '\n' + renamed.newName };
+}
+
+std::optional<LocalData::Edit> LocalData::fromLogRecord(const OperationLog::Record &record)
+{
+    using Type = OperationLog::RecordType;
+
+    switch (record.type) {
+    case Type::TaskUpsert: {
+        // Replayed as an add, which overwrites an existing task with the same uuid
+        Task task;
+        if (glz::read_json(task, record.body))
+            return std::nullopt;
+        return TaskAdded { std::move(task) };
+    }
+    case Type::TaskDelete: {
+        TaskRemoved removed;
+        for (auto line : std::views::split(std::string_view(record.body), '\n')) {
+            if (!line.empty())
+                removed.uuids.emplace_back(std::string_view(line.begin(), line.end()));
+        }
+        return removed;
+    }
+    case Type::TagAdd: {
+        Tag tag;
+        if (glz::read_json(tag, record.body))
+            return std::nullopt;
+        return TagAdded { std::move(tag) };
+    }
+    case Type::TagRemove:
+        return TagRemoved { record.body };
+    case Type::TagRename: {
+        const auto separator = record.body.find('\n');
+        if (separator == std::string::npos)
+            return std::nullopt;
+        return TagRenamed { record.body.substr(0, separator), record.body.substr(separator + 1) };
+    }
     }
 
-    _data.needsLocalSave = false;
-    return {};
+    return std::nullopt;
 }
 
 std::expected<void, std::string> LocalData::setDataAndSave(const Data &data)
@@ -88,55 +275,388 @@ std::string LocalData::getDataFilePath() const
     return core::Context::self().localFilePath();
 }
 
+TaskArchive &LocalData::archive()
+{
+    const auto path = TaskArchive::pathFor(getDataFilePath());
+    if (!_archive || _archive->path() != path)
+        _archive.emplace(path);
+    return *_archive;
+}
+
+bool LocalData::FileChanges::isEmpty() const
+{
+    return addedTasks.empty() && updatedTasks.empty() && removedTasks.empty() && addedTags.empty() && removedTags.empty();
+}
+
+std::vector<std::string> LocalData::watchedFiles() const
+{
+    return BackgroundSaver::writtenFiles(getDataFilePath(), Context::self().sqliteStorage());
+}
+
+std::expected<LocalData::FileChanges, std::string> LocalData::readFileChanges()
+{
+    const auto files = watchedFiles();
+    if (files.empty())
+        return FileChanges {};
+
+    // Our own saves trigger the watcher as well
+    if (auto flushed = flushSaves(); !flushed)
+        return std::unexpected(flushed.error());
+    if (std::ranges::all_of(files, [this](const std::string &path) { return _saver.isOwnWrite(path); }))
+        return FileChanges {};
+
+    if (_needsSnapshot && _data->needsLocalSave) {
+        // Replaced wholesale and not saved yet, the edits since the file was written are unknown
+        P_LOG_INFO("Ignoring external change to {}, local data is about to replace it", files.front());
+        return FileChanges {};
+    }
+
+    // Exported from the database in SQLite mode
+    auto onDisk = loadDataFromFile(getDataFilePath());
+    if (!onDisk)
+        return std::unexpected(onDisk.error());
+
+    std::unordered_set<Uuid> unsavedTasks;
+    std::unordered_set<std::string> unsavedTags;
+    for (const auto &edit : _unloggedEdits) {
+        if (const auto *added = std::get_if<TaskAdded>(&edit)) {
+            unsavedTasks.insert(added->task.uuid);
+        } else if (const auto *updated = std::get_if<TaskUpdated>(&edit)) {
+            unsavedTasks.insert(updated->task.uuid);
+        } else if (const auto *removed = std::get_if<TaskRemoved>(&edit)) {
+            unsavedTasks.insert(removed->uuids.begin(), removed->uuids.end());
+        } else if (const auto *tagAdded = std::get_if<TagAdded>(&edit)) {
+            unsavedTags.insert(tagAdded->tag.name);
+        } else if (const auto *tagRemoved = std::get_if<TagRemoved>(&edit)) {
+            unsavedTags.insert(tagRemoved->name);
+        } else if (const auto *renamed = std::get_if<TagRenamed>(&edit)) {
+            unsavedTags.insert(renamed->oldName);
+            unsavedTags.insert(renamed->newName);
+        }
+    }
+
+    FileChanges changes;
+    for (const Task &task : onDisk->tasks()) {
+        if (unsavedTasks.contains(task.uuid))
+            continue;
+        const Task *current = _data->taskForUuid(task.uuid);
+        if (current == nullptr) {
+            changes.addedTasks.push_back(task);
+        } else if (!(*current == task) && !(atFilePrecision(*current) == task)) {
+            changes.updatedTasks.push_back(task);
+        }
+    }
+    for (const Task &task : _data->tasks()) {
+        if (!unsavedTasks.contains(task.uuid) && onDisk->taskForUuid(task.uuid) == nullptr)
+            changes.removedTasks.push_back(task.uuid);
+    }
+
+    for (const Tag &tag : onDisk->tags()) {
+        if (!unsavedTags.contains(tag.name) && !_data->containsTag(tag.name))
+            changes.addedTags.push_back(tag);
+    }
+    for (const Tag &tag : _data->tags()) {
+        if (!unsavedTags.contains(tag.name) && !onDisk->containsTag(tag.name))
+            changes.removedTags.push_back(tag.name);
+    }
+
+    return changes;
+}
+
+void LocalData::storeTaskFromFile(const Task &task)
+{
+    Data &data = mutableData();
+    if (!data.setTask(task)) {
+        data.addTask(task);
+    }
+    data.needsLocalSave = true;
+    recordEdit(TaskAdded { task });
+}
+
 void LocalData::clearServerSyncBits()
 {
-    _data.clearServerSyncBits();
+    Data cleared = *_data;
+    cleared.clearServerSyncBits();
+    installData(std::move(cleared));
 }
 
 void LocalData::setData(const Data &data)
 {
-    _data = data;
+    invalidateLog();
+    _data = std::make_shared<Data>(data);
+    P_LOG_DEBUG("Set new data");
+}
+
+void LocalData::setData(Data &&data)
+{
+    invalidateLog();
+    _data = std::make_shared<Data>(std::move(data));
     P_LOG_DEBUG("Set new data");
 }
 
-bool LocalData::removeTask(const std::string &uuid)
+std::shared_ptr<const Data> LocalData::snapshot() const
+{
+    return _data;
+}
+
+Data &LocalData::mutableData()
 {
-    if (_data.removeTask(uuid)) {
-        _data.addDeletedTaskUuid(uuid);
+    // Unshared before the first edit after a snapshot was taken, if it's still held
+    if (_data.use_count() > 1) {
+        _data = std::make_shared<Data>(*_data);
+    }
+    return *_data;
+}
+
+std::shared_ptr<const Data> LocalData::beginRebase()
+{
+    if (_rebaseBase) {
+        P_LOG_WARNING("Rebase already in progress, discarding {} journaled edits", _journal.size());
+    }
+
+    _journal.clear();
+    _rebaseBase = snapshot();
+    return _rebaseBase;
+}
+
+void LocalData::finishRebase(Data merged)
+{
+    for (const auto &edit : _journal) {
+        replayEdit(merged, edit);
+    }
+
+    if (!_journal.empty()) {
+        P_LOG_INFO("Replayed {} local edits on top of merged data", _journal.size());
+        merged.needsLocalSave = true;
+    }
+
+    installData(std::move(merged));
+    abortRebase();
+}
+
+void LocalData::installData(Data data)
+{
+    auto edits = editsBetween(*_data, data);
+    if (!edits) {
+        invalidateLog();
+        _data = std::make_shared<Data>(std::move(data));
+        return;
+    }
+
+    // Unchanged, or only tasks added or changed, which the log appends like local edits
+    if (edits->empty())
+        return;
+
+    data.needsLocalSave = true;
+    _data = std::make_shared<Data>(std::move(data));
+    if (!_needsSnapshot) {
+        _unloggedEdits.insert(_unloggedEdits.end(), std::make_move_iterator(edits->begin()), std::make_move_iterator(edits->end()));
+    }
+}
+
+std::optional<std::vector<LocalData::Edit>> LocalData::editsBetween(const Data &before, const Data &after)
+{
+    const auto sameTag = [](const Tag &a, const Tag &b) {
+        return a.name == b.name && a.revision == b.revision && a.needsSyncToServer == b.needsSyncToServer;
+    };
+    if (before.revision() != after.revision() || before.deletedTaskUuids() != after.deletedTaskUuids()
+        || before.deletedTagNames() != after.deletedTagNames() || !std::ranges::equal(before.tags(), after.tags(), sameTag)) {
+        return std::nullopt;
+    }
+
+    std::vector<Edit> edits;
+    size_t addedCount = 0;
+    for (const Task &task : after.tasks()) {
+        const Task *old = before.taskForUuid(task.uuid);
+        if (old == nullptr) {
+            ++addedCount;
+            edits.emplace_back(TaskAdded { task });
+        } else if (!(*old == task)) {
+            edits.emplace_back(TaskAdded { task });
+        }
+    }
+
+    // Replaying a removal leaves a tombstone behind, the merge's removals don't
+    if (after.taskCount() - addedCount != before.taskCount())
+        return std::nullopt;
+
+    return edits;
+}
+
+void LocalData::abortRebase()
+{
+    _rebaseBase.reset();
+    _journal.clear();
+}
+
+void LocalData::recordEdit(Edit edit)
+{
+    if (!std::holds_alternative<TaskRemoved>(edit))
+        countBatchEdit();
+    if (!_needsSnapshot) {
+        _unloggedEdits.push_back(edit);
+    }
+    if (_rebaseBase) {
+        _journal.push_back(std::move(edit));
+    }
+}
+
+void LocalData::invalidateLog()
+{
+    _needsSnapshot = true;
+    _unloggedEdits.clear();
+}
+
+void LocalData::replayEdit(Data &data, const Edit &edit) const
+{
+    if (const auto *added = std::get_if<TaskAdded>(&edit)) {
+        if (!data.setTask(added->task)) {
+            data.addTask(added->task);
+        }
+    } else if (const auto *updated = std::get_if<TaskUpdated>(&edit)) {
+        const Task *current = data.taskForUuid(updated->task.uuid);
+        if (current == nullptr) {
+            P_LOG_INFO("Task '{}' was edited during refresh but deleted remotely, dropping edit", updated->task.uuid);
+            return;
+        }
+
+        // If the merge didn't touch the task, the edit applies on top of the merged revision.
+        // Otherwise keep the old revision so the next sync resolves it via Task::mergeConflict()
+        Task task = updated->task;
+        const Task *base = _rebaseBase ? _rebaseBase->taskForUuid(task.uuid) : nullptr;
+        if (base != nullptr && base->hasSameContent(*current)) {
+            task.revision = current->revision;
+        }
+        data.setTask(task);
+    } else if (const auto *removed = std::get_if<TaskRemoved>(&edit)) {
+        for (const Uuid &uuid : data.removeTasks(removed->uuids)) {
+            data.addDeletedTaskUuid(uuid);
+        }
+    } else if (const auto *tagAdded = std::get_if<TagAdded>(&edit)) {
+        if (!data.containsTag(tagAdded->tag.name))
+            data.addTag(tagAdded->tag);
+    } else if (const auto *tagRemoved = std::get_if<TagRemoved>(&edit)) {
+        if (data.removeTag(tagRemoved->name)) {
+            data.addDeletedTagName(tagRemoved->name);
+        }
+    } else if (const auto *renamed = std::get_if<TagRenamed>(&edit)) {
+        data.renameTag(renamed->oldName, renamed->newName);
+    }
+}
+
+bool LocalData::removeTask(const Uuid &uuid)
+{
+    if (isBatching()) {
+        if (_data->taskForUuid(uuid) == nullptr || !_pendingRemovalSet.insert(uuid).second)
+            return false;
+        _pendingRemovals.push_back(uuid);
+        countBatchEdit();
+        return true;
+    }
+
+    if (mutableData().removeTask(uuid)) {
+        mutableData().addDeletedTaskUuid(uuid);
+        recordEdit(TaskRemoved { { uuid } });
         return true;
     }
     return false;
 }
 
-const Task &LocalData::taskAt(size_t index) const
+void LocalData::removeTasksNow(std::span<const Uuid> uuids)
 {
-    return _data.taskAt(index);
+    auto removed = mutableData().removeTasks(uuids);
+    if (removed.empty())
+        return;
+
+    for (const Uuid &uuid : removed) {
+        mutableData().addDeletedTaskUuid(uuid);
+    }
+    mutableData().needsLocalSave = true;
+    recordEdit(TaskRemoved { std::move(removed) });
 }
 
-const Task *LocalData::taskForUuid(const std::string &uuid) const
+void LocalData::beginBatch()
 {
-    return _data.taskForUuid(uuid);
+    ++_batchDepth;
+}
+
+size_t LocalData::commit()
+{
+    if (_batchDepth == 0) {
+        P_LOG_WARNING("commit() called without beginBatch()");
+        return 0;
+    }
+
+    if (--_batchDepth > 0)
+        return 0;
+
+    if (_data->isDeferringIndexUpdates())
+        mutableData().flushIndexUpdates();
+    removeTasksNow(_pendingRemovals);
+    _pendingRemovals.clear();
+    _pendingRemovalSet.clear();
+
+    return std::exchange(_batchEditCount, 0);
 }
 
-Task *LocalData::taskForUuid(const std::string &uuid)
+bool LocalData::isBatching() const
 {
-    return _data.taskForUuid(uuid);
+    return _batchDepth > 0;
+}
+
+void LocalData::countBatchEdit()
+{
+    if (isBatching())
+        ++_batchEditCount;
+}
+
+const Task &LocalData::taskAt(size_t index) const
+{
+    return _data->taskAt(index);
+}
+
+const Task *LocalData::taskForUuid(const Uuid &uuid) const
+{
+    return _data->taskForUuid(uuid);
 }
 
 const Task *LocalData::taskForTitle(const std::string &title) const
 {
-    return _data.taskForTitle(title);
+    return _data->taskForTitle(title);
 }
 
 const Tag &LocalData::tagAt(size_t index) const
 {
-    return _data.tagAt(index);
+    return _data->tagAt(index);
+}
+
+bool LocalData::addTag(const Tag &tag)
+{
+    if (_data->containsTag(tag.name)) {
+        return false;
+    }
+
+    mutableData().addTag(tag);
+    mutableData().needsLocalSave = true;
+    recordEdit(TagAdded { tag });
+    return true;
 }
 
 bool LocalData::removeTag(const std::string &tagName)
 {
-    if (_data.removeTag(tagName)) {
-        _data.addDeletedTagName(tagName);
+    if (mutableData().removeTag(tagName)) {
+        mutableData().addDeletedTagName(tagName);
+        recordEdit(TagRemoved { tagName });
+        return true;
+    }
+    return false;
+}
+
+bool LocalData::renameTag(const std::string &oldName, const std::string &newName)
+{
+    if (mutableData().renameTag(oldName, newName)) {
+        mutableData().needsLocalSave = true;
+        recordEdit(TagRenamed { oldName, newName });
         return true;
     }
     return false;
@@ -144,12 +664,12 @@ bool LocalData::removeTag(const std::string &tagName)
 
 size_t LocalData::taskCount() const
 {
-    return _data.taskCount();
+    return _data->taskCount();
 }
 
 size_t LocalData::tagCount() const
 {
-    return _data.tagCount();
+    return _data->tagCount();
 }
 
 bool LocalData::updateTask(Task task)
@@ -158,78 +678,81 @@ bool LocalData::updateTask(Task task)
 
     task.modificationTimestamp = core::Clock::now();
     task.needsSyncToServer = true;
-    _data.needsLocalSave = true;
+    mutableData().needsLocalSave = true;
 
-    return _data.setTask(task);
+    if (mutableData().setTask(task)) {
+        recordEdit(TaskUpdated { std::move(task) });
+        return true;
+    }
+    return false;
 }
 
 int LocalData::cleanupOldData()
 {
-    std::vector<std::string> uuidsToRemove;
+    beginBatch();
 
-    for (size_t i = 0; i < _data.taskCount(); ++i) {
-        const auto &task = _data.taskAt(i);
-        if (task.shouldBeCleanedUp()) {
-            uuidsToRemove.push_back(task.uuid);
-        }
+    const auto candidates = TaskSelection::cleanupCandidates(_data->columns(), Clock::now());
+    std::vector<Task> archived;
+    archived.reserve(candidates.positions().size());
+    for (uint32_t position : candidates.positions()) {
+        archived.push_back(_data->taskAt(position));
     }
 
-    for (const auto &uuid : uuidsToRemove) {
-        removeTask(uuid);
+    // Archived before removal, so a failed write never loses tasks
+    if (auto result = archive().append(archived); !result) {
+        P_LOG_ERROR("Failed to archive old tasks: {}", result.error());
+        commit();
+        return 0;
     }
 
-    if (!uuidsToRemove.empty()) {
-        _data.needsLocalSave = true;
+    int count = 0;
+    for (const Task &task : archived) {
+        count += removeTask(task.uuid) ? 1 : 0;
     }
 
-    P_LOG_INFO("Cleaned up {} old tasks", uuidsToRemove.size());
-    return static_cast<int>(uuidsToRemove.size());
+    commit();
+
+    P_LOG_INFO("Cleaned up {} old tasks", count);
+    return count;
 }
 
 int LocalData::deleteCalendarTasks()
 {
-    std::vector<std::string> uuidsToRemove;
+    beginBatch();
 
-    for (size_t i = 0; i < _data.taskCount(); ++i) {
-        const auto &task = _data.taskAt(i);
+    int count = 0;
+    for (const Task &task : _data->tasks()) {
         if (task.uuidInDeviceCalendar.has_value()) {
-            uuidsToRemove.push_back(task.uuid);
+            count += removeTask(task.uuid) ? 1 : 0;
         }
     }
 
-    for (const auto &uuid : uuidsToRemove) {
-        removeTask(uuid);
-    }
-
-    if (!uuidsToRemove.empty()) {
-        _data.needsLocalSave = true;
-    }
+    commit();
 
-    P_LOG_INFO("Deleted {} calendar tasks", uuidsToRemove.size());
-    return static_cast<int>(uuidsToRemove.size());
+    P_LOG_INFO("Deleted {} calendar tasks", count);
+    return count;
 }
 
 int LocalData::deduplicateCalendarTasks()
 {
-    auto uuidsToRemove = _data.findDuplicateCalendarTaskUuids();
+    beginBatch();
 
-    for (const auto &uuid : uuidsToRemove) {
-        removeTask(uuid);
+    int count = 0;
+    for (const auto &uuid : _data->findDuplicateCalendarTaskUuids()) {
+        count += removeTask(uuid) ? 1 : 0;
     }
 
-    if (!uuidsToRemove.empty()) {
-        _data.needsLocalSave = true;
-    }
+    commit();
 
-    P_LOG_INFO("Deduplicated {} calendar tasks", uuidsToRemove.size());
-    return static_cast<int>(uuidsToRemove.size());
+    P_LOG_INFO("Deduplicated {} calendar tasks", count);
+    return count;
 }
 
 bool LocalData::addTask(Task task)
 {
     P_LOG_DEBUG("addTask '{}' LocalData={}", task.uuid, static_cast<void *>(this));
 
-    if (task.uuid.empty()) {
+    if (task.uuid.isEmpty()) {
         P_LOG_ERROR("Cannot add task with empty UUID");
         return false;
     }
@@ -237,8 +760,19 @@ bool LocalData::addTask(Task task)
     task.creationTimestamp = core::Clock::now();
     task.modificationTimestamp = task.creationTimestamp;
     task.needsSyncToServer = true;
-    _data.needsLocalSave = true;
-    _data.addTask(task);
+
+    // A batch sorts its tasks into the due date index once, when committed
+    if (isBatching() && !_data->isDeferringIndexUpdates())
+        mutableData().deferIndexUpdates();
+
+    // Replaying a TaskAdded overwrites, so a duplicate must not reach the log
+    if (!mutableData().addTask(task)) {
+        P_LOG_WARNING_NOABORT("addTask: task '{}' already exists", task.uuid);
+        return false;
+    }
+
+    mutableData().needsLocalSave = true;
+    recordEdit(TaskAdded { std::move(task) });
 
     return true;
 }
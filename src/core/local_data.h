@@ -5,9 +5,16 @@
 
 #include "data.h"
 #include "error.h"
+#include "background_saver.h"
+#include "operation_log.h"
+#include "task_archive.h"
 
 #include <expected>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <variant>
 
@@ -26,53 +33,176 @@ public:
 
     [[nodiscard]] std::expected<void, TraceableError> loadDataFromFile();
     [[nodiscard]] std::expected<Data, std::string> loadDataFromFile(const std::string &filename) const;
-    [[nodiscard]] std::expected<void, std::string> save() const;
 
-    [[nodiscard]] Data &data()
-    {
-        return _data;
-    }
+    /// Queues the edits made since the last save for appending to the operation log, or a full
+    /// snapshot when the data was replaced wholesale or the log grew too big. Written off-thread.
+    void saveInBackground();
+
+    /// Blocks until queued saves are on disk
+    [[nodiscard]] std::expected<void, std::string> flushSaves();
 
+    /// saveInBackground() followed by flushSaves()
+    [[nodiscard]] std::expected<void, std::string> save();
+
+    /// Read-only, edits go through the methods below so they are journaled and logged
     [[nodiscard]] const Data &data() const
     {
-        return _data;
+        return *_data;
     }
 
     void setData(const Data &data);
+    void setData(Data &&data);
+
+    /// The data as it is now, immutable and readable from any thread. Taking one is O(1), the next
+    /// edit copies the data once if the snapshot is still held by then
+    [[nodiscard]] std::shared_ptr<const Data> snapshot() const;
+
+    /// Returns the snapshot a background merge should start from and journals edits from now on.
+    /// finishRebase() installs the merged result and replays the journaled edits on top of it.
+    [[nodiscard]] std::shared_ptr<const Data> beginRebase();
+    void finishRebase(Data merged);
+    void abortRebase();
 
     [[nodiscard]] std::expected<void, std::string> setDataAndSave(const Data &data);
 
     [[nodiscard]] size_t taskCount() const;
     [[nodiscard]] const Task &taskAt(size_t index) const;
-    [[nodiscard]] const Task *taskForUuid(const std::string &uuid) const;
-    [[nodiscard]] Task *taskForUuid(const std::string &uuid);
+    [[nodiscard]] const Task *taskForUuid(const Uuid &uuid) const;
     [[nodiscard]] const Task *taskForTitle(const std::string &title) const;
     [[nodiscard]] size_t tagCount() const;
     [[nodiscard]] const Tag &tagAt(size_t index) const;
 
     [[nodiscard]] const std::vector<std::string> &deletedTags() const
     {
-        return _data.deletedTagNames();
+        return _data->deletedTagNames();
     }
 
-    [[nodiscard]] const std::vector<std::string> &deletedTasks() const
+    [[nodiscard]] const std::vector<Uuid> &deletedTasks() const
     {
-        return _data.deletedTaskUuids();
+        return _data->deletedTaskUuids();
     }
 
+    /// Groups edits until the matching commit(). Removals are deferred and applied by the outermost
+    /// commit() in a single pass, so bulk deletes are O(N). Added tasks are sorted into the due date
+    /// index by that commit() as well, due date queries don't see them before. Batches nest.
+    void beginBatch();
+
+    /// Returns how many edits the batch made, 0 for a nested commit. Callers notify views and
+    /// schedule a save once, based on this
+    size_t commit();
+    [[nodiscard]] bool isBatching() const;
+
     bool addTask(Task task);
     bool updateTask(Task task);
-    bool removeTask(const std::string &uuid);
+    bool removeTask(const Uuid &uuid);
+    bool addTag(const Tag &tag);
     bool removeTag(const std::string &tagName);
+    bool renameTag(const std::string &oldName, const std::string &newName);
+    /// Moves old completed tasks into the archive, then removes them. Returns how many were removed
     int cleanupOldData();
     int deleteCalendarTasks();
     int deduplicateCalendarTasks();
 
     void clearServerSyncBits();
 
+    /// Tasks moved out by cleanupOldData(), searchable without loading them
+    [[nodiscard]] TaskArchive &archive();
+
+    /// Tasks and tags another process changed in the data file, see readFileChanges()
+    struct FileChanges
+    {
+        std::vector<Task> addedTasks;
+        std::vector<Task> updatedTasks;
+        std::vector<Uuid> removedTasks;
+        std::vector<Tag> addedTags;
+        std::vector<std::string> removedTags;
+
+        [[nodiscard]] bool isEmpty() const;
+    };
+
+    /// The files other processes, like rename_tag, may edit while we hold the data in memory. The
+    /// database and its write-ahead log in SQLite mode
+    [[nodiscard]] std::vector<std::string> watchedFiles() const;
+
+    /// Diffs the data file, or what the database exports, against the data in memory after another
+    /// process wrote it. Empty when the files are as our last save left them. Tasks and tags with
+    /// unsaved local edits keep those
+    [[nodiscard]] std::expected<FileChanges, std::string> readFileChanges();
+
+    /// Stores @p task as the data file has it, timestamps and sync bits included
+    void storeTaskFromFile(const Task &task);
+
 private:
+    struct TaskAdded
+    {
+        Task task;
+    };
+    struct TaskUpdated
+    {
+        Task task;
+    };
+    struct TaskRemoved
+    {
+        std::vector<Uuid> uuids;
+    };
+    struct TagAdded
+    {
+        Tag tag;
+    };
+    struct TagRemoved
+    {
+        std::string name;
+    };
+    struct TagRenamed
+    {
+        std::string oldName;
+        std::string newName;
+    };
+    using Edit = std::variant<TaskAdded, TaskUpdated, TaskRemoved, TagAdded, TagRemoved, TagRenamed>;
+
+    void recordEdit(Edit edit);
+    void invalidateLog();
+
+    /// Replaces the data, logging the difference when the log can express it, so the next save
+    /// still appends. Otherwise the next save writes a snapshot
+    void installData(Data data);
+
+    /// What turns @p before into @p after as edits, nullopt if the log can't express it
+    static std::optional<std::vector<Edit>> editsBetween(const Data &before, const Data &after);
+    [[nodiscard]] bool logNeedsCompaction(const std::string &filename);
+    void replayLog(Data &data, const OperationLog &log, const OperationLog::SnapshotId &snapshot) const;
+
+    static OperationLog::Record toLogRecord(const Edit &edit);
+    static std::optional<Edit> fromLogRecord(const OperationLog::Record &record);
+
+    void removeTasksNow(std::span<const Uuid> uuids);
+    void countBatchEdit();
+    void replayEdit(Data &data, const Edit &edit) const;
+
     [[nodiscard]] std::string getDataFilePath() const;
-    Data _data;
+
+    /// The data for an edit, unshared from any snapshot first
+    Data &mutableData();
+
+    // Published as is by snapshot(), only the needsLocalSave bookkeeping changes while it is shared
+    std::shared_ptr<Data> _data = std::make_shared<Data>();
+    std::shared_ptr<const Data> _rebaseBase;
+    std::vector<Edit> _journal;
+
+    // Edits not yet in the operation log. When the data is replaced wholesale the log can't
+    // describe it and the next save writes a snapshot instead
+    std::vector<Edit> _unloggedEdits;
+    bool _needsSnapshot = true;
+
+    int _batchDepth = 0;
+    size_t _batchEditCount = 0;
+    std::vector<Uuid> _pendingRemovals;
+    std::unordered_set<Uuid> _pendingRemovalSet;
+
+    std::optional<TaskArchive> _archive;
+
+    // Last, so pending saves are flushed while the rest is still alive
+    BackgroundSaver _saver;
 };
 
 }
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+using namespace pointless::core;
+
+std::expected<MappedFile, std::string> MappedFile::open(const std::string &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected("Failed to open file: " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        const int error = errno;
+        ::close(fd);
+        return std::unexpected("Failed to stat file: " + path + ": " + std::strerror(error));
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return MappedFile(nullptr, 0);
+    }
+
+    void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int error = errno;
+
+    // The mapping holds its own reference to the file
+    ::close(fd);
+
+    if (address == MAP_FAILED) {
+        return std::unexpected("Failed to map file: " + path + ": " + std::strerror(error));
+    }
+
+#ifdef POSIX_MADV_SEQUENTIAL
+    ::posix_madvise(address, size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    return MappedFile(address, size);
+}
+
+MappedFile::MappedFile(void *address, size_t size)
+    : _address(address)
+    , _size(size)
+{
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : _address(std::exchange(other._address, nullptr))
+    , _size(std::exchange(other._size, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        _address = std::exchange(other._address, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+std::string_view MappedFile::contents() const
+{
+    return { static_cast<const char *>(_address), _size };
+}
+
+void MappedFile::unmap()
+{
+    if (_address != nullptr) {
+        ::munmap(_address, _size);
+        _address = nullptr;
+        _size = 0;
+    }
+}
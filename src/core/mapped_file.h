@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace pointless::core {
+
+/// Read-only mapping of a whole file, for parsing without copying it into memory first.
+/// The mapping keeps the contents it was opened with: saves replace the file with rename(),
+/// which leaves the mapped inode alive until the mapping goes away.
+class MappedFile
+{
+public:
+    [[nodiscard]] static std::expected<MappedFile, std::string> open(const std::string &path);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] std::string_view contents() const;
+
+private:
+    MappedFile(void *address, size_t size);
+    void unmap();
+
+    void *_address = nullptr;
+    size_t _size = 0;
+};
+
+}
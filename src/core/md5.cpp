@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "md5.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+using namespace pointless::core;
+
+namespace {
+
+// RFC 1321
+constexpr std::array<uint32_t, 64> Constants = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+constexpr std::array<int, 64> Shifts = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+    5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+    6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+uint32_t loadLittleEndian(const uint8_t *bytes)
+{
+    return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8U) | (uint32_t(bytes[2]) << 16U) | (uint32_t(bytes[3]) << 24U);
+}
+
+}
+
+Md5::Md5()
+    : _state { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 }
+{
+}
+
+void Md5::processBlock(const uint8_t *block)
+{
+    std::array<uint32_t, 16> words {};
+    for (size_t i = 0; i < words.size(); ++i) {
+        words[i] = loadLittleEndian(block + (i * 4));
+    }
+
+    uint32_t a = _state[0];
+    uint32_t b = _state[1];
+    uint32_t c = _state[2];
+    uint32_t d = _state[3];
+
+    for (size_t i = 0; i < 64; ++i) {
+        uint32_t f = 0;
+        size_t g = 0;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = ((5 * i) + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = ((3 * i) + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        const uint32_t rotated = std::rotl(a + f + Constants[i] + words[g], Shifts[i]);
+        a = d;
+        d = c;
+        c = b;
+        b += rotated;
+    }
+
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+}
+
+void Md5::update(std::string_view bytes)
+{
+    const auto *input = reinterpret_cast<const uint8_t *>(bytes.data());
+    size_t size = bytes.size();
+    _length += size;
+
+    if (_bufferSize > 0) {
+        const size_t taken = std::min(size, _buffer.size() - _bufferSize);
+        std::memcpy(_buffer.data() + _bufferSize, input, taken);
+        _bufferSize += taken;
+        input += taken;
+        size -= taken;
+        if (_bufferSize < _buffer.size())
+            return;
+        processBlock(_buffer.data());
+        _bufferSize = 0;
+    }
+
+    for (; size >= _buffer.size(); input += _buffer.size(), size -= _buffer.size()) {
+        processBlock(input);
+    }
+
+    std::memcpy(_buffer.data(), input, size);
+    _bufferSize = size;
+}
+
+std::string Md5::hexDigest() const
+{
+    Md5 final = *this;
+
+    // A 1 bit, zeros up to 56 bytes into a block, then the length in bits
+    const uint64_t lengthInBits = _length * 8;
+    const size_t paddingSize = (_bufferSize < 56 ? 56 : 120) - _bufferSize;
+    std::array<char, 72> padding {};
+    padding[0] = static_cast<char>(0x80);
+    for (size_t i = 0; i < 8; ++i) {
+        padding[paddingSize + i] = static_cast<char>((lengthInBits >> (8 * i)) & 0xFFU);
+    }
+    final.update(std::string_view(padding.data(), paddingSize + 8));
+
+    constexpr std::string_view Hex = "0123456789abcdef";
+    std::string digest;
+    digest.reserve(32);
+    for (uint32_t word : final._state) {
+        for (size_t i = 0; i < 4; ++i) {
+            const auto byte = static_cast<uint8_t>((word >> (8 * i)) & 0xFFU);
+            digest.push_back(Hex[byte >> 4U]);
+            digest.push_back(Hex[byte & 0x0FU]);
+        }
+    }
+    return digest;
+}
+
+std::string Md5::hexDigest(std::string_view bytes)
+{
+    Md5 md5;
+    md5.update(bytes);
+    return md5.hexDigest();
+}
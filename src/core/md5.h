@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace pointless::core {
+
+/// Incremental MD5, only to compare contents with what Postgres' md5() reports. Not for security
+class Md5
+{
+public:
+    Md5();
+
+    void update(std::string_view bytes);
+
+    /// Lowercase hex, like Postgres' md5(). Doesn't change the state, more updates can follow
+    [[nodiscard]] std::string hexDigest() const;
+
+    [[nodiscard]] static std::string hexDigest(std::string_view bytes);
+
+private:
+    void processBlock(const uint8_t *block);
+
+    std::array<uint32_t, 4> _state {};
+    std::array<uint8_t, 64> _buffer {};
+    size_t _bufferSize = 0;
+    uint64_t _length = 0;
+};
+
+}
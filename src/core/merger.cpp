@@ -3,8 +3,10 @@
 
 #include "merger.h"
 #include "logger.h"
+#include "uuid_index.h"
 
 #include <algorithm>
+#include <unordered_set>
 
 namespace pointless::core {
 
@@ -53,16 +55,17 @@ DataPayload merge(const DataPayload &localData, const DataPayload &serverData)
     }
 
     // Tasks
+    UuidIndex currentIndex;
+    currentIndex.rebuild(current.tasks);
+
     for (const auto &incomingTask : localData.tasks) {
         if (!incomingTask.needsSyncToServer) {
             continue;
         }
 
-        auto it = std::ranges::find_if(current.tasks, [&](const Task &t) {
-            return t.uuid == incomingTask.uuid;
-        });
+        const auto index = currentIndex.find(current.tasks, incomingTask.uuid);
 
-        if (it == current.tasks.end()) {
+        if (!index) {
             // Not in server
             if (incomingTask.revision <= 0) {
                 // New task
@@ -70,12 +73,13 @@ DataPayload merge(const DataPayload &localData, const DataPayload &serverData)
                 newTask.revision = 0;
                 newTask.needsSyncToServer = false;
                 current.tasks.push_back(newTask);
+                currentIndex.insert(current.tasks, current.tasks.size() - 1);
                 changed = true;
             }
             // Else: deleted on server, ignore.
         } else {
             // Exists in server
-            Task &existingTask = *it;
+            Task &existingTask = current.tasks[*index];
 
             if (existingTask.revision == incomingTask.revision) {
                 // Fast-forward
@@ -96,12 +100,9 @@ DataPayload merge(const DataPayload &localData, const DataPayload &serverData)
     }
 
     // Deleted tasks
-    for (const auto &uuid : localData.deletedTaskUuids) {
-        auto it = std::ranges::find_if(current.tasks, [&](const Task &t) {
-            return t.uuid == uuid;
-        });
-        if (it != current.tasks.end()) {
-            current.tasks.erase(it);
+    if (!localData.deletedTaskUuids.empty()) {
+        const std::unordered_set<Uuid> deletedUuids(localData.deletedTaskUuids.cbegin(), localData.deletedTaskUuids.cend());
+        if (std::erase_if(current.tasks, [&](const Task &t) { return deletedUuids.contains(t.uuid); }) > 0) {
             changed = true;
         }
     }
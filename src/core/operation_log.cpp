@@ -0,0 +1,287 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "operation_log.h"
+#include "file_io.h"
+#include "logger.h"
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+using namespace pointless::core;
+
+namespace {
+
+constexpr std::string_view Magic = "PLOG0001";
+constexpr size_t FrameHeaderSize = 8;
+
+// Not a RecordType, only ever the first frame, and never returned by readAll()
+constexpr auto SnapshotRecordType = static_cast<OperationLog::RecordType>(0);
+constexpr size_t SnapshotPayloadSize = 1 + 8 + 4;
+
+void putU32(std::string &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+uint32_t getU32(std::string_view in)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[static_cast<size_t>(i)])) << (i * 8);
+    }
+    return value;
+}
+
+void appendFrame(std::string &out, OperationLog::RecordType type, std::string_view body)
+{
+    std::string payload;
+    payload.reserve(body.size() + 1);
+    payload.push_back(static_cast<char>(type));
+    payload.append(body);
+
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, OperationLog::checksum(payload));
+    out.append(payload);
+}
+
+// The payload of the intact frame at @p offset, nullopt if it's torn or corrupt
+std::optional<std::string_view> frameAt(std::string_view content, size_t offset)
+{
+    if (offset + FrameHeaderSize > content.size())
+        return std::nullopt;
+
+    const std::string_view header = content.substr(offset, FrameHeaderSize);
+    const uint32_t payloadSize = getU32(header);
+    const uint32_t crc = getU32(header.substr(4));
+    if (payloadSize == 0 || offset + FrameHeaderSize + payloadSize > content.size())
+        return std::nullopt;
+
+    const std::string_view payload = content.substr(offset + FrameHeaderSize, payloadSize);
+    if (OperationLog::checksum(payload) != crc)
+        return std::nullopt;
+    return payload;
+}
+
+std::optional<OperationLog::SnapshotId> snapshotIdIn(std::string_view payload)
+{
+    if (payload.size() != SnapshotPayloadSize || static_cast<OperationLog::RecordType>(payload.front()) != SnapshotRecordType)
+        return std::nullopt;
+
+    const uint64_t low = getU32(payload.substr(1));
+    const uint64_t high = getU32(payload.substr(5));
+    return OperationLog::SnapshotId { .size = low | (high << 32U), .checksum = getU32(payload.substr(9)) };
+}
+
+std::expected<std::string, std::string> readFile(const std::string &path, uint64_t size)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return std::unexpected("Failed to open log: " + path);
+
+    std::string content(size, '\0');
+    file.read(content.data(), static_cast<std::streamsize>(size));
+    content.resize(static_cast<size_t>(file.gcount()));
+    return content;
+}
+
+struct Scan
+{
+    bool ownSnapshot = true;
+    std::vector<OperationLog::Record> records;
+    size_t intactSize = 0;
+};
+
+// Everything after the snapshot frame and up to the first torn or corrupt frame
+Scan scan(std::string_view content, const OperationLog::SnapshotId &snapshot)
+{
+    Scan result;
+    size_t offset = Magic.size();
+    if (auto first = frameAt(content, offset)) {
+        if (auto named = snapshotIdIn(*first)) {
+            result.ownSnapshot = *named == snapshot;
+            offset += FrameHeaderSize + first->size();
+        }
+    }
+
+    while (result.ownSnapshot) {
+        const auto payload = frameAt(content, offset);
+        if (!payload)
+            break;
+        result.records.push_back({ static_cast<OperationLog::RecordType>(payload->front()), std::string(payload->substr(1)) });
+        offset += FrameHeaderSize + payload->size();
+    }
+
+    result.intactSize = offset;
+    return result;
+}
+
+}
+
+OperationLog::OperationLog(std::string path)
+    : _path(std::move(path))
+{
+}
+
+std::string OperationLog::pathFor(const std::string &dataFilename)
+{
+    return dataFilename + ".log";
+}
+
+const std::string &OperationLog::path() const
+{
+    return _path;
+}
+
+bool OperationLog::exists() const
+{
+    std::error_code ec;
+    return std::filesystem::exists(_path, ec);
+}
+
+uint64_t OperationLog::size() const
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(_path, ec);
+    return ec ? 0 : size;
+}
+
+std::expected<void, std::string> OperationLog::append(const std::vector<Record> &records, const SnapshotId &snapshot)
+{
+    if (records.empty())
+        return {};
+
+    if (fileStamp(_path) != _appended || snapshot != _appendedSnapshot) {
+        if (auto result = prepareForAppend(snapshot); !result)
+            return result;
+    }
+
+    std::string buffer;
+    const bool creating = size() == 0;
+    if (creating) {
+        buffer.append(Magic);
+        std::string body;
+        putU32(body, static_cast<uint32_t>(snapshot.size & 0xFFFFFFFFU));
+        putU32(body, static_cast<uint32_t>(snapshot.size >> 32U));
+        putU32(body, snapshot.checksum);
+        appendFrame(buffer, SnapshotRecordType, body);
+    }
+
+    for (const Record &record : records) {
+        appendFrame(buffer, record.type, record.body);
+    }
+
+    _appended.reset();
+    if (auto result = appendToFile(_path, buffer); !result)
+        return result;
+
+    // Or the new log, and the edits in it, can vanish in a power loss
+    if (creating) {
+        if (auto result = syncParentDirectory(_path); !result)
+            return result;
+    }
+
+    _appended = fileStamp(_path);
+    _appendedSnapshot = snapshot;
+    return {};
+}
+
+std::expected<void, std::string> OperationLog::prepareForAppend(const SnapshotId &snapshot)
+{
+    const uint64_t fileSize = size();
+    if (fileSize == 0)
+        return {};
+
+    auto content = readFile(_path, fileSize);
+    if (!content)
+        return std::unexpected(content.error());
+
+    // A log without a snapshot frame predates them, it belongs to the current snapshot
+    const auto first = content->starts_with(Magic) ? frameAt(*content, Magic.size()) : std::nullopt;
+    const Scan result = first ? scan(*content, snapshot) : Scan { .ownSnapshot = false, .records = {}, .intactSize = 0 };
+    if (!result.ownSnapshot) {
+        P_LOG_INFO("Starting over {}, it doesn't belong to the current snapshot", _path);
+        remove();
+        return {};
+    }
+
+    if (result.intactSize != content->size()) {
+        P_LOG_WARNING_NOABORT("Discarding {} bytes of torn or corrupt records at the end of {}", content->size() - result.intactSize, _path);
+        std::error_code ec;
+        std::filesystem::resize_file(_path, result.intactSize, ec);
+        if (ec) {
+            return std::unexpected("Failed to truncate log " + _path + ": " + ec.message());
+        }
+    }
+
+    return {};
+}
+
+std::expected<std::vector<OperationLog::Record>, std::string> OperationLog::readAll(const SnapshotId &snapshot) const
+{
+    const uint64_t fileSize = size();
+    if (fileSize == 0)
+        return std::vector<Record> {};
+
+    auto content = readFile(_path, fileSize);
+    if (!content)
+        return std::unexpected(content.error());
+
+    if (!content->starts_with(Magic)) {
+        // Torn while it was being created, before any record was in it
+        if (Magic.starts_with(*content))
+            return std::vector<Record> {};
+        return std::unexpected("Not an operation log: " + _path);
+    }
+
+    Scan result = scan(*content, snapshot);
+    if (!result.ownSnapshot) {
+        P_LOG_INFO("Ignoring {}, it belongs to another snapshot", _path);
+    } else if (result.intactSize != content->size()) {
+        // Left for the writer to cut off before its next append, reading never changes the file
+        P_LOG_WARNING_NOABORT("Ignoring {} bytes of torn or corrupt records at the end of {}", content->size() - result.intactSize, _path);
+    }
+
+    return std::move(result.records);
+}
+
+std::expected<void, std::string> OperationLog::moveTo(const std::string &newPath)
+{
+    std::error_code ec;
+    std::filesystem::rename(_path, newPath, ec);
+    if (ec) {
+        return std::unexpected("Failed to move log " + _path + " to " + newPath + ": " + ec.message());
+    }
+    return {};
+}
+
+void OperationLog::remove()
+{
+    std::error_code ec;
+    if (!std::filesystem::remove(_path, ec)) {
+        if (ec) {
+            P_LOG_WARNING("Failed to remove log {}: {}", _path, ec.message());
+        }
+        return;
+    }
+
+    if (auto result = syncParentDirectory(_path); !result) {
+        P_LOG_WARNING("Failed to remove log {} durably: {}", _path, result.error());
+    }
+}
+
+uint32_t OperationLog::checksum(std::string_view bytes)
+{
+    const auto crc = ::crc32(0L, Z_NULL, 0);
+    return static_cast<uint32_t>(::crc32(crc, reinterpret_cast<const Bytef *>(bytes.data()), static_cast<uInt>(bytes.size())));
+}
+
+OperationLog::SnapshotId OperationLog::snapshotIdOf(std::string_view snapshot)
+{
+    return { .size = snapshot.size(), .checksum = checksum(snapshot) };
+}
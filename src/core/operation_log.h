@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "file_io.h"
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pointless::core {
+
+/// Append-only file of checksummed records, one per local edit, written between full snapshots.
+/// Each frame is the payload size (u32 LE), the crc32 of the payload (u32 LE) and the payload.
+/// The first frame names the snapshot the log was started for, logs written before that have none.
+class OperationLog
+{
+public:
+    /// The size and crc32 of a snapshot file. A log only applies to the snapshot it names, one
+    /// that outlived it, say after a crash between a snapshot's rename and the log's removal,
+    /// would put old edits back on top of newer data
+    struct SnapshotId
+    {
+        uint64_t size = 0;
+        uint32_t checksum = 0;
+
+        bool operator==(const SnapshotId &other) const = default;
+    };
+
+    enum class RecordType : uint8_t {
+        TaskUpsert = 1,
+        TaskDelete,
+        TagAdd,
+        TagRemove,
+        TagRename,
+    };
+
+    struct Record
+    {
+        RecordType type;
+        std::string body;
+    };
+
+    explicit OperationLog(std::string path);
+
+    /// The log that belongs to the local data file @p dataFilename
+    static std::string pathFor(const std::string &dataFilename);
+
+    [[nodiscard]] const std::string &path() const;
+    [[nodiscard]] bool exists() const;
+    [[nodiscard]] uint64_t size() const;
+
+    /// Appends and fsyncs. A log that belongs to another snapshot, or whose magic is torn, is
+    /// started over for @p snapshot, and a torn or corrupt tail is cut off first so the new records
+    /// stay reachable. Creating the file also fsyncs its directory.
+    /// Only the file's writer appends, the log is checked again whenever it isn't as this
+    /// instance's last append left it, or was for another snapshot
+    [[nodiscard]] std::expected<void, std::string> append(const std::vector<Record> &records, const SnapshotId &snapshot);
+
+    /// Reads the intact records, leaving the file alone. A torn or corrupt tail is skipped.
+    /// A log of another snapshot has no records for this one, a log that names none is read anyway
+    [[nodiscard]] std::expected<std::vector<Record>, std::string> readAll(const SnapshotId &snapshot) const;
+
+    [[nodiscard]] std::expected<void, std::string> moveTo(const std::string &newPath);
+
+    /// Also fsyncs the directory, so the log can't come back after a power loss
+    void remove();
+
+    static uint32_t checksum(std::string_view bytes);
+    static SnapshotId snapshotIdOf(std::string_view snapshot);
+
+private:
+    /// Drops or truncates what append() can't append behind
+    [[nodiscard]] std::expected<void, std::string> prepareForAppend(const SnapshotId &snapshot);
+
+    std::string _path;
+    std::optional<FileStamp> _appended;
+    SnapshotId _appendedSnapshot;
+};
+
+}
@@ -0,0 +1,489 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "output_sink.h"
+#include "base64.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace pointless::core;
+
+namespace {
+
+// Input bytes encoded per write to the next sink, keeps the encoded buffer bounded
+constexpr size_t Base64Slice = 3 * 4096;
+constexpr size_t Base64DecodeSlice = 4 * 4096;
+
+// The bytes of a quad cut short by padding or the end of input, 2 or 3 characters
+void decodePartialQuad(std::string &out, uint32_t quad, size_t quadSize)
+{
+    if (quadSize == 2) {
+        out.push_back(static_cast<char>((quad >> 4U) & 0xFFU));
+    } else if (quadSize == 3) {
+        out.push_back(static_cast<char>((quad >> 10U) & 0xFFU));
+        out.push_back(static_cast<char>((quad >> 2U) & 0xFFU));
+    }
+}
+
+bool isJsonWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void encodeTriple(std::string &out, uint8_t a, uint8_t b, uint8_t c, size_t count)
+{
+    const uint32_t value = (uint32_t(a) << 16U) | (uint32_t(b) << 8U) | uint32_t(c);
+    out.push_back(Base64::Alphabet[(value >> 18U) & 0x3FU]);
+    out.push_back(Base64::Alphabet[(value >> 12U) & 0x3FU]);
+    out.push_back(count > 1 ? Base64::Alphabet[(value >> 6U) & 0x3FU] : '=');
+    out.push_back(count > 2 ? Base64::Alphabet[value & 0x3FU] : '=');
+}
+
+}
+
+OutputSink::~OutputSink() = default;
+
+std::expected<void, std::string> OutputSink::finish()
+{
+    return {};
+}
+
+StringSink::StringSink(std::string &out)
+    : _out(out)
+{
+}
+
+std::expected<void, std::string> StringSink::write(std::string_view bytes)
+{
+    _out.append(bytes);
+    return {};
+}
+
+struct GzipSink::Stream
+{
+    z_stream zs {};
+};
+
+GzipSink::GzipSink(OutputSink &next)
+    : _next(next)
+    , _stream(std::make_unique<Stream>())
+{
+    // Same gzip framing as GunzipSink expects
+    if (deflateInit2(&_stream->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        _stream.reset();
+}
+
+GzipSink::~GzipSink()
+{
+    if (_stream)
+        deflateEnd(&_stream->zs);
+}
+
+std::expected<void, std::string> GzipSink::write(std::string_view bytes)
+{
+    if (!_stream)
+        return std::unexpected("Failed to initialize zlib deflation");
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-type-const-cast)
+    _stream->zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+    _stream->zs.avail_in = static_cast<uInt>(bytes.size());
+    return deflateInput(Z_NO_FLUSH);
+}
+
+std::expected<void, std::string> GzipSink::finish()
+{
+    if (!_stream)
+        return std::unexpected("Failed to initialize zlib deflation");
+
+    _stream->zs.next_in = nullptr;
+    _stream->zs.avail_in = 0;
+    if (auto result = deflateInput(Z_FINISH); !result)
+        return result;
+
+    return _next.finish();
+}
+
+std::expected<void, std::string> GzipSink::deflateInput(int flush)
+{
+    z_stream &zs = _stream->zs;
+    int ret = Z_OK;
+    do {
+        zs.next_out = reinterpret_cast<Bytef *>(_buffer.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        zs.avail_out = static_cast<uInt>(_buffer.size());
+        ret = deflate(&zs, flush);
+        if (ret == Z_STREAM_ERROR)
+            return std::unexpected("Failed to compress gzip data");
+
+        const size_t produced = _buffer.size() - zs.avail_out;
+        if (produced > 0) {
+            if (auto result = _next.write({ _buffer.data(), produced }); !result)
+                return result;
+        }
+    } while (zs.avail_out == 0 || zs.avail_in > 0);
+
+    if (flush == Z_FINISH && ret != Z_STREAM_END)
+        return std::unexpected("Failed to compress gzip data");
+
+    return {};
+}
+
+Base64Sink::Base64Sink(OutputSink &next)
+    : _next(next)
+{
+}
+
+std::expected<void, std::string> Base64Sink::write(std::string_view bytes)
+{
+    while (!bytes.empty()) {
+        const std::string_view slice = bytes.substr(0, Base64Slice);
+        bytes.remove_prefix(slice.size());
+
+        _encoded.clear();
+        size_t i = 0;
+
+        // Complete the triple left over from the previous write
+        while (_pendingSize > 0 && _pendingSize < 3 && i < slice.size()) {
+            _pending[_pendingSize++] = static_cast<uint8_t>(slice[i++]);
+        }
+        if (_pendingSize == 3) {
+            encodeTriple(_encoded, _pending[0], _pending[1], _pending[2], 3);
+            _pendingSize = 0;
+        }
+
+        const size_t triples = (slice.size() - i) / 3 * 3;
+        const size_t encodedSize = _encoded.size();
+        _encoded.resize(encodedSize + (triples / 3 * 4));
+        Base64::encodeTriples({ reinterpret_cast<const uint8_t *>(slice.data() + i), triples }, _encoded.data() + encodedSize); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        i += triples;
+
+        for (; i < slice.size(); ++i) {
+            _pending[_pendingSize++] = static_cast<uint8_t>(slice[i]);
+        }
+
+        if (!_encoded.empty()) {
+            if (auto result = _next.write(_encoded); !result)
+                return result;
+        }
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> Base64Sink::finish()
+{
+    if (_pendingSize > 0) {
+        _encoded.clear();
+        encodeTriple(_encoded, _pending[0], _pendingSize > 1 ? _pending[1] : 0, 0, _pendingSize);
+        _pendingSize = 0;
+        if (auto result = _next.write(_encoded); !result)
+            return result;
+    }
+
+    return _next.finish();
+}
+
+struct GunzipSink::Stream
+{
+    z_stream zs {};
+};
+
+GunzipSink::GunzipSink(OutputSink &next)
+    : _next(next)
+    , _stream(std::make_unique<Stream>())
+{
+    if (inflateInit2(&_stream->zs, MAX_WBITS + 16) != Z_OK)
+        _stream.reset();
+}
+
+GunzipSink::~GunzipSink()
+{
+    if (_stream)
+        inflateEnd(&_stream->zs);
+}
+
+std::expected<void, std::string> GunzipSink::write(std::string_view bytes)
+{
+    if (!_stream)
+        return std::unexpected("Failed to initialize zlib inflation");
+    if (bytes.empty())
+        return {};
+    if (_ended)
+        return std::unexpected("Data after the end of the gzip stream");
+
+    z_stream &zs = _stream->zs;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-type-const-cast)
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+    zs.avail_in = static_cast<uInt>(bytes.size());
+
+    do {
+        zs.next_out = reinterpret_cast<Bytef *>(_buffer.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        zs.avail_out = static_cast<uInt>(_buffer.size());
+        const int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+            return std::unexpected("Failed to decompress gzip data");
+
+        const size_t produced = _buffer.size() - zs.avail_out;
+        if (produced > 0) {
+            if (auto result = _next.write({ _buffer.data(), produced }); !result)
+                return result;
+        }
+
+        if (ret == Z_STREAM_END) {
+            _ended = true;
+            if (zs.avail_in > 0)
+                return std::unexpected("Data after the end of the gzip stream");
+            break;
+        }
+        if (ret == Z_BUF_ERROR)
+            break; // Needs more input
+    } while (zs.avail_in > 0 || zs.avail_out == 0);
+
+    return {};
+}
+
+std::expected<void, std::string> GunzipSink::finish()
+{
+    if (!_stream)
+        return std::unexpected("Failed to initialize zlib inflation");
+    if (!_ended)
+        return std::unexpected("Truncated gzip data");
+
+    return _next.finish();
+}
+
+Base64DecodeSink::Base64DecodeSink(OutputSink &next)
+    : _next(next)
+{
+}
+
+std::expected<void, std::string> Base64DecodeSink::write(std::string_view bytes)
+{
+    while (!bytes.empty()) {
+        const std::string_view slice = bytes.substr(0, Base64DecodeSlice);
+        bytes.remove_prefix(slice.size());
+
+        _decoded.clear();
+        std::string_view rest = slice;
+
+        // Complete the quad left over from the previous write
+        while (_quadSize > 0 && _padding == 0 && !rest.empty()) {
+            if (auto result = decodeCharacter(rest.front()); !result)
+                return result;
+            rest.remove_prefix(1);
+        }
+
+        // Whole quads go through the SIMD kernel, padding and the tail below
+        if (_quadSize == 0 && _padding == 0) {
+            const size_t quads = rest.size() / 4 * 4;
+            const size_t decodedSize = _decoded.size();
+            _decoded.resize(decodedSize + (quads / 4 * 3));
+            const auto invalid = Base64::decodeQuads(rest.substr(0, quads), reinterpret_cast<uint8_t *>(_decoded.data() + decodedSize)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            const size_t decoded = invalid ? *invalid / 4 * 4 : quads;
+            _decoded.resize(decodedSize + (decoded / 4 * 3));
+            _offset += decoded;
+            rest.remove_prefix(decoded);
+        }
+
+        for (const char c : rest) {
+            if (auto result = decodeCharacter(c); !result)
+                return result;
+        }
+
+        if (!_decoded.empty()) {
+            if (auto result = _next.write(_decoded); !result)
+                return result;
+        }
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> Base64DecodeSink::decodeCharacter(char c)
+{
+    const int8_t value = Base64::valueOf(c);
+    if (value == Base64::InvalidValue || _padding > 0) {
+        // Padding completes the quad, a full one or one of two or three characters
+        if (c != '=' || _padded || _quadSize + _padding < 2)
+            return std::unexpected("Invalid base64 at offset " + std::to_string(_offset));
+
+        ++_padding;
+        ++_offset;
+        if (_quadSize + _padding == 4) {
+            decodePartialQuad(_decoded, _quad, _quadSize);
+            _quad = 0;
+            _quadSize = 0;
+            _padded = true;
+        }
+        return {};
+    }
+
+    _quad = (_quad << 6U) | static_cast<uint32_t>(value);
+    ++_offset;
+    if (++_quadSize == 4) {
+        _decoded.push_back(static_cast<char>((_quad >> 16U) & 0xFFU));
+        _decoded.push_back(static_cast<char>((_quad >> 8U) & 0xFFU));
+        _decoded.push_back(static_cast<char>(_quad & 0xFFU));
+        _quad = 0;
+        _quadSize = 0;
+    }
+    return {};
+}
+
+std::expected<void, std::string> Base64DecodeSink::finish()
+{
+    if ((_padding > 0 && !_padded) || _quadSize == 1)
+        return std::unexpected("Truncated base64 data");
+
+    // Unpadded input
+    if (_quadSize > 1) {
+        _decoded.clear();
+        decodePartialQuad(_decoded, _quad, _quadSize);
+        _quadSize = 0;
+        if (auto result = _next.write(_decoded); !result)
+            return result;
+    }
+
+    return _next.finish();
+}
+
+Md5Sink::Md5Sink(OutputSink &next)
+    : _next(next)
+{
+}
+
+std::expected<void, std::string> Md5Sink::write(std::string_view bytes)
+{
+    _md5.update(bytes);
+    return _next.write(bytes);
+}
+
+std::expected<void, std::string> Md5Sink::finish()
+{
+    return _next.finish();
+}
+
+std::string Md5Sink::hexDigest() const
+{
+    return _md5.hexDigest();
+}
+
+JsonStringFieldSink::JsonStringFieldSink(std::string key, OutputSink &next)
+    : _key(std::move(key))
+    , _next(next)
+{
+}
+
+std::expected<void, std::string> JsonStringFieldSink::write(std::string_view bytes)
+{
+    while (!bytes.empty() && _state != State::Done) {
+        if (_state == State::InValue) {
+            if (auto result = writeValue(bytes); !result)
+                return result;
+            continue;
+        }
+
+        const char c = bytes.front();
+        bytes.remove_prefix(1);
+
+        switch (_state) {
+        case State::Scanning:
+            if (c == '"') {
+                _state = State::InString;
+                _token.clear();
+                _tokenMatches = true;
+            }
+            break;
+        case State::InString:
+            if (_escaped) {
+                _escaped = false;
+                _tokenMatches = false;
+            } else if (c == '\\') {
+                _escaped = true;
+            } else if (c == '"') {
+                _state = _tokenMatches && _token == _key ? State::AfterString : State::Scanning;
+            } else if (_tokenMatches) {
+                _token.push_back(c);
+                _tokenMatches = _token.size() <= _key.size();
+            }
+            break;
+        case State::AfterString:
+            // A key is followed by a colon, a string value that happens to match isn't
+            if (!isJsonWhitespace(c))
+                _state = c == ':' ? State::AfterKey : State::Scanning;
+            break;
+        case State::AfterKey:
+            if (c == '"') {
+                _state = State::InValue;
+            } else if (!isJsonWhitespace(c)) {
+                return std::unexpected("'" + _key + "' isn't a string");
+            }
+            break;
+        case State::InValue:
+        case State::Done:
+            break;
+        }
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> JsonStringFieldSink::writeValue(std::string_view &bytes)
+{
+    if (_escaped) {
+        _escaped = false;
+        char unescaped = bytes.front();
+        bytes.remove_prefix(1);
+        switch (unescaped) {
+        case '"':
+        case '\\':
+        case '/':
+            break;
+        case 'b':
+            unescaped = '\b';
+            break;
+        case 'f':
+            unescaped = '\f';
+            break;
+        case 'n':
+            unescaped = '\n';
+            break;
+        case 'r':
+            unescaped = '\r';
+            break;
+        case 't':
+            unescaped = '\t';
+            break;
+        default:
+            return std::unexpected("Unsupported escape in '" + _key + "'");
+        }
+        return _next.write({ &unescaped, 1 });
+    }
+
+    // Plain runs go through in one write
+    const size_t special = bytes.find_first_of("\"\\");
+    if (const std::string_view run = bytes.substr(0, special); !run.empty()) {
+        if (auto result = _next.write(run); !result)
+            return result;
+    }
+
+    if (special == std::string_view::npos) {
+        bytes = {};
+        return {};
+    }
+
+    _state = bytes[special] == '"' ? State::Done : State::InValue;
+    _escaped = bytes[special] == '\\';
+    bytes.remove_prefix(special + 1);
+    return {};
+}
+
+std::expected<void, std::string> JsonStringFieldSink::finish()
+{
+    if (_state != State::Done)
+        return std::unexpected("No complete '" + _key + "' string found");
+
+    return _next.finish();
+}
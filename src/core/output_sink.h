@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "md5.h"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace pointless::core {
+
+/// Destination for serialized bytes, fed in chunks so a whole document never has to sit in memory
+class OutputSink
+{
+public:
+    OutputSink() = default;
+    virtual ~OutputSink();
+
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+    OutputSink(OutputSink &&) = delete;
+    OutputSink &operator=(OutputSink &&) = delete;
+
+    [[nodiscard]] virtual std::expected<void, std::string> write(std::string_view bytes) = 0;
+
+    /// Flushes anything held back. No writes are allowed afterwards
+    [[nodiscard]] virtual std::expected<void, std::string> finish();
+};
+
+/// Produces a document into a sink, for callers that decide where the bytes go
+using DocumentWriter = std::function<std::expected<void, std::string>(OutputSink &)>;
+
+/// Appends to a string
+class StringSink : public OutputSink
+{
+public:
+    explicit StringSink(std::string &out);
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+
+private:
+    std::string &_out;
+};
+
+/// Gzip-compresses into another sink through a fixed-size buffer
+class GzipSink : public OutputSink
+{
+public:
+    explicit GzipSink(OutputSink &next);
+    ~GzipSink() override;
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+private:
+    [[nodiscard]] std::expected<void, std::string> deflateInput(int flush);
+
+    struct Stream;
+    OutputSink &_next;
+    std::unique_ptr<Stream> _stream;
+    std::array<char, 32768> _buffer {};
+};
+
+/// Base64-encodes (standard alphabet, padded) into another sink
+class Base64Sink : public OutputSink
+{
+public:
+    explicit Base64Sink(OutputSink &next);
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+private:
+    OutputSink &_next;
+    std::array<uint8_t, 3> _pending {};
+    size_t _pendingSize = 0;
+    std::string _encoded;
+};
+
+/// Inflates gzip data into another sink through a fixed-size buffer
+class GunzipSink : public OutputSink
+{
+public:
+    explicit GunzipSink(OutputSink &next);
+    ~GunzipSink() override;
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+
+    /// Fails if the gzip stream was truncated
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+private:
+    struct Stream;
+    OutputSink &_next;
+    std::unique_ptr<Stream> _stream;
+    bool _ended = false;
+    std::array<char, 32768> _buffer {};
+};
+
+/// Decodes base64 (standard alphabet, padding optional) into another sink with a lookup table.
+/// Any byte outside the alphabet is an error, including whitespace
+class Base64DecodeSink : public OutputSink
+{
+public:
+    explicit Base64DecodeSink(OutputSink &next);
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+private:
+    [[nodiscard]] std::expected<void, std::string> decodeCharacter(char c);
+
+    OutputSink &_next;
+    uint32_t _quad = 0;
+    size_t _quadSize = 0;
+    size_t _padding = 0;
+    size_t _offset = 0;
+    bool _padded = false;
+    std::string _decoded;
+};
+
+/// Forwards to another sink unchanged and hashes what went through, see Md5
+class Md5Sink : public OutputSink
+{
+public:
+    explicit Md5Sink(OutputSink &next);
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+    [[nodiscard]] std::string hexDigest() const;
+
+private:
+    OutputSink &_next;
+    Md5 _md5;
+};
+
+/// Forwards the unescaped contents of the first string member called @p key in a streamed JSON
+/// text, such as PostgREST's [{"data":"..."}], and ignores the rest. Keys with escapes never match
+class JsonStringFieldSink : public OutputSink
+{
+public:
+    JsonStringFieldSink(std::string key, OutputSink &next);
+
+    [[nodiscard]] std::expected<void, std::string> write(std::string_view bytes) override;
+
+    /// Fails if the member wasn't found or its string didn't end
+    [[nodiscard]] std::expected<void, std::string> finish() override;
+
+private:
+    enum class State : uint8_t {
+        Scanning,
+        InString,
+        AfterString,
+        AfterKey,
+        InValue,
+        Done
+    };
+
+    [[nodiscard]] std::expected<void, std::string> writeValue(std::string_view &bytes);
+
+    std::string _key;
+    OutputSink &_next;
+    State _state = State::Scanning;
+    std::string _token;
+    bool _tokenMatches = true;
+    bool _escaped = false;
+};
+
+}
@@ -1,13 +1,15 @@
 // SPDX-FileCopyrightText: 2025 Sergio Martins
 // SPDX-License-Identifier: MIT
 
-#include "data.h"
+#include "context.h"
+#include "local_data.h"
 #include "logger.h"
+#include "mapped_file.h"
+#include "sqlite_store.h"
 
 #include <exception>
-#include <fstream>
+#include <filesystem>
 #include <iostream>
-#include <sstream>
 #include <string>
 
 using namespace pointless;
@@ -26,43 +28,35 @@ int main(int argc, char *argv[])
         std::string oldName = argv[2];
         std::string newName = argv[3];
 
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
+        // Kept in whichever storage the app last used, so its operation log and snapshot format
+        // stay consistent with what it loads
+        auto options = static_cast<unsigned int>(core::Context::StartupOption::None);
+        if (std::filesystem::exists(core::SqliteStore::pathFor(filePath))) {
+            options |= static_cast<unsigned int>(core::Context::StartupOption::SqliteStorage);
+        } else if (!std::filesystem::exists(filePath)) {
             P_LOG_ERROR("Failed to open file: {}", filePath);
             return 1;
+        } else if (auto file = core::MappedFile::open(filePath); file && core::Data::isBinary(file->contents())) {
+            options |= static_cast<unsigned int>(core::Context::StartupOption::BinarySnapshot);
         }
+        core::Context::setContext(core::Context(IDataProvider::Type::None, filePath, options));
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string jsonData = buffer.str();
-        file.close();
-
-        auto dataResult = core::Data::fromJson(jsonData);
-        if (!dataResult) {
-            P_LOG_ERROR("Failed to parse JSON: {}", dataResult.error());
+        core::LocalData localData;
+        if (auto loaded = localData.loadDataFromFile(); !loaded) {
+            P_LOG_ERROR("Failed to load {}: {}", filePath, loaded.error().toString());
             return 1;
         }
 
-        auto &data = dataResult.value();
-
-        if (!data.renameTag(oldName, newName)) {
+        if (!localData.renameTag(oldName, newName)) {
             P_LOG_ERROR("Failed to rename tag '{}' to '{}'", oldName, newName);
             return 1;
         }
 
-        auto jsonResult = data.toJson();
-        if (!jsonResult) {
-            P_LOG_ERROR("Failed to serialize JSON: {}", jsonResult.error());
-            return 1;
-        }
-
-        std::ofstream outFile(filePath);
-        if (!outFile.is_open()) {
-            P_LOG_ERROR("Failed to open file for writing: {}", filePath);
+        if (auto saved = localData.save(); !saved) {
+            P_LOG_ERROR("Failed to save {}: {}", filePath, saved.error());
             return 1;
         }
 
-        outFile << jsonResult.value();
         P_LOG_INFO("Renamed tag '{}' to '{}' in {}", oldName, newName, filePath);
 
         return 0;
@@ -0,0 +1,529 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "sqlite_store.h"
+#include "logger.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <ranges>
+#include <utility>
+
+using namespace pointless::core;
+
+namespace {
+
+// Same as Data::toJson(), so exported documents don't change
+constexpr auto WriteOpts = glz::opts {
+    .skip_null_members = false,
+};
+
+constexpr const char *Schema = R"sql(
+    CREATE TABLE IF NOT EXISTS meta(key TEXT PRIMARY KEY, value INTEGER NOT NULL);
+    CREATE TABLE IF NOT EXISTS tasks(
+        uuid TEXT PRIMARY KEY,
+        position INTEGER NOT NULL,
+        is_done INTEGER NOT NULL,
+        due_date INTEGER,
+        json TEXT NOT NULL);
+    CREATE INDEX IF NOT EXISTS tasks_position ON tasks(position);
+    CREATE INDEX IF NOT EXISTS tasks_due_date ON tasks(due_date);
+    CREATE INDEX IF NOT EXISTS tasks_is_done ON tasks(is_done);
+    CREATE TABLE IF NOT EXISTS task_tags(
+        uuid TEXT NOT NULL REFERENCES tasks(uuid) ON DELETE CASCADE,
+        tag TEXT NOT NULL,
+        PRIMARY KEY(uuid, tag)) WITHOUT ROWID;
+    CREATE INDEX IF NOT EXISTS task_tags_tag ON task_tags(tag);
+    CREATE TABLE IF NOT EXISTS tags(name TEXT PRIMARY KEY, position INTEGER NOT NULL, json TEXT NOT NULL);
+    CREATE TABLE IF NOT EXISTS deleted_tasks(position INTEGER PRIMARY KEY, uuid TEXT NOT NULL);
+    CREATE TABLE IF NOT EXISTS deleted_tags(position INTEGER PRIMARY KEY, name TEXT NOT NULL);
+)sql";
+
+int64_t toMillis(std::chrono::system_clock::time_point tp)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+template<typename T>
+std::expected<std::string, std::string> toJson(const T &value)
+{
+    std::string json;
+    if (glz::write<WriteOpts>(value, json)) {
+        return std::unexpected(std::string("Failed to serialize to JSON"));
+    }
+    return json;
+}
+
+}
+
+/// A cached prepared statement, reset for reuse when this goes away
+class SqliteStore::Statement
+{
+public:
+    explicit Statement(sqlite3_stmt *stmt)
+        : _stmt(stmt)
+    {
+    }
+
+    Statement(Statement &&other) noexcept
+        : _stmt(std::exchange(other._stmt, nullptr))
+    {
+    }
+
+    Statement(const Statement &) = delete;
+    Statement &operator=(const Statement &) = delete;
+    Statement &operator=(Statement &&) = delete;
+
+    ~Statement()
+    {
+        if (_stmt) {
+            sqlite3_reset(_stmt);
+            sqlite3_clear_bindings(_stmt);
+        }
+    }
+
+    void bind(int index, std::string_view text)
+    {
+        sqlite3_bind_text(_stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    void bind(int index, int64_t value)
+    {
+        sqlite3_bind_int64(_stmt, index, value);
+    }
+
+    void bindNull(int index)
+    {
+        sqlite3_bind_null(_stmt, index);
+    }
+
+    /// Returns true while there are rows
+    [[nodiscard]] std::expected<bool, std::string> step()
+    {
+        const int rc = sqlite3_step(_stmt);
+        if (rc == SQLITE_ROW)
+            return true;
+        if (rc == SQLITE_DONE)
+            return false;
+        return std::unexpected(std::string(sqlite3_errmsg(sqlite3_db_handle(_stmt))));
+    }
+
+    [[nodiscard]] std::expected<void, std::string> run()
+    {
+        auto result = step();
+        if (!result)
+            return std::unexpected(result.error());
+        return {};
+    }
+
+    [[nodiscard]] std::string_view text(int column) const
+    {
+        const auto *data = reinterpret_cast<const char *>(sqlite3_column_text(_stmt, column)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        return data ? std::string_view(data, static_cast<size_t>(sqlite3_column_bytes(_stmt, column))) : std::string_view();
+    }
+
+    [[nodiscard]] int64_t integer(int column) const
+    {
+        return sqlite3_column_int64(_stmt, column);
+    }
+
+private:
+    sqlite3_stmt *_stmt = nullptr;
+};
+
+std::expected<SqliteStore, std::string> SqliteStore::open(const std::string &path)
+{
+    sqlite3 *db = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::string error = "Failed to open " + path + ": " + (db ? sqlite3_errmsg(db) : "out of memory");
+        sqlite3_close(db);
+        return std::unexpected(error);
+    }
+
+    SqliteStore store(db);
+
+    // FULL keeps the durability of the fsynced file saves, WAL keeps it cheap
+    for (const char *sql : { "PRAGMA journal_mode=WAL", "PRAGMA synchronous=FULL", "PRAGMA foreign_keys=ON", Schema }) {
+        if (auto result = store.exec(sql); !result)
+            return std::unexpected(result.error());
+    }
+
+    return store;
+}
+
+std::string SqliteStore::pathFor(const std::string &dataFilename)
+{
+    return std::filesystem::path(dataFilename).replace_extension(".sqlite").string();
+}
+
+SqliteStore::SqliteStore(sqlite3 *db)
+    : _db(db)
+{
+}
+
+SqliteStore::SqliteStore(SqliteStore &&other) noexcept
+    : _db(std::exchange(other._db, nullptr))
+    , _statements(std::move(other._statements))
+{
+    other._statements.clear();
+}
+
+SqliteStore &SqliteStore::operator=(SqliteStore &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        _db = std::exchange(other._db, nullptr);
+        _statements = std::move(other._statements);
+        other._statements.clear();
+    }
+    return *this;
+}
+
+SqliteStore::~SqliteStore()
+{
+    close();
+}
+
+void SqliteStore::close()
+{
+    for (sqlite3_stmt *stmt : _statements | std::views::values) {
+        sqlite3_finalize(stmt);
+    }
+    _statements.clear();
+
+    if (_db) {
+        sqlite3_close(_db);
+        _db = nullptr;
+    }
+}
+
+std::expected<SqliteStore::Statement, std::string> SqliteStore::prepare(std::string_view sql)
+{
+    auto it = _statements.find(sql);
+    if (it == _statements.end()) {
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v3(_db, sql.data(), static_cast<int>(sql.size()), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+            return std::unexpected(std::string(sqlite3_errmsg(_db)));
+        }
+        it = _statements.emplace(sql, stmt).first;
+    }
+    return Statement(it->second);
+}
+
+std::expected<void, std::string> SqliteStore::exec(const char *sql)
+{
+    char *error = nullptr;
+    if (sqlite3_exec(_db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+        std::string message = error ? error : "unknown error";
+        sqlite3_free(error);
+        return std::unexpected(message);
+    }
+    return {};
+}
+
+std::expected<void, std::string> SqliteStore::inTransaction(const std::function<std::expected<void, std::string>()> &work)
+{
+    if (auto result = exec("BEGIN IMMEDIATE"); !result)
+        return result;
+
+    auto result = work();
+    if (!result) {
+        if (auto rollback = exec("ROLLBACK"); !rollback) {
+            P_LOG_ERROR("Failed to roll back: {}", rollback.error());
+        }
+        return result;
+    }
+
+    return exec("COMMIT");
+}
+
+std::expected<void, std::string> SqliteStore::upsertTask(const Task &task)
+{
+    auto json = toJson(task);
+    if (!json)
+        return std::unexpected(json.error());
+
+    Uuid::TextBuffer uuidBuffer;
+    const std::string_view uuid = task.uuid.toStringView(uuidBuffer);
+
+    // A task that's already there keeps its place, like Data::setTask()
+    auto upsert = prepare(R"sql(
+        INSERT INTO tasks(uuid, position, is_done, due_date, json)
+        VALUES(?1, (SELECT COALESCE(MAX(position), -1) + 1 FROM tasks), ?2, ?3, ?4)
+        ON CONFLICT(uuid) DO UPDATE SET is_done = excluded.is_done, due_date = excluded.due_date, json = excluded.json)sql");
+    if (!upsert)
+        return std::unexpected(upsert.error());
+
+    upsert->bind(1, uuid);
+    upsert->bind(2, int64_t(task.isDone ? 1 : 0));
+    if (task.dueDate) {
+        upsert->bind(3, toMillis(*task.dueDate));
+    } else {
+        upsert->bindNull(3);
+    }
+    upsert->bind(4, *json);
+    if (auto result = upsert->run(); !result)
+        return result;
+
+    auto clearTags = prepare("DELETE FROM task_tags WHERE uuid = ?1");
+    if (!clearTags)
+        return std::unexpected(clearTags.error());
+    clearTags->bind(1, uuid);
+    if (auto result = clearTags->run(); !result)
+        return result;
+
+    for (const std::string &tag : task.tags) {
+        auto addTag = prepare("INSERT OR IGNORE INTO task_tags(uuid, tag) VALUES(?1, ?2)");
+        if (!addTag)
+            return std::unexpected(addTag.error());
+        addTag->bind(1, uuid);
+        addTag->bind(2, tag);
+        if (auto result = addTag->run(); !result)
+            return result;
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> SqliteStore::upsertTag(const Tag &tag)
+{
+    auto json = toJson(tag);
+    if (!json)
+        return std::unexpected(json.error());
+
+    // Like the replay of a tag addition, an existing tag is left alone
+    auto insert = prepare(R"sql(
+        INSERT OR IGNORE INTO tags(name, position, json)
+        VALUES(?1, (SELECT COALESCE(MAX(position), -1) + 1 FROM tags), ?2))sql");
+    if (!insert)
+        return std::unexpected(insert.error());
+
+    insert->bind(1, tag.name);
+    insert->bind(2, *json);
+    return insert->run();
+}
+
+std::expected<void, std::string> SqliteStore::removeTask(const Uuid &uuid)
+{
+    Uuid::TextBuffer uuidBuffer;
+    const std::string_view text = uuid.toStringView(uuidBuffer);
+
+    auto remove = prepare("DELETE FROM tasks WHERE uuid = ?1");
+    if (!remove)
+        return std::unexpected(remove.error());
+    remove->bind(1, text);
+    if (auto result = remove->run(); !result)
+        return result;
+
+    if (sqlite3_changes(_db) == 0)
+        return {};
+
+    auto tombstone = prepare("INSERT INTO deleted_tasks(uuid) VALUES(?1)");
+    if (!tombstone)
+        return std::unexpected(tombstone.error());
+    tombstone->bind(1, text);
+    return tombstone->run();
+}
+
+std::expected<void, std::string> SqliteStore::removeTag(const std::string &name)
+{
+    auto remove = prepare("DELETE FROM tags WHERE name = ?1");
+    if (!remove)
+        return std::unexpected(remove.error());
+    remove->bind(1, name);
+    if (auto result = remove->run(); !result)
+        return result;
+
+    if (sqlite3_changes(_db) == 0)
+        return {};
+
+    auto tombstone = prepare("INSERT INTO deleted_tags(name) VALUES(?1)");
+    if (!tombstone)
+        return std::unexpected(tombstone.error());
+    tombstone->bind(1, name);
+    return tombstone->run();
+}
+
+std::expected<void, std::string> SqliteStore::setRevision(int revision)
+{
+    auto set = prepare("INSERT INTO meta(key, value) VALUES('revision', ?1) ON CONFLICT(key) DO UPDATE SET value = excluded.value");
+    if (!set)
+        return std::unexpected(set.error());
+    set->bind(1, int64_t(revision));
+    return set->run();
+}
+
+std::expected<void, std::string> SqliteStore::importData(const Data &data)
+{
+    return inTransaction([&]() -> std::expected<void, std::string> {
+        if (auto result = exec("DELETE FROM task_tags; DELETE FROM tasks; DELETE FROM tags; DELETE FROM deleted_tasks; DELETE FROM deleted_tags;"); !result)
+            return result;
+
+        if (auto result = setRevision(data.revision()); !result)
+            return result;
+
+        for (const Task &task : data.tasks()) {
+            if (auto result = upsertTask(task); !result)
+                return result;
+        }
+
+        for (const Tag &tag : data.allTags()) {
+            if (auto result = upsertTag(tag); !result)
+                return result;
+        }
+
+        for (const Uuid &uuid : data.deletedTaskUuids()) {
+            Uuid::TextBuffer buffer;
+            auto insert = prepare("INSERT INTO deleted_tasks(uuid) VALUES(?1)");
+            if (!insert)
+                return std::unexpected(insert.error());
+            insert->bind(1, uuid.toStringView(buffer));
+            if (auto result = insert->run(); !result)
+                return result;
+        }
+
+        for (const std::string &name : data.deletedTagNames()) {
+            auto insert = prepare("INSERT INTO deleted_tags(name) VALUES(?1)");
+            if (!insert)
+                return std::unexpected(insert.error());
+            insert->bind(1, name);
+            if (auto result = insert->run(); !result)
+                return result;
+        }
+
+        return {};
+    });
+}
+
+std::expected<std::string, std::string> SqliteStore::exportJson()
+{
+    // Keys in the order glz::meta<DataPayload> declares them, rows in document order
+    std::string json = R"({"tasks":[)";
+    auto appendRows = [&](std::string_view sql) -> std::expected<void, std::string> {
+        auto rows = prepare(sql);
+        if (!rows)
+            return std::unexpected(rows.error());
+
+        bool first = true;
+        while (true) {
+            auto hasRow = rows->step();
+            if (!hasRow)
+                return std::unexpected(hasRow.error());
+            if (!*hasRow)
+                return {};
+            if (!first)
+                json.push_back(',');
+            json.append(rows->text(0));
+            first = false;
+        }
+    };
+
+    if (auto result = appendRows("SELECT json FROM tasks ORDER BY position"); !result)
+        return std::unexpected(result.error());
+
+    json.append(R"(],"tags":[)");
+    if (auto result = appendRows("SELECT json FROM tags ORDER BY position"); !result)
+        return std::unexpected(result.error());
+    json.push_back(']');
+
+    int revision = -1;
+    {
+        auto select = prepare("SELECT value FROM meta WHERE key = 'revision'");
+        if (!select)
+            return std::unexpected(select.error());
+        auto hasRow = select->step();
+        if (!hasRow)
+            return std::unexpected(hasRow.error());
+        if (*hasRow)
+            revision = static_cast<int>(select->integer(0));
+    }
+
+    std::vector<std::string> deletedTasks;
+    std::vector<std::string> deletedTags;
+    for (auto [sql, out] : { std::pair { "SELECT uuid FROM deleted_tasks ORDER BY position", &deletedTasks },
+                             std::pair { "SELECT name FROM deleted_tags ORDER BY position", &deletedTags } }) {
+        auto rows = prepare(sql);
+        if (!rows)
+            return std::unexpected(rows.error());
+        while (true) {
+            auto hasRow = rows->step();
+            if (!hasRow)
+                return std::unexpected(hasRow.error());
+            if (!*hasRow)
+                break;
+            out->emplace_back(rows->text(0));
+        }
+    }
+
+    auto revisionJson = toJson(revision);
+    auto deletedTasksJson = toJson(deletedTasks);
+    auto deletedTagsJson = toJson(deletedTags);
+    if (!revisionJson || !deletedTasksJson || !deletedTagsJson)
+        return std::unexpected(std::string("Failed to serialize to JSON"));
+
+    json.append(R"(,"revision":)").append(*revisionJson);
+    json.append(R"(,"deletedTaskUuids":)").append(*deletedTasksJson);
+    json.append(R"(,"deletedTagNames":)").append(*deletedTagsJson);
+    json.push_back('}');
+    return json;
+}
+
+std::expected<Data, std::string> SqliteStore::exportData()
+{
+    auto json = exportJson();
+    if (!json)
+        return std::unexpected(json.error());
+    return Data::fromJson(*json);
+}
+
+bool SqliteStore::canApply(std::span<const OperationLog::Record> records)
+{
+    return std::ranges::none_of(records, [](const auto &record) { return record.type == OperationLog::RecordType::TagRename; });
+}
+
+std::expected<void, std::string> SqliteStore::apply(std::span<const OperationLog::Record> records)
+{
+    if (!canApply(records))
+        return std::unexpected(std::string("Tag renames can't be applied as row updates"));
+
+    using Type = OperationLog::RecordType;
+    return inTransaction([&]() -> std::expected<void, std::string> {
+        for (const auto &record : records) {
+            std::expected<void, std::string> result;
+            switch (record.type) {
+            case Type::TaskUpsert: {
+                Task task;
+                if (glz::read_json(task, record.body))
+                    return std::unexpected(std::string("Failed to parse task record"));
+                result = upsertTask(task);
+                break;
+            }
+            case Type::TaskDelete:
+                for (auto line : std::views::split(std::string_view(record.body), '\n')) {
+                    if (!line.empty() && result)
+                        result = removeTask(std::string_view(line.begin(), line.end()));
+                }
+                break;
+            case Type::TagAdd: {
+                Tag tag;
+                if (glz::read_json(tag, record.body))
+                    return std::unexpected(std::string("Failed to parse tag record"));
+                result = upsertTag(tag);
+                break;
+            }
+            case Type::TagRemove:
+                result = removeTag(record.body);
+                break;
+            case Type::TagRename:
+                break;
+            }
+
+            if (!result)
+                return result;
+        }
+        return {};
+    });
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "data.h"
+#include "operation_log.h"
+
+#include <expected>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace pointless::core {
+
+/// Local data in an embedded SQLite database, in WAL mode, instead of a JSON file and its operation log.
+/// Each task and tag is a row holding its JSON, next to indexed uuid, due date, done and tag columns.
+/// Edits apply as row updates. Importing a Data and exporting it again yields the same JSON document.
+/// The app still queries the data it exported into memory, not the database.
+class SqliteStore
+{
+public:
+    /// Opens or creates the database and its schema
+    [[nodiscard]] static std::expected<SqliteStore, std::string> open(const std::string &path);
+
+    /// The database that replaces the local data file @p dataFilename
+    static std::string pathFor(const std::string &dataFilename);
+
+    SqliteStore(SqliteStore &&other) noexcept;
+    SqliteStore &operator=(SqliteStore &&other) noexcept;
+    SqliteStore(const SqliteStore &) = delete;
+    SqliteStore &operator=(const SqliteStore &) = delete;
+    ~SqliteStore();
+
+    /// Replaces the whole contents with @p data, in one transaction
+    [[nodiscard]] std::expected<void, std::string> importData(const Data &data);
+
+    /// The contents in the local file's JSON format, byte for byte what Data::toJson() would write
+    [[nodiscard]] std::expected<std::string, std::string> exportJson();
+    [[nodiscard]] std::expected<Data, std::string> exportData();
+
+    /// Applies operation log records as row updates, in one transaction. Tag renames touch every
+    /// task with the tag and aren't supported here, they're saved with importData()
+    [[nodiscard]] std::expected<void, std::string> apply(std::span<const OperationLog::Record> records);
+
+    static bool canApply(std::span<const OperationLog::Record> records);
+
+private:
+    explicit SqliteStore(sqlite3 *db);
+
+    class Statement;
+    [[nodiscard]] std::expected<Statement, std::string> prepare(std::string_view sql);
+    [[nodiscard]] std::expected<void, std::string> exec(const char *sql);
+    [[nodiscard]] std::expected<void, std::string> inTransaction(const std::function<std::expected<void, std::string>()> &work);
+    [[nodiscard]] std::expected<void, std::string> upsertTask(const Task &task);
+    [[nodiscard]] std::expected<void, std::string> upsertTag(const Tag &tag);
+    [[nodiscard]] std::expected<void, std::string> removeTask(const Uuid &uuid);
+    [[nodiscard]] std::expected<void, std::string> removeTag(const std::string &name);
+    [[nodiscard]] std::expected<void, std::string> setRevision(int revision);
+
+    void close();
+
+    sqlite3 *_db = nullptr;
+    std::unordered_map<std::string_view, sqlite3_stmt *> _statements; // keyed by the SQL literals, prepared once
+};
+
+}
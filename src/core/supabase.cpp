@@ -2,18 +2,19 @@
 // SPDX-License-Identifier: MIT
 
 #include "supabase.h"
+#include "http_connections.h"
 #include "logger.h"
+#include "md5.h"
 #include "utils.h"
 
 #include <cpr/cpr.h>
 #include <cpr/error.h>
-#include <zlib.h>
 
-#include <array>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <string>
-#include <stdexcept>
+#include <utility>
 
 namespace {
 
@@ -26,19 +27,88 @@ bool shouldVerifySsl()
 #endif
 }
 
-constexpr int kBufferSize = 32768;
+// Pooled sessions keep the options of their last request. Every request sets its url, headers and
+// body, the options only some requests set are reset here so they don't leak into the next one
+template<typename... Options>
+pointless::core::HttpConnections::Lease configure(pointless::core::HttpConnections &connections,
+                                                  pointless::core::HttpConnections::Kind kind, Options &&...options)
+{
+    auto session = connections.checkOut(kind);
+    session->SetParameters(cpr::Parameters {});
+    session->SetWriteCallback(cpr::WriteCallback {});
+    (session->SetOption(std::forward<Options>(options)), ...);
+    return session;
+}
+
+template<typename... Options>
+cpr::Response httpGet(pointless::core::HttpConnections &connections, Options &&...options)
+{
+    return configure(connections, pointless::core::HttpConnections::Kind::WithoutBody, std::forward<Options>(options)...)->Get();
+}
+
+template<typename... Options>
+cpr::Response httpPost(pointless::core::HttpConnections &connections, Options &&...options)
+{
+    return configure(connections, pointless::core::HttpConnections::Kind::WithBody, std::forward<Options>(options)...)->Post();
+}
+
+template<typename... Options>
+cpr::Response httpDelete(pointless::core::HttpConnections &connections, Options &&...options)
+{
+    return configure(connections, pointless::core::HttpConnections::Kind::WithoutBody, std::forward<Options>(options)...)->Delete();
+}
+
 constexpr int kHttpOk = 200;
 constexpr int kHttpCreated = 201;
 constexpr int kHttpNoContent = 204;
 constexpr int kHttpUnauthorized = 401;
+constexpr int kHttpConflict = 409;
+
+// A row of the Changes table, keyed by (user_id, revision) so a revision can only be pushed once
+struct ChangeRow
+{
+    int revision = -1;
+    pointless::core::ChangeSet data;
+};
+
+// The Documents row without its data, null when there's no data
+struct DocumentVersionRow
+{
+    std::optional<std::string> dataMd5;
+};
 }
 
+template<>
+struct glz::meta<ChangeRow>
+{
+    using T = ChangeRow;
+    static constexpr auto value = object("revision", &T::revision, "data", &T::data);
+};
+
+template<>
+struct glz::meta<DocumentVersionRow>
+{
+    using T = DocumentVersionRow;
+    static constexpr auto value = object("data_md5", &T::dataMd5);
+};
 
 SupabaseProvider::SupabaseProvider(std::string base_url, std::string anon_key)
     : _baseUrl(std::move(base_url))
     , _anonKey(std::move(anon_key))
+    , _connections(std::make_unique<pointless::core::HttpConnections>())
+{
+}
+
+SupabaseProvider::~SupabaseProvider() = default;
+
+std::string SupabaseProvider::url(std::string_view path) const
 {
+    // A full base URL points at a local stand-in, in tests
+    if (_baseUrl.find("://") != std::string::npos)
+        return _baseUrl + std::string(path);
+    return "https://" + _baseUrl + std::string(path);
 }
+
 std::unique_ptr<SupabaseProvider> SupabaseProvider::createDefault()
 {
 #ifndef POINTLESS_SUPABASE_URL
@@ -54,10 +124,11 @@ std::unique_ptr<SupabaseProvider> SupabaseProvider::createDefault()
 
 bool SupabaseProvider::login(const std::string &email, const std::string &password)
 {
-    const std::string auth_url = "https://" + _baseUrl + "/auth/v1/token?grant_type=password";
+    const std::string auth_url = url("/auth/v1/token?grant_type=password");
     const std::string body = R"({"email":")" + email + R"(","password":")" + password + R"("})";
 
-    auto response = cpr::Post(
+    auto response = httpPost(
+        *_connections,
         cpr::Url { auth_url },
         cpr::Header {
             { "apikey", _anonKey },
@@ -186,17 +257,35 @@ void SupabaseProvider::setRefreshToken(const std::string &token)
 
 std::expected<void, TraceableError> SupabaseProvider::pushData(const std::string &data)
 {
+    return pushDocument([&data](pointless::core::OutputSink &sink) { return sink.write(data); });
+}
+
+std::expected<void, TraceableError> SupabaseProvider::pushDocument(const pointless::core::DocumentWriter &writeDocument)
+{
+    _documentVersion.clear();
+
     if (!isAuthenticated()) {
         return TraceableError::create("Cannot update data: not authenticated");
     }
 
-    auto compressed_bytes = compress(data);
-    auto base64ed = base64Encode(compressed_bytes);
-
-    const std::string full_url = "https://" + _baseUrl + "/rest/v1/Documents";
-    const std::string body = R"({"data":")" + base64ed + R"(","id":0})";
+    // Only the compressed, encoded document is ever in memory, not the JSON
+    std::string body = R"({"data":")";
+    const size_t dataBegin = body.size();
+    pointless::core::StringSink bodySink(body);
+    pointless::core::Base64Sink base64(bodySink);
+    pointless::core::GzipSink gzip(base64);
+    if (auto written = writeDocument(gzip); !written) {
+        return TraceableError::create("Failed to serialize data: " + written.error());
+    }
+    if (auto finished = gzip.finish(); !finished) {
+        return TraceableError::create(finished.error());
+    }
+    const std::string version = pointless::core::Md5::hexDigest(std::string_view(body).substr(dataBegin));
+    body.append(R"(","id":0})");
 
-    auto response = cpr::Post(
+    const std::string full_url = url("/rest/v1/Documents");
+    auto response = httpPost(
+        *_connections,
         cpr::Url { full_url },
         cpr::Header {
             { "apikey", _anonKey },
@@ -217,204 +306,209 @@ std::expected<void, TraceableError> SupabaseProvider::pushData(const std::string
         return TraceableError::create("Failed to update data: HTTP " + std::to_string(response.status_code));
     }
 
+    _documentVersion = version;
     return {};
 }
 
 std::expected<std::string, TraceableError> SupabaseProvider::pullData()
-{
-    auto raw_data_result = retrieveRawData();
-    if (!raw_data_result) {
-        return std::unexpected(raw_data_result.error());
-    }
-
-    auto compressed_bytes = base64Decode(*raw_data_result);
-    return decompress(compressed_bytes);
-}
-
-std::expected<std::string, TraceableError> SupabaseProvider::retrieveRawData()
 {
     if (!isAuthenticated()) {
         return TraceableError::create("Cannot retrieve data: not authenticated");
     }
 
-    const std::string full_url = "https://" + _baseUrl + "/rest/v1/Documents";
+    _documentVersion.clear();
 
-    auto response = cpr::Get(
-        cpr::Url { full_url },
+    // Decoded as it arrives, only the inflated JSON is ever whole in memory. The base64 text is
+    // hashed on the way, like the server does for data_md5
+    std::string document;
+    pointless::core::StringSink documentSink(document);
+    pointless::core::GunzipSink gunzip(documentSink);
+    pointless::core::Base64DecodeSink base64(gunzip);
+    pointless::core::Md5Sink md5(base64);
+    pointless::core::JsonStringFieldSink field("data", md5);
+
+    std::string decodeError;
+    auto response = httpGet(
+        *_connections,
+        cpr::Url { url("/rest/v1/Documents") },
         cpr::Parameters { { "select", "data" } },
         cpr::Header {
             { "apikey", _anonKey },
             { "Authorization", "Bearer " + _accessToken } },
-        cpr::VerifySsl { shouldVerifySsl() });
+        cpr::VerifySsl { shouldVerifySsl() },
+        cpr::WriteCallback { [&field, &decodeError](std::string_view chunk, intptr_t /*userdata*/) {
+            if (auto result = field.write(chunk); !result) {
+                decodeError = result.error();
+                return false; // aborts the transfer
+            }
+            return true;
+        } });
 
     if (response.status_code != kHttpOk) {
         return TraceableError::create("HTTP request failed with status: " + std::to_string(response.status_code));
     }
 
-    auto json_result = glz::read_json<glz::generic>(response.text);
-    if (!json_result.has_value()) {
-        return TraceableError::create("Failed to parse JSON response");
-    }
-
-    auto &json_obj = json_result.value();
-    if (!json_obj.is_array() || json_obj.get_array().empty()) {
-        return TraceableError::create("Response is empty or not an array");
-    }
-
-    auto &first_item = json_obj.get_array()[0];
-    if (!first_item.is_object()) {
-        return TraceableError::create("First item in response is not an object");
+    if (decodeError.empty()) {
+        if (auto result = field.finish(); !result) {
+            decodeError = result.error();
+        }
     }
 
-    auto data_it = first_item.get_object().find("data");
-    if (data_it == first_item.get_object().end() || !data_it->second.is_string()) {
-        return TraceableError::create("No 'data' field found in response");
+    if (!decodeError.empty()) {
+        return TraceableError::create("Failed to decode data: " + decodeError);
     }
 
-    std::string data = data_it->second.get_string();
-    return data;
+    _documentVersion = md5.hexDigest();
+    return document;
 }
 
-std::vector<uint8_t> SupabaseProvider::compress(const std::string &data)
+std::expected<std::string, TraceableError> SupabaseProvider::pullDocumentVersion()
 {
-    z_stream zs {};
-    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-        throw std::runtime_error("Failed to initialize zlib deflation");
+    if (_accessToken.empty()) {
+        return TraceableError::create("Cannot probe the document: not authenticated");
     }
 
-    std::vector<Bytef> inputBuffer(data.begin(), data.end());
-    zs.next_in = inputBuffer.data();
-    zs.avail_in = static_cast<uInt>(data.length());
-
-    int ret = 0;
-    std::array<Bytef, kBufferSize> outbuffer {};
-    std::vector<uint8_t> result;
+    // No separate isAuthenticated() round-trip, an unchanged document costs a single small request
+    auto probe = [this] {
+        return httpGet(
+            *_connections,
+            cpr::Url { url("/rest/v1/Documents") },
+            cpr::Parameters { { "select", "data_md5" } },
+            cpr::Header {
+                { "apikey", _anonKey },
+                { "Authorization", "Bearer " + _accessToken } },
+            cpr::VerifySsl { shouldVerifySsl() });
+    };
 
-    zs.next_out = outbuffer.data();
-    zs.avail_out = static_cast<uInt>(outbuffer.size());
-    ret = deflate(&zs, Z_FINISH);
-    while (ret == Z_OK) {
-        if (result.size() < zs.total_out) {
-            result.insert(result.end(),
-                          outbuffer.begin(),
-                          outbuffer.begin() + static_cast<ptrdiff_t>(zs.total_out - result.size()));
-        }
-        zs.next_out = outbuffer.data();
-        zs.avail_out = static_cast<uInt>(outbuffer.size());
-        ret = deflate(&zs, Z_FINISH);
+    auto response = probe();
+    if (response.status_code == kHttpUnauthorized && !_refreshToken.empty() && refreshAccessToken()) {
+        response = probe();
     }
 
-    if (result.size() < zs.total_out) {
-        result.insert(result.end(),
-                      outbuffer.begin(),
-                      outbuffer.begin() + static_cast<ptrdiff_t>(zs.total_out - result.size()));
+    // Including a 400 for a server without the column yet
+    if (response.status_code != kHttpOk) {
+        return TraceableError::create("Failed to probe the document: HTTP " + std::to_string(response.status_code));
     }
 
-    deflateEnd(&zs);
+    std::vector<DocumentVersionRow> rows;
+    if (auto error = glz::read<glz::opts { .error_on_unknown_keys = false }>(rows, response.text)) {
+        return TraceableError::create("Failed to parse the document version: " + glz::format_error(error, response.text));
+    }
 
-    if (ret != Z_STREAM_END) {
-        throw std::runtime_error("Failed to compress gzip data");
+    if (rows.empty() || !rows.front().dataMd5) {
+        return std::string();
     }
+    return *rows.front().dataMd5;
+}
 
-    return result;
+std::string SupabaseProvider::documentVersion() const
+{
+    return _documentVersion;
 }
 
-std::string SupabaseProvider::decompress(const std::vector<uint8_t> &compressed_data)
+std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> SupabaseProvider::pullChanges(int sinceRevision)
 {
-    z_stream zs {};
-    if (inflateInit2(&zs, MAX_WBITS + 16) != Z_OK) {
-        throw std::runtime_error("Failed to initialize zlib inflation");
+    if (!isAuthenticated()) {
+        return TraceableError::create("Cannot pull changes: not authenticated");
     }
 
-    std::vector<Bytef> inputBuffer(compressed_data.begin(), compressed_data.end());
-    zs.next_in = inputBuffer.data();
-    zs.avail_in = static_cast<uInt>(compressed_data.size());
+    auto response = httpGet(
+        *_connections,
+        cpr::Url { url("/rest/v1/Changes") },
+        cpr::Parameters {
+            { "select", "revision,data" },
+            { "revision", "gt." + std::to_string(sinceRevision) },
+            { "order", "revision.asc" } },
+        cpr::Header {
+            { "apikey", _anonKey },
+            { "Authorization", "Bearer " + _accessToken } },
+        cpr::VerifySsl { shouldVerifySsl() });
 
-    int ret = 0;
-    std::array<char, kBufferSize> outbuffer {};
-    std::string result;
+    if (response.status_code != kHttpOk) {
+        return TraceableError::create("Failed to pull changes: HTTP " + std::to_string(response.status_code));
+    }
 
-    zs.next_out = reinterpret_cast<Bytef *>(outbuffer.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-    zs.avail_out = static_cast<uInt>(outbuffer.size());
-    ret = inflate(&zs, 0);
-    while (ret == Z_OK) {
-        if (result.size() < zs.total_out) {
-            result.append(outbuffer.data(), zs.total_out - result.size());
-        }
-        zs.next_out = reinterpret_cast<Bytef *>(outbuffer.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-        zs.avail_out = static_cast<uInt>(outbuffer.size());
-        ret = inflate(&zs, 0);
+    std::vector<ChangeRow> rows;
+    if (auto error = glz::read<glz::opts { .error_on_unknown_keys = false }>(rows, response.text)) {
+        return TraceableError::create("Failed to parse changes: " + glz::format_error(error, response.text));
     }
 
-    if (result.size() < zs.total_out) {
-        result.append(outbuffer.data(), zs.total_out - result.size());
+    std::vector<pointless::core::ChangeSet> changes;
+    changes.reserve(rows.size());
+    for (auto &row : rows) {
+        row.data.revision = row.revision;
+        changes.push_back(std::move(row.data));
     }
+    return changes;
+}
 
-    inflateEnd(&zs);
+std::expected<void, TraceableError> SupabaseProvider::pushChanges(const pointless::core::ChangeSet &changes)
+{
+    if (!isAuthenticated()) {
+        return TraceableError::create("Cannot push changes: not authenticated");
+    }
 
-    if (ret != Z_STREAM_END) {
-        throw std::runtime_error("Failed to decompress gzip data");
+    const ChangeRow row { .revision = changes.revision, .data = changes };
+    auto body = glz::write_json(row);
+    if (!body) {
+        return TraceableError::create("Failed to serialize changes");
     }
 
-    return result;
-}
+    auto response = httpPost(
+        *_connections,
+        cpr::Url { url("/rest/v1/Changes") },
+        cpr::Header {
+            { "apikey", _anonKey },
+            { "Authorization", "Bearer " + _accessToken },
+            { "Content-Type", "application/json" },
+            { "Prefer", "return=minimal" } },
+        cpr::Body { *body },
+        cpr::VerifySsl { shouldVerifySsl() });
 
-std::vector<uint8_t> SupabaseProvider::base64Decode(const std::string &input)
-{
-    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::vector<uint8_t> result;
-
-    uint32_t val = 0;
-    int32_t valb = -8;
-    for (unsigned char c : input) {
-        auto pos = chars.find(static_cast<char>(c));
-        if (pos == std::string::npos)
-            break;
-        val = (val << 6U) + static_cast<uint32_t>(pos);
-        valb += 6;
-        if (valb >= 0) {
-            result.push_back(static_cast<uint8_t>((val >> static_cast<uint32_t>(valb)) & 0xFFU));
-            valb -= 8;
-        }
+    if (response.status_code == kHttpConflict) {
+        return TraceableError::create("Revision " + std::to_string(changes.revision) + " was pushed by another client");
+    }
+
+    if (response.status_code != kHttpOk && response.status_code != kHttpCreated && response.status_code != kHttpNoContent) {
+        P_LOG_DEBUG("Response: {}", response.text);
+        return TraceableError::create("Failed to push changes: HTTP " + std::to_string(response.status_code));
     }
-    return result;
+
+    return {};
 }
 
-std::string SupabaseProvider::base64Encode(const std::vector<uint8_t> &data)
+std::expected<void, TraceableError> SupabaseProvider::pruneChanges(int beforeRevision)
 {
-    const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string result;
-    uint32_t val = 0;
-    int32_t valb = -6;
-
-    for (uint8_t c : data) {
-        val = (val << 8U) + c;
-        valb += 8;
-        while (valb >= 0) {
-            result.push_back(chars[(val >> static_cast<uint32_t>(valb)) & 0x3FU]);
-            valb -= 6;
-        }
+    if (!isAuthenticated()) {
+        return TraceableError::create("Cannot prune changes: not authenticated");
     }
 
-    if (valb > -6) {
-        result.push_back(chars[((val << 8U) >> static_cast<uint32_t>(valb + 8)) & 0x3FU]);
-    }
+    auto response = httpDelete(
+        *_connections,
+        cpr::Url { url("/rest/v1/Changes") },
+        cpr::Parameters { { "revision", "lt." + std::to_string(beforeRevision) } },
+        cpr::Header {
+            { "apikey", _anonKey },
+            { "Authorization", "Bearer " + _accessToken },
+            { "Prefer", "return=minimal" } },
+        cpr::VerifySsl { shouldVerifySsl() });
 
-    while ((result.size() % 4) != 0) {
-        result.push_back('=');
+    if (response.status_code != kHttpOk && response.status_code != kHttpNoContent) {
+        return TraceableError::create("Failed to prune changes: HTTP " + std::to_string(response.status_code));
     }
 
-    return result;
+    return {};
 }
 
 bool SupabaseProvider::refreshAccessToken()
 {
     P_LOG_INFO("Refreshing access token");
 
-    const std::string refresh_url = "https://" + _baseUrl + "/auth/v1/token?grant_type=refresh_token";
+    const std::string refresh_url = url("/auth/v1/token?grant_type=refresh_token");
     const std::string body = R"({"refresh_token":")" + _refreshToken + R"("})"; // NOLINT(performance-inefficient-string-concatenation)
 
-    auto response = cpr::Post(
+    auto response = httpPost(
+        *_connections,
         cpr::Url { refresh_url },
         cpr::Header {
             { "apikey", _anonKey },
@@ -469,9 +563,10 @@ bool SupabaseProvider::isAuthenticated()
         return false;
     }
 
-    const std::string auth_user_url = "https://" + _baseUrl + "/auth/v1/user";
+    const std::string auth_user_url = url("/auth/v1/user");
 
-    auto response = cpr::Get(
+    auto response = httpGet(
+        *_connections,
         cpr::Url { auth_user_url },
         cpr::Header {
             { "apikey", _anonKey },
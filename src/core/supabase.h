@@ -8,14 +8,20 @@
 #include <glaze/glaze.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace pointless::core {
+class HttpConnections;
+}
+
 class SupabaseProvider : public IDataProvider
 {
 public:
     explicit SupabaseProvider(std::string base_url, std::string anon_key);
-    ~SupabaseProvider() override = default;
+    ~SupabaseProvider() override;
 
     static std::unique_ptr<SupabaseProvider> createDefault();
 
@@ -34,8 +40,24 @@ public:
     bool refreshAccessToken() override;
 
     std::expected<void, TraceableError> pushData(const std::string &data) override;
+
+    /// Gzips and base64-encodes the document as it's produced, straight into the request body
+    std::expected<void, TraceableError> pushDocument(const pointless::core::DocumentWriter &writeDocument) override;
     std::expected<std::string, TraceableError> pullData() override;
 
+    /// From the data_md5 column of Documents, which the server generates from the data column:
+    ///   alter table "Documents" add column data_md5 text generated always as (md5(data)) stored;
+    /// Fails without that column, the document is pulled then
+    std::expected<std::string, TraceableError> pullDocumentVersion() override;
+
+    /// The MD5 of the base64 text last pulled or pushed, which is what the server hashes
+    [[nodiscard]] std::string documentVersion() const override;
+
+    /// Against the Changes table, see ChangeSet
+    std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> pullChanges(int sinceRevision) override;
+    std::expected<void, TraceableError> pushChanges(const pointless::core::ChangeSet &changes) override;
+    std::expected<void, TraceableError> pruneChanges(int beforeRevision) override;
+
     SupabaseProvider(const SupabaseProvider &) = delete;
     SupabaseProvider &operator=(const SupabaseProvider &) = delete;
     SupabaseProvider(SupabaseProvider &&) = delete;
@@ -49,11 +71,11 @@ private:
     std::string _userId;
     std::string _defaultUser;
     std::string _defaultPassword;
+    std::string _documentVersion;
 
-    std::expected<std::string, TraceableError> retrieveRawData();
+    /// Shared by the refresh thread and the token refresh timer's requests
+    std::unique_ptr<pointless::core::HttpConnections> _connections;
 
-    static std::vector<uint8_t> compress(const std::string &data);
-    static std::string decompress(const std::vector<uint8_t> &compressed_data);
-    static std::vector<uint8_t> base64Decode(const std::string &input);
-    static std::string base64Encode(const std::vector<uint8_t> &data);
+    /// @p path on the server. The base is a host name, or a full URL for a local stand-in
+    [[nodiscard]] std::string url(std::string_view path) const;
 };
@@ -3,12 +3,13 @@
 
 #include "context.h"
 #include "data_provider.h"
+#include "local_data.h"
 #include "logger.h"
+#include "sqlite_store.h"
 
 #include <exception>
-#include <fstream>
+#include <filesystem>
 #include <iostream>
-#include <sstream>
 #include <string>
 
 using namespace pointless;
@@ -32,23 +33,30 @@ int main(int argc, char *argv[])
 
         core::Logger::initLogLevel();
 
+        std::string filePath = argv[2];
+
+        // Read like the app does, binary snapshots and operation logs included
+        auto options = static_cast<unsigned int>(core::Context::StartupOption::RestoreAuth);
+        if (std::filesystem::exists(core::SqliteStore::pathFor(filePath))) {
+            options |= static_cast<unsigned int>(core::Context::StartupOption::SqliteStorage);
+        } else if (!std::filesystem::exists(filePath)) {
+            P_LOG_ERROR("Failed to open file: {}", filePath);
+            return 1;
+        }
+
         if (mode == "--test") {
-            core::Context::setContext(core::Context::defaultContextForSupabaseTesting());
+            core::Context::setContext(core::Context::defaultContextForSupabaseTesting(options));
         } else {
-            core::Context::setContext(core::Context::defaultContextForSupabaseRelease());
+            core::Context::setContext(core::Context::defaultContextForSupabaseRelease(options));
         }
 
-        std::string filePath = argv[2];
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
-            P_LOG_ERROR("Failed to open file: {}", filePath);
+        core::LocalData localData;
+        auto data = localData.loadDataFromFile(filePath);
+        if (!data) {
+            P_LOG_ERROR("Failed to load {}: {}", filePath, data.error());
             return 1;
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string jsonData = buffer.str();
-
         auto provider = IDataProvider::createProvider();
         if (!provider) {
             P_LOG_ERROR("Failed to create data provider");
@@ -60,7 +68,7 @@ int main(int argc, char *argv[])
             return 1;
         }
 
-        auto result = provider->pushData(jsonData);
+        auto result = provider->pushDocument([&data](core::OutputSink &sink) { return data->writeJson(sink); });
         if (result) {
             P_LOG_INFO("Data pushed successfully");
         } else {
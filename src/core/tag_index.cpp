@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "tag_index.h"
+
+#include <algorithm>
+
+using namespace pointless::core;
+
+namespace {
+
+/// Tasks can have a repeated tag if the vector was assigned directly, count it once
+bool isRepeatedTag(std::span<const TagId> ids, size_t tagIndex)
+{
+    const auto begin = ids.begin();
+    const auto it = begin + static_cast<std::ptrdiff_t>(tagIndex);
+    return std::find(begin, it, *it) != it;
+}
+
+}
+
+void TagIndex::rebuild(const std::vector<Task> &tasks)
+{
+    clear();
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        add(tasks[i], i);
+    }
+}
+
+void TagIndex::add(const Task &task, size_t position)
+{
+    const bool visible = isVisible(task);
+    const auto ids = task.tags.ids();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (isRepeatedTag(ids, i))
+            continue;
+
+        Entry &e = _entries[ids[i]];
+        e.positions.insert(std::ranges::lower_bound(e.positions, position), position);
+        if (visible)
+            ++e.visibleCount;
+    }
+}
+
+void TagIndex::remove(const Task &task, size_t position)
+{
+    const bool visible = isVisible(task);
+    const auto ids = task.tags.ids();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (isRepeatedTag(ids, i))
+            continue;
+
+        auto it = _entries.find(ids[i]);
+        if (it == _entries.end())
+            continue;
+
+        Entry &e = it->second;
+        auto posIt = std::ranges::lower_bound(e.positions, position);
+        if (posIt == e.positions.end() || *posIt != position)
+            continue;
+
+        e.positions.erase(posIt);
+        if (visible)
+            --e.visibleCount;
+
+        if (e.positions.empty())
+            _entries.erase(it);
+    }
+}
+
+void TagIndex::clear()
+{
+    _entries.clear();
+}
+
+std::span<const size_t> TagIndex::positions(std::string_view tagName) const
+{
+    if (const Entry *e = entry(tagName))
+        return e->positions;
+    return {};
+}
+
+std::span<const size_t> TagIndex::positions(TagId tagId) const
+{
+    if (const Entry *e = entry(tagId))
+        return e->positions;
+    return {};
+}
+
+int TagIndex::taskCount(std::string_view tagName) const
+{
+    const Entry *e = entry(tagName);
+    return e ? static_cast<int>(e->positions.size()) : 0;
+}
+
+int TagIndex::visibleTaskCount(std::string_view tagName) const
+{
+    const Entry *e = entry(tagName);
+    return e ? e->visibleCount : 0;
+}
+
+bool TagIndex::isVisible(const Task &task)
+{
+    // Like the count DataController used to compute: a goal flag that was ever set hides the task, even when false
+    return !(task.isDone && !task.needsSyncToServer) && !task.isGoal;
+}
+
+const TagIndex::Entry *TagIndex::entry(TagId tagId) const
+{
+    auto it = _entries.find(tagId);
+    return it == _entries.end() ? nullptr : &it->second;
+}
+
+const TagIndex::Entry *TagIndex::entry(std::string_view tagName) const
+{
+    const auto tagId = TagDictionary::find(tagName);
+    return tagId ? entry(*tagId) : nullptr;
+}
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pointless::core {
+
+/// Inverted index from tag name to the positions of the tasks using it.
+/// Also keeps how many of those tasks are visible, so tag counts don't need a scan.
+class TagIndex
+{
+public:
+    void rebuild(const std::vector<Task> &tasks);
+    void add(const Task &task, size_t position);
+    void remove(const Task &task, size_t position);
+    void clear();
+
+    [[nodiscard]] std::span<const size_t> positions(std::string_view tagName) const;
+    [[nodiscard]] std::span<const size_t> positions(TagId tagId) const;
+    [[nodiscard]] int taskCount(std::string_view tagName) const;
+    [[nodiscard]] int visibleTaskCount(std::string_view tagName) const;
+
+    [[nodiscard]] static bool isVisible(const Task &task);
+
+private:
+    struct Entry
+    {
+        std::vector<size_t> positions;
+        int visibleCount = 0;
+    };
+
+    [[nodiscard]] const Entry *entry(TagId tagId) const;
+    [[nodiscard]] const Entry *entry(std::string_view tagName) const;
+
+    std::unordered_map<TagId, Entry> _entries;
+};
+
+}
@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "tag_list.h"
+#include "tag.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace pointless::core;
+
+namespace {
+
+// Reads take no lock: names live in chunks that never move and are published by storing the
+// size, and ids are found through a hash table whose slots are published the same way. Only
+// inserts lock, to serialize writers. A full table is replaced by a bigger one, the old one is
+// kept alive since a reader may still be probing it.
+class Dictionary
+{
+public:
+    Dictionary()
+    {
+        for (const char *name : { BUILTIN_TAG_SOON, BUILTIN_TAG_CURRENT, BUILTIN_TAG_EVENING }) {
+            intern(name);
+        }
+    }
+
+    TagId intern(std::string_view tagName)
+    {
+        const size_t hash = std::hash<std::string_view> {}(tagName);
+        if (auto id = find(tagName, hash))
+            return *id;
+
+        std::lock_guard lock(_insertMutex);
+        if (auto id = find(tagName, hash))
+            return *id;
+
+        const auto id = _size.load(std::memory_order_relaxed);
+        const auto [chunk, offset] = locate(id);
+        if (_chunks[chunk].load(std::memory_order_relaxed) == nullptr) {
+            _ownedChunks[chunk] = std::make_unique<std::string[]>(chunkSize(chunk));
+            _chunks[chunk].store(_ownedChunks[chunk].get(), std::memory_order_release);
+        }
+        _chunks[chunk].load(std::memory_order_relaxed)[offset] = tagName;
+        _size.store(id + 1, std::memory_order_release);
+
+        Table *table = _table.load(std::memory_order_relaxed);
+        if (table == nullptr || (id + 1) * 2 > table->capacity) {
+            table = grow(table);
+        }
+        insertSlot(*table, hash, id);
+        return id;
+    }
+
+    std::optional<TagId> find(std::string_view tagName, size_t hash) const
+    {
+        const Table *table = _table.load(std::memory_order_acquire);
+        if (table == nullptr)
+            return std::nullopt;
+
+        const uint32_t hashBits = static_cast<uint32_t>(hash);
+        for (size_t i = hash & (table->capacity - 1);; i = (i + 1) & (table->capacity - 1)) {
+            const uint64_t slot = table->slots[i].load(std::memory_order_acquire);
+            if (slot == 0)
+                return std::nullopt;
+            const auto id = static_cast<TagId>((slot & 0xFFFFFFFFU) - 1);
+            if ((slot >> 32U) == hashBits && name(id) == tagName)
+                return id;
+        }
+    }
+
+    const std::string &name(TagId id) const
+    {
+        const auto [chunk, offset] = locate(id);
+        return _chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+private:
+    struct Table
+    {
+        explicit Table(size_t capacity)
+            : capacity(capacity)
+            , slots(std::make_unique<std::atomic<uint64_t>[]>(capacity))
+        {
+        }
+
+        size_t capacity;
+        // The low 32 bits hold the id plus one, 0 is an empty slot, the high ones part of the hash
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    static constexpr size_t FirstChunkSize = 64;
+    static constexpr size_t ChunkCount = 26; // Room for over 4 billion names
+
+    static size_t chunkSize(size_t chunk)
+    {
+        return FirstChunkSize << chunk;
+    }
+
+    /// Chunk k holds the ids from FirstChunkSize * (2^k - 1), twice as many as the one before
+    static std::pair<size_t, size_t> locate(TagId id)
+    {
+        const size_t chunk = std::bit_width((id / FirstChunkSize) + 1) - 1;
+        return { chunk, id - (FirstChunkSize * ((size_t(1) << chunk) - 1)) };
+    }
+
+    static void insertSlot(Table &table, size_t hash, TagId id)
+    {
+        size_t i = hash & (table.capacity - 1);
+        while (table.slots[i].load(std::memory_order_relaxed) != 0) {
+            i = (i + 1) & (table.capacity - 1);
+        }
+        table.slots[i].store((static_cast<uint64_t>(static_cast<uint32_t>(hash)) << 32U) | (static_cast<uint64_t>(id) + 1), std::memory_order_release);
+    }
+
+    Table *grow(const Table *previous)
+    {
+        auto table = std::make_unique<Table>(previous != nullptr ? previous->capacity * 2 : FirstChunkSize * 2);
+        const auto size = _size.load(std::memory_order_relaxed);
+        for (TagId id = 0; id + 1 < size; ++id) {
+            insertSlot(*table, std::hash<std::string_view> {}(name(id)), id);
+        }
+
+        Table *published = _tables.emplace_back(std::move(table)).get();
+        _table.store(published, std::memory_order_release);
+        return published;
+    }
+
+    std::atomic<TagId> _size = 0;
+    std::array<std::atomic<std::string *>, ChunkCount> _chunks {};
+    std::atomic<Table *> _table = nullptr;
+
+    // Only touched by inserts
+    std::mutex _insertMutex;
+    std::array<std::unique_ptr<std::string[]>, ChunkCount> _ownedChunks;
+    std::vector<std::unique_ptr<Table>> _tables;
+};
+
+Dictionary &dictionary()
+{
+    static Dictionary dict;
+    return dict;
+}
+
+}
+
+bool pointless::core::tagIsBuiltin(TagId id)
+{
+    return id <= BUILTIN_TAG_ID_EVENING;
+}
+
+TagId TagDictionary::intern(std::string_view name)
+{
+    return dictionary().intern(name);
+}
+
+std::optional<TagId> TagDictionary::find(std::string_view name)
+{
+    return dictionary().find(name, std::hash<std::string_view> {}(name));
+}
+
+const std::string &TagDictionary::name(TagId id)
+{
+    return dictionary().name(id);
+}
+
+TagList::TagList(std::initializer_list<std::string_view> names)
+{
+    for (std::string_view name : names) {
+        append(TagDictionary::intern(name));
+    }
+}
+
+void TagList::append(TagId id)
+{
+    _ids.push_back(id);
+    _mask |= maskBit(id);
+}
+
+bool TagList::add(TagId id)
+{
+    if (contains(id))
+        return false;
+    append(id);
+    return true;
+}
+
+bool TagList::add(std::string_view name)
+{
+    if (name.empty())
+        return false;
+    return add(TagDictionary::intern(name));
+}
+
+bool TagList::remove(TagId id)
+{
+    return removeIf([id](TagId other) { return other == id; }) > 0;
+}
+
+bool TagList::replace(TagId from, TagId to)
+{
+    auto it = std::ranges::find(_ids, from);
+    if (it == _ids.end())
+        return false;
+
+    *it = to;
+    rebuildMask();
+    return true;
+}
+
+void TagList::clear()
+{
+    _ids.clear();
+    _mask = 0;
+}
+
+bool TagList::contains(TagId id) const
+{
+    return (_mask & maskBit(id)) != 0 && std::ranges::find(_ids, id) != _ids.end();
+}
+
+bool TagList::contains(std::string_view name) const
+{
+    const auto id = TagDictionary::find(name);
+    return id && contains(*id);
+}
+
+std::span<const TagId> TagList::ids() const
+{
+    return _ids;
+}
+
+size_t TagList::size() const
+{
+    return _ids.size();
+}
+
+bool TagList::empty() const
+{
+    return _ids.empty();
+}
+
+const std::string &TagList::operator[](size_t index) const
+{
+    return TagDictionary::name(_ids[index]);
+}
+
+TagList::const_iterator TagList::begin() const
+{
+    return const_iterator(_ids.cbegin());
+}
+
+TagList::const_iterator TagList::end() const
+{
+    return const_iterator(_ids.cend());
+}
+
+bool TagList::operator==(const TagList &other) const
+{
+    return _ids == other._ids;
+}
+
+uint64_t TagList::maskBit(TagId id)
+{
+    return uint64_t(1) << (id % 64);
+}
+
+void TagList::rebuildMask()
+{
+    _mask = 0;
+    for (TagId id : _ids) {
+        _mask |= maskBit(id);
+    }
+}
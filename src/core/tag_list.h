@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glaze/glaze.hpp>
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pointless::core {
+
+using TagId = uint32_t;
+
+constexpr TagId BUILTIN_TAG_ID_SOON = 0;
+constexpr TagId BUILTIN_TAG_ID_CURRENT = 1;
+constexpr TagId BUILTIN_TAG_ID_EVENING = 2;
+
+bool tagIsBuiltin(TagId id);
+
+/// Process-wide interning of tag names, so tasks can compare tags as integers.
+/// Names are never removed, ids stay valid across Data copies and merges.
+/// The builtin tags always get the BUILTIN_TAG_ID_* ids.
+class TagDictionary
+{
+public:
+    static TagId intern(std::string_view name);
+    static std::optional<TagId> find(std::string_view name);
+    static const std::string &name(TagId id);
+};
+
+/// The tags of a task, as ids in the order they were added.
+/// Iterating yields the names, and JSON and BEVE read and write the names as before.
+class TagList
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string *;
+        using reference = const std::string &;
+
+        const_iterator() = default;
+        explicit const_iterator(std::vector<TagId>::const_iterator it)
+            : _it(it)
+        {
+        }
+
+        reference operator*() const
+        {
+            return TagDictionary::name(*_it);
+        }
+
+        pointer operator->() const
+        {
+            return &TagDictionary::name(*_it);
+        }
+
+        const_iterator &operator++()
+        {
+            ++_it;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++_it;
+            return copy;
+        }
+
+        bool operator==(const const_iterator &other) const = default;
+
+    private:
+        std::vector<TagId>::const_iterator _it;
+    };
+
+    TagList() = default;
+    TagList(std::initializer_list<std::string_view> names);
+
+    /// Appends without deduplicating, keeps what was read from JSON unchanged
+    void append(TagId id);
+
+    /// Appends if not present yet. Returns false if it was already there
+    bool add(TagId id);
+    bool add(std::string_view name);
+
+    bool remove(TagId id);
+    bool replace(TagId from, TagId to);
+    void clear();
+
+    template<typename Pred>
+    size_t removeIf(Pred pred)
+    {
+        const size_t removed = std::erase_if(_ids, pred);
+        if (removed > 0)
+            rebuildMask();
+        return removed;
+    }
+
+    [[nodiscard]] bool contains(TagId id) const;
+    [[nodiscard]] bool contains(std::string_view name) const;
+
+    [[nodiscard]] std::span<const TagId> ids() const;
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] const std::string &operator[](size_t index) const;
+
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    bool operator==(const TagList &other) const;
+
+private:
+    static uint64_t maskBit(TagId id);
+    void rebuildMask();
+
+    std::vector<TagId> _ids;
+    uint64_t _mask = 0; // one bit per id modulo 64, rejects most lookups without scanning
+};
+
+}
+
+namespace glz {
+
+template<>
+struct from<JSON, pointless::core::TagList>
+{
+    template<auto Opts>
+    static void op(pointless::core::TagList &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::vector<std::string> names;
+        parse<JSON>::op<Opts>(names, ctx, it, end);
+        value.clear();
+        for (const auto &name : names) {
+            value.append(pointless::core::TagDictionary::intern(name));
+        }
+    }
+};
+
+template<>
+struct to<JSON, pointless::core::TagList>
+{
+    template<auto Opts>
+    static void op(const pointless::core::TagList &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        std::vector<std::string_view> names(value.begin(), value.end());
+        serialize<JSON>::op<Opts>(names, ctx, b, ix);
+    }
+};
+
+template<>
+struct from<BEVE, pointless::core::TagList>
+{
+    template<auto Opts>
+    static void op(pointless::core::TagList &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::vector<std::string> names;
+        parse<BEVE>::op<Opts>(names, ctx, it, end);
+        value.clear();
+        for (const auto &name : names) {
+            value.append(pointless::core::TagDictionary::intern(name));
+        }
+    }
+};
+
+template<>
+struct to<BEVE, pointless::core::TagList>
+{
+    template<auto Opts>
+    static void op(const pointless::core::TagList &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        std::vector<std::string_view> names(value.begin(), value.end());
+        serialize<BEVE>::op<Opts>(names, ctx, b, ix);
+    }
+};
+
+}
@@ -15,8 +15,8 @@ namespace pointless::core {
 
 Task::Task() = default;
 
-Task::Task(std::string uuid_, std::chrono::system_clock::time_point creationTimestamp_, std::string title_)
-    : uuid(std::move(uuid_))
+Task::Task(Uuid uuid_, std::chrono::system_clock::time_point creationTimestamp_, std::string title_)
+    : uuid(uuid_)
     , title(std::move(title_))
     , creationTimestamp(creationTimestamp_)
 {
@@ -24,9 +24,12 @@ Task::Task(std::string uuid_, std::chrono::system_clock::time_point creationTime
 
 bool Task::containsTag(std::string_view tagName) const
 {
-    return std::ranges::any_of(tags, [tagName](const auto &tag) {
-        return tag == tagName;
-    });
+    return tags.contains(tagName);
+}
+
+bool Task::containsTag(TagId tagId) const
+{
+    return tags.contains(tagId);
 }
 
 bool Task::isSoon() const
@@ -34,7 +37,7 @@ bool Task::isSoon() const
     if (isCurrent())
         return false;
 
-    return containsTag(BUILTIN_TAG_SOON) || isDueIn(std::chrono::days(15));
+    return containsTag(BUILTIN_TAG_ID_SOON) || isDueIn(std::chrono::days(15));
 }
 
 bool Task::isLater() const
@@ -44,19 +47,19 @@ bool Task::isLater() const
 
 bool Task::isCurrent() const
 {
-    return containsTag(BUILTIN_TAG_CURRENT) || isDueThisWeek() || isOverdue();
+    return containsTag(BUILTIN_TAG_ID_CURRENT) || isDueThisWeek() || isOverdue();
 }
 
 bool Task::isEvening() const
 {
-    return containsTag(BUILTIN_TAG_EVENING);
+    return containsTag(BUILTIN_TAG_ID_EVENING);
 }
 
 std::string Task::tagName() const
 {
-    for (const auto &tag : tags) {
-        if (!tagIsBuiltin(tag)) {
-            return tag;
+    for (TagId id : tags.ids()) {
+        if (!tagIsBuiltin(id)) {
+            return TagDictionary::name(id);
         }
     }
     return {};
@@ -108,7 +111,7 @@ bool Task::shouldBeCleanedUp() const
 
 void Task::setTags(const std::vector<std::string> &newTags)
 {
-    tags = {};
+    tags.clear();
     for (const auto &tag : newTags) {
         addTag(tag);
     }
@@ -116,17 +119,13 @@ void Task::setTags(const std::vector<std::string> &newTags)
 
 bool Task::addTag(std::string_view tag)
 {
-    if (!tag.empty() && !containsTag(tag)) {
-        tags.emplace_back(tag);
-        return true;
-    }
-    return false;
+    return tags.add(tag);
 }
 
 void Task::removeBuiltinTags()
 {
-    std::erase_if(tags, [](const std::string &tag) {
-        return tagIsBuiltin(tag);
+    tags.removeIf([](TagId id) {
+        return tagIsBuiltin(id);
     });
 }
 
@@ -159,6 +158,17 @@ void Task::dumpDebug() const
 }
 
 
+bool Task::operator==(const Task &other) const = default;
+
+/// Compares everything except the sync bookkeeping
+bool Task::hasSameContent(const Task &other) const
+{
+    Task copy = other;
+    copy.revision = revision;
+    copy.needsSyncToServer = needsSyncToServer;
+    return *this == copy;
+}
+
 void Task::mergeConflict(const Task &other)
 {
     // Completion: Undone > Done
@@ -196,19 +206,22 @@ void Task::mergeConflict(const Task &other)
     }
 
     // Tags: Union
-    std::vector<std::string> newTags = tags;
-    for (const auto &tag : other.tags) {
-        newTags.push_back(tag);
+    TagList newTags;
+    for (TagId id : tags.ids()) {
+        newTags.add(id);
+    }
+    for (TagId id : other.tags.ids()) {
+        newTags.add(id);
     }
-    setTags(newTags);
+    tags = std::move(newTags);
 
     // Special Rule: Current wins over Soon
-    bool hasCurrent = containsTag(BUILTIN_TAG_CURRENT);
-    bool hasSoon = containsTag(BUILTIN_TAG_SOON);
+    bool hasCurrent = containsTag(BUILTIN_TAG_ID_CURRENT);
+    bool hasSoon = containsTag(BUILTIN_TAG_ID_SOON);
 
     if (hasCurrent && hasSoon) {
         // Remove Soon
-        std::erase(tags, std::string(BUILTIN_TAG_SOON));
+        tags.remove(BUILTIN_TAG_ID_SOON);
     }
 
     isYearly = isYearly.value_or(false) || other.isYearly.value_or(false);
@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include "completion_history.h"
+#include "tag_list.h"
+#include "task_notes.h"
+#include "uuid.h"
+
 #include <glaze/glaze.hpp>
 
 #include <chrono>
@@ -16,9 +21,10 @@ class Task
 {
 public:
     Task();
-    Task(std::string uuid, std::chrono::system_clock::time_point creationTimestamp, std::string title = {});
+    Task(Uuid uuid, std::chrono::system_clock::time_point creationTimestamp, std::string title = {});
 
     [[nodiscard]] bool containsTag(std::string_view tagName) const;
+    [[nodiscard]] bool containsTag(TagId tagId) const;
     [[nodiscard]] bool isSoon() const;
     [[nodiscard]] bool isLater() const;
     [[nodiscard]] bool isCurrent() const;
@@ -31,6 +37,9 @@ public:
 
     void removeBuiltinTags();
     void mergeConflict(const Task &other);
+    [[nodiscard]] bool hasSameContent(const Task &other) const;
+
+    bool operator==(const Task &other) const;
 
     void dumpDebug() const;
 
@@ -40,8 +49,8 @@ public:
 
     int revision = -1;
     bool needsSyncToServer = false;
-    std::string uuid;
-    std::optional<std::string> parentUuid;
+    Uuid uuid;
+    std::optional<Uuid> parentUuid;
     std::string title;
     bool isDone = false;
     std::optional<bool> isGoal;
@@ -49,9 +58,9 @@ public:
     bool isImportant = false;
     std::optional<bool> hideOnWeekends;
     int timesPerWeek = 1;
-    std::vector<int> lastCompletions;
+    CompletionHistory lastCompletions;
     std::string sectionName;
-    std::vector<std::string> tags;
+    TagList tags;
     std::chrono::system_clock::time_point creationTimestamp;
     std::optional<std::chrono::system_clock::time_point> modificationTimestamp;
     std::optional<std::chrono::system_clock::time_point> lastPomodoroDate;
@@ -60,7 +69,7 @@ public:
     std::optional<std::string> uuidInDeviceCalendar;
     std::optional<std::string> deviceCalendarUuid;
     std::optional<std::string> deviceCalendarName;
-    std::optional<std::string> description;
+    TaskNotes description;
 };
 
 } // namespace pointless::core
@@ -90,6 +99,29 @@ struct to<JSON, std::chrono::system_clock::time_point>
     }
 };
 
+template<>
+struct from<BEVE, std::chrono::system_clock::time_point>
+{
+    template<auto Opts>
+    static void op(std::chrono::system_clock::time_point &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        int64_t millis = 0;
+        parse<BEVE>::op<Opts>(millis, ctx, it, end);
+        value = std::chrono::system_clock::time_point(std::chrono::milliseconds(millis));
+    }
+};
+
+template<>
+struct to<BEVE, std::chrono::system_clock::time_point>
+{
+    template<auto Opts>
+    static void op(std::chrono::system_clock::time_point value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(value.time_since_epoch()).count();
+        serialize<BEVE>::op<Opts>(millis, ctx, b, ix);
+    }
+};
+
 }
 
 template<>
@@ -0,0 +1,358 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "task_archive.h"
+#include "file_io.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "operation_log.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <ranges>
+
+using namespace pointless::core;
+
+namespace {
+
+constexpr std::string_view ArchiveMagic = "PLAR0001";
+constexpr std::string_view IndexMagic = "PLAI0001";
+constexpr size_t FrameHeaderSize = 8;
+
+template<typename T>
+void putLE(std::string &out, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (i * 8)) & 0xFF));
+    }
+}
+
+/// Reads a little-endian T from the front of @p in and advances it. Returns false if too short
+template<typename T>
+bool takeLE(std::string_view &in, T &value)
+{
+    if (in.size() < sizeof(T))
+        return false;
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        result |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (i * 8);
+    }
+    value = static_cast<T>(result);
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+void appendFrame(std::string &out, std::string_view payload)
+{
+    putLE(out, static_cast<uint32_t>(payload.size()));
+    putLE(out, OperationLog::checksum(payload));
+    out.append(payload);
+}
+
+/// The payload of the intact frame at @p offset, or nullopt if it's torn or corrupt
+std::optional<std::string_view> frameAt(std::string_view content, uint64_t offset)
+{
+    if (offset > content.size() || content.size() - offset < FrameHeaderSize)
+        return std::nullopt;
+
+    std::string_view header = content.substr(offset, FrameHeaderSize);
+    uint32_t payloadSize = 0;
+    uint32_t crc = 0;
+    takeLE(header, payloadSize);
+    takeLE(header, crc);
+    if (payloadSize == 0 || content.size() - offset - FrameHeaderSize < payloadSize)
+        return std::nullopt;
+
+    const std::string_view payload = content.substr(offset + FrameHeaderSize, payloadSize);
+    if (OperationLog::checksum(payload) != crc)
+        return std::nullopt;
+
+    return payload;
+}
+
+uint64_t fileSize(const std::string &path)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : size;
+}
+
+char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool containsIgnoringCase(std::string_view haystack, std::string_view needle)
+{
+    if (needle.empty())
+        return true;
+
+    return !std::ranges::search(haystack, needle, [](char a, char b) { return asciiLower(a) == asciiLower(b); }).empty();
+}
+
+int64_t toMillis(std::chrono::system_clock::time_point tp)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+}
+
+TaskArchive::TaskArchive(std::string path)
+    : _path(std::move(path))
+{
+}
+
+std::string TaskArchive::pathFor(const std::string &dataFilename)
+{
+    return dataFilename + ".archive";
+}
+
+const std::string &TaskArchive::path() const
+{
+    return _path;
+}
+
+std::string TaskArchive::indexPath() const
+{
+    return _path + ".idx";
+}
+
+std::chrono::system_clock::time_point TaskArchive::archiveDate(const Task &task)
+{
+    return task.completionDate.value_or(task.modificationTimestamp.value_or(task.creationTimestamp));
+}
+
+std::expected<void, std::string> TaskArchive::append(std::span<const Task> tasks)
+{
+    if (tasks.empty())
+        return {};
+
+    if (auto loaded = loadIndex(); !loaded)
+        return loaded;
+    // The frame appended below would be unreachable behind a torn tail
+    if (auto truncated = truncateTornIndexTail(); !truncated)
+        return truncated;
+
+    auto json = glz::write_json(tasks);
+    if (!json) {
+        return std::unexpected("Failed to serialize archived tasks");
+    }
+
+    uLongf compressedSize = ::compressBound(static_cast<uLong>(json->size()));
+    std::string payload;
+    putLE(payload, static_cast<uint32_t>(json->size()));
+    const size_t headerSize = payload.size();
+    payload.resize(headerSize + compressedSize);
+    const int zresult = ::compress2(reinterpret_cast<Bytef *>(payload.data() + headerSize), &compressedSize,
+                                    reinterpret_cast<const Bytef *>(json->data()), static_cast<uLong>(json->size()), Z_BEST_COMPRESSION);
+    if (zresult != Z_OK) {
+        return std::unexpected("Failed to compress archived tasks: zlib error " + std::to_string(zresult));
+    }
+    payload.resize(headerSize + compressedSize);
+
+    std::string archiveBytes;
+    uint64_t batchOffset = fileSize(_path);
+    if (batchOffset == 0) {
+        archiveBytes.append(ArchiveMagic);
+        batchOffset = ArchiveMagic.size();
+    }
+    appendFrame(archiveBytes, payload);
+
+    if (auto written = appendToFile(_path, archiveBytes); !written)
+        return written;
+
+    std::vector<Entry> entries;
+    entries.reserve(tasks.size());
+    std::string indexPayload;
+    putLE(indexPayload, batchOffset);
+    putLE(indexPayload, static_cast<uint32_t>(tasks.size()));
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Task &task = tasks[i];
+        const auto date = archiveDate(task);
+        const std::string_view title = std::string_view(task.title).substr(0, std::numeric_limits<uint16_t>::max());
+
+        putLE(indexPayload, toMillis(date));
+        putLE(indexPayload, static_cast<uint16_t>(title.size()));
+        indexPayload.append(title);
+        entries.push_back({ date, std::string(title), batchOffset, static_cast<uint32_t>(i) });
+    }
+
+    std::string indexBytes;
+    if (fileSize(indexPath()) == 0)
+        indexBytes.append(IndexMagic);
+    appendFrame(indexBytes, indexPayload);
+
+    // A crash before this leaves an unindexed batch behind, which is never read
+    if (auto written = appendToFile(indexPath(), indexBytes); !written)
+        return written;
+
+    _intactIndexSize += indexBytes.size();
+    insertSorted(std::move(entries));
+    return {};
+}
+
+std::expected<void, std::string> TaskArchive::truncateTornIndexTail()
+{
+    const std::string path = indexPath();
+    const uint64_t size = fileSize(path);
+    if (size <= _intactIndexSize)
+        return {};
+
+    P_LOG_WARNING_NOABORT("Discarding {} bytes of torn or corrupt entries at the end of {}", size - _intactIndexSize, path);
+    std::error_code ec;
+    std::filesystem::resize_file(path, _intactIndexSize, ec);
+    if (ec) {
+        return std::unexpected("Failed to truncate archive index " + path + ": " + ec.message());
+    }
+    return {};
+}
+
+std::expected<void, std::string> TaskArchive::loadIndex()
+{
+    if (_index)
+        return {};
+
+    std::vector<Entry> entries;
+    const std::string path = indexPath();
+    if (fileSize(path) == 0) {
+        _index = std::move(entries);
+        _intactIndexSize = 0;
+        return {};
+    }
+
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    const std::string_view content = file->contents();
+    if (!content.starts_with(IndexMagic)) {
+        return std::unexpected("Not an archive index: " + path);
+    }
+
+    uint64_t offset = IndexMagic.size();
+    while (auto payload = frameAt(content, offset)) {
+        std::string_view in = *payload;
+        uint64_t batchOffset = 0;
+        uint32_t count = 0;
+        if (!takeLE(in, batchOffset) || !takeLE(in, count))
+            break;
+
+        std::vector<Entry> batch;
+        batch.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            int64_t millis = 0;
+            uint16_t titleSize = 0;
+            if (!takeLE(in, millis) || !takeLE(in, titleSize) || in.size() < titleSize)
+                break;
+
+            const std::chrono::system_clock::time_point date { std::chrono::milliseconds(millis) };
+            batch.push_back({ date, std::string(in.substr(0, titleSize)), batchOffset, i });
+            in.remove_prefix(titleSize);
+        }
+
+        if (batch.size() != count)
+            break;
+
+        std::ranges::move(batch, std::back_inserter(entries));
+        offset += FrameHeaderSize + payload->size();
+    }
+
+    if (offset != content.size())
+        P_LOG_WARNING_NOABORT("Ignoring {} bytes of torn or corrupt entries at the end of {}", content.size() - offset, path);
+
+    _intactIndexSize = offset;
+    _index.emplace();
+    insertSorted(std::move(entries));
+    return {};
+}
+
+void TaskArchive::insertSorted(std::vector<Entry> entries)
+{
+    const auto byDate = [](const Entry &a, const Entry &b) { return a.completionDate < b.completionDate; };
+    std::ranges::stable_sort(entries, byDate);
+
+    auto &index = *_index;
+    const auto middle = static_cast<std::ptrdiff_t>(index.size());
+    std::ranges::move(entries, std::back_inserter(index));
+    std::inplace_merge(index.begin(), index.begin() + middle, index.end(), byDate);
+}
+
+std::expected<std::vector<TaskArchive::Entry>, std::string> TaskArchive::search(std::string_view query, size_t limit)
+{
+    if (auto loaded = loadIndex(); !loaded)
+        return std::unexpected(loaded.error());
+
+    std::vector<Entry> result;
+    for (const Entry &entry : std::views::reverse(*_index)) {
+        if (result.size() >= limit)
+            break;
+        if (containsIgnoringCase(entry.title, query))
+            result.push_back(entry);
+    }
+
+    return result;
+}
+
+std::expected<std::vector<Task>, std::string> TaskArchive::loadTasks(std::span<const Entry> entries) const
+{
+    std::vector<Task> result;
+    if (entries.empty())
+        return result;
+
+    auto file = MappedFile::open(_path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    const std::string_view content = file->contents();
+    if (!content.starts_with(ArchiveMagic)) {
+        return std::unexpected("Not a task archive: " + _path);
+    }
+
+    std::map<uint64_t, std::vector<Task>> batches;
+    result.reserve(entries.size());
+    for (const Entry &entry : entries) {
+        auto it = batches.find(entry.batchOffset);
+        if (it == batches.end()) {
+            auto payload = frameAt(content, entry.batchOffset);
+            uint32_t jsonSize = 0;
+            if (!payload || !takeLE(*payload, jsonSize)) {
+                return std::unexpected("Corrupt archive batch at offset " + std::to_string(entry.batchOffset));
+            }
+
+            std::string json(jsonSize, '\0');
+            uLongf inflatedSize = jsonSize;
+            const int zresult = ::uncompress(reinterpret_cast<Bytef *>(json.data()), &inflatedSize,
+                                             reinterpret_cast<const Bytef *>(payload->data()), static_cast<uLong>(payload->size()));
+            if (zresult != Z_OK || inflatedSize != jsonSize) {
+                return std::unexpected("Failed to inflate archive batch at offset " + std::to_string(entry.batchOffset));
+            }
+
+            std::vector<Task> tasks;
+            if (auto error = glz::read_json(tasks, json)) {
+                return std::unexpected("Failed to parse archive batch: " + std::string(glz::format_error(error, json)));
+            }
+            it = batches.emplace(entry.batchOffset, std::move(tasks)).first;
+        }
+
+        if (entry.indexInBatch >= it->second.size()) {
+            return std::unexpected("Archive index points past its batch at offset " + std::to_string(entry.batchOffset));
+        }
+        result.push_back(it->second[entry.indexInBatch]);
+    }
+
+    return result;
+}
+
+std::expected<size_t, std::string> TaskArchive::taskCount()
+{
+    if (auto loaded = loadIndex(); !loaded)
+        return std::unexpected(loaded.error());
+    return _index->size();
+}
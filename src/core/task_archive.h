@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pointless::core {
+
+/// Completed tasks moved out of Data by cleanup. Local only, never part of the synced document.
+/// The archive file is append-only: each frame holds one zlib-compressed JSON batch of tasks and is
+/// framed like the operation log. A separate index file lists the completion date and title of every
+/// archived task plus where its batch starts, so searching reads only the small index and inflates
+/// just the batches that matched.
+class TaskArchive
+{
+public:
+    struct Entry
+    {
+        std::chrono::system_clock::time_point completionDate;
+        std::string title;
+        uint64_t batchOffset = 0;
+        uint32_t indexInBatch = 0;
+    };
+
+    explicit TaskArchive(std::string path);
+
+    /// The archive that belongs to the local data file @p dataFilename
+    static std::string pathFor(const std::string &dataFilename);
+
+    [[nodiscard]] const std::string &path() const;
+    [[nodiscard]] std::string indexPath() const;
+
+    /// Compresses @p tasks into a new batch and indexes them. Both files are fsynced before returning
+    [[nodiscard]] std::expected<void, std::string> append(std::span<const Task> tasks);
+
+    /// Entries whose title contains @p query, ignoring ASCII case, most recently completed first.
+    /// An empty query matches everything. The index is read on first use
+    [[nodiscard]] std::expected<std::vector<Entry>, std::string> search(std::string_view query, size_t limit = std::numeric_limits<size_t>::max());
+
+    /// Inflates the batches @p entries point into, each once, and returns their tasks in the same order
+    [[nodiscard]] std::expected<std::vector<Task>, std::string> loadTasks(std::span<const Entry> entries) const;
+
+    [[nodiscard]] std::expected<size_t, std::string> taskCount();
+
+    /// The date a task is indexed by: its completion, or its last modification for tasks done
+    /// before completion dates were recorded
+    static std::chrono::system_clock::time_point archiveDate(const Task &task);
+
+private:
+    /// Reads the intact frames of the index, leaving a torn tail on disk for append() to cut off
+    [[nodiscard]] std::expected<void, std::string> loadIndex();
+    [[nodiscard]] std::expected<void, std::string> truncateTornIndexTail();
+    void insertSorted(std::vector<Entry> entries);
+
+    std::string _path;
+    std::optional<std::vector<Entry>> _index; // sorted by completion date, oldest first
+    uint64_t _intactIndexSize = 0; // bytes of the index file covered by _index
+};
+
+}
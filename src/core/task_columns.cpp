@@ -0,0 +1,415 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "task_columns.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define POINTLESS_AVX2_DISPATCH
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define POINTLESS_NEON
+#endif
+
+using namespace pointless::core;
+
+namespace {
+
+constexpr size_t kWordBits = 64;
+
+size_t wordCount(size_t size)
+{
+    return (size + kWordBits - 1) / kWordBits;
+}
+
+uint64_t lastWordMask(size_t size)
+{
+    const size_t tail = size % kWordBits;
+    return tail == 0 ? ~uint64_t(0) : (uint64_t(1) << tail) - 1;
+}
+
+uint64_t rangeBitsScalar(const int64_t *values, size_t count, int64_t from, int64_t to)
+{
+    uint64_t bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bits |= uint64_t(values[i] >= from && values[i] < to) << i;
+    }
+    return bits;
+}
+
+#if defined(POINTLESS_AVX2_DISPATCH) || defined(__AVX2__)
+
+#ifdef POINTLESS_AVX2_DISPATCH
+__attribute__((target("avx2")))
+#endif
+uint64_t rangeBitsAvx2(const int64_t *values, int64_t from, int64_t to)
+{
+    const __m256i lower = _mm256_set1_epi64x(from);
+    const __m256i upper = _mm256_set1_epi64x(to);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kWordBits; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)); // NOLINT
+        const __m256i belowFrom = _mm256_cmpgt_epi64(lower, v);
+        const __m256i belowTo = _mm256_cmpgt_epi64(upper, v);
+        const __m256i inRange = _mm256_andnot_si256(belowFrom, belowTo);
+        const auto mask = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(inRange)));
+        bits |= mask << i;
+    }
+    return bits;
+}
+
+bool cpuHasAvx2()
+{
+#ifdef POINTLESS_AVX2_DISPATCH
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+#else
+    return true;
+#endif
+}
+
+#endif
+
+#ifdef POINTLESS_NEON
+
+uint64_t rangeBitsNeon(const int64_t *values, int64_t from, int64_t to)
+{
+    const int64x2_t lower = vdupq_n_s64(from);
+    const int64x2_t upper = vdupq_n_s64(to);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < kWordBits; i += 2) {
+        const int64x2_t v = vld1q_s64(values + i);
+        const uint64x2_t inRange = vandq_u64(vcgeq_s64(v, lower), vcltq_s64(v, upper));
+        bits |= (vgetq_lane_u64(inRange, 0) & 1) << i;
+        bits |= (vgetq_lane_u64(inRange, 1) & 1) << (i + 1);
+    }
+    return bits;
+}
+
+#endif
+
+using FullWordKernel = uint64_t (*)(const int64_t *, int64_t, int64_t);
+
+uint64_t rangeBitsScalarWord(const int64_t *values, int64_t from, int64_t to)
+{
+    return rangeBitsScalar(values, kWordBits, from, to);
+}
+
+FullWordKernel fullWordKernel()
+{
+#if defined(POINTLESS_AVX2_DISPATCH) || defined(__AVX2__)
+    if (cpuHasAvx2())
+        return rangeBitsAvx2;
+#elif defined(POINTLESS_NEON)
+    return rangeBitsNeon;
+#endif
+    return rangeBitsScalarWord;
+}
+
+}
+
+void ColumnKernels::intersectRange(std::span<const int64_t> values, int64_t from, int64_t to, std::span<uint64_t> words)
+{
+    const FullWordKernel kernel = fullWordKernel();
+    const size_t fullWords = values.size() / kWordBits;
+    for (size_t w = 0; w < fullWords; ++w) {
+        words[w] &= kernel(values.data() + (w * kWordBits), from, to);
+    }
+
+    const size_t tail = values.size() % kWordBits;
+    if (tail > 0)
+        words[fullWords] &= rangeBitsScalar(values.data() + (fullWords * kWordBits), tail, from, to);
+}
+
+const char *ColumnKernels::rangeKernelName()
+{
+    [[maybe_unused]] const FullWordKernel kernel = fullWordKernel();
+#if defined(POINTLESS_AVX2_DISPATCH) || defined(__AVX2__)
+    if (kernel == rangeBitsAvx2)
+        return "avx2";
+#elif defined(POINTLESS_NEON)
+    if (kernel == rangeBitsNeon)
+        return "neon";
+#endif
+    return "scalar";
+}
+
+PositionRange::iterator::iterator(std::span<const uint64_t> words, uint64_t lastWordMask, bool inverted, size_t wordIndex)
+    : _words(words)
+    , _lastWordMask(lastWordMask)
+    , _inverted(inverted)
+    , _wordIndex(wordIndex)
+{
+    if (_wordIndex < _words.size()) {
+        _bits = word(_wordIndex);
+        skipEmptyWords();
+    }
+}
+
+PositionRange::iterator &PositionRange::iterator::operator++()
+{
+    _bits &= _bits - 1;
+    skipEmptyWords();
+    return *this;
+}
+
+void PositionRange::iterator::skipEmptyWords()
+{
+    while (_bits == 0 && _wordIndex < _words.size()) {
+        ++_wordIndex;
+        if (_wordIndex < _words.size())
+            _bits = word(_wordIndex);
+    }
+}
+
+uint64_t PositionRange::iterator::word(size_t index) const
+{
+    uint64_t bits = _inverted ? ~_words[index] : _words[index];
+    if (index + 1 == _words.size())
+        bits &= _lastWordMask;
+    return bits;
+}
+
+PositionRange::PositionRange(std::span<const uint64_t> words, size_t size, bool inverted)
+    : _words(words.first(wordCount(size)))
+    , _lastWordMask(lastWordMask(size))
+    , _inverted(inverted)
+{
+}
+
+PositionRange::iterator PositionRange::begin() const
+{
+    return { _words, _lastWordMask, _inverted, 0 };
+}
+
+PositionRange::iterator PositionRange::end() const
+{
+    return { _words, _lastWordMask, _inverted, _words.size() };
+}
+
+void TaskColumns::rebuild(std::span<const Task> tasks)
+{
+    clear();
+    for (const Task &task : tasks) {
+        append(task);
+    }
+}
+
+void TaskColumns::append(const Task &task)
+{
+    ++_size;
+    for (auto &bitmap : _bitmaps) {
+        bitmap.resize(wordCount(_size));
+    }
+    _dueDates.emplace_back();
+    _modificationTimestamps.emplace_back();
+    assign(_size - 1, task);
+}
+
+void TaskColumns::assign(size_t position, const Task &task)
+{
+    set(TaskColumn::Done, position, task.isDone);
+    set(TaskColumn::NeedsSyncToServer, position, task.needsSyncToServer);
+    set(TaskColumn::Important, position, task.isImportant);
+    set(TaskColumn::Goal, position, task.isGoal.value_or(false));
+    set(TaskColumn::Yearly, position, task.isYearly.value_or(false));
+    set(TaskColumn::New, position, task.revision == -1);
+    set(TaskColumn::TagSoon, position, task.containsTag(BUILTIN_TAG_ID_SOON));
+    set(TaskColumn::TagCurrent, position, task.containsTag(BUILTIN_TAG_ID_CURRENT));
+    set(TaskColumn::TagEvening, position, task.containsTag(BUILTIN_TAG_ID_EVENING));
+    set(TaskColumn::HasNotes, position, task.description.hasText());
+
+    _dueDates[position] = task.dueDate ? toMilliseconds(*task.dueDate) : NoDueDate;
+    _modificationTimestamps[position] = task.modificationTimestamp ? toMilliseconds(*task.modificationTimestamp) : NoModification;
+    bumpVersion();
+}
+
+void TaskColumns::clear()
+{
+    for (auto &bitmap : _bitmaps) {
+        bitmap.clear();
+    }
+    _dueDates.clear();
+    _modificationTimestamps.clear();
+    _size = 0;
+    bumpVersion();
+}
+
+size_t TaskColumns::size() const
+{
+    return _size;
+}
+
+bool TaskColumns::test(TaskColumn column, size_t position) const
+{
+    const auto &bitmap = _bitmaps[static_cast<size_t>(column)];
+    return ((bitmap[position / kWordBits] >> (position % kWordBits)) & 1) != 0;
+}
+
+std::span<const uint64_t> TaskColumns::bitmap(TaskColumn column) const
+{
+    return _bitmaps[static_cast<size_t>(column)];
+}
+
+PositionRange TaskColumns::positions(TaskColumn column, bool value) const
+{
+    return { bitmap(column), _size, !value };
+}
+
+int64_t TaskColumns::dueDate(size_t position) const
+{
+    return _dueDates[position];
+}
+
+std::span<const int64_t> TaskColumns::dueDates() const
+{
+    return _dueDates;
+}
+
+std::span<const int64_t> TaskColumns::modificationTimestamps() const
+{
+    return _modificationTimestamps;
+}
+
+uint64_t TaskColumns::version() const
+{
+    return _version;
+}
+
+void TaskColumns::bumpVersion()
+{
+    static std::atomic<uint64_t> s_lastVersion = 0;
+    _version = ++s_lastVersion;
+}
+
+int64_t TaskColumns::toMilliseconds(std::chrono::system_clock::time_point time)
+{
+    return std::chrono::floor<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+void TaskColumns::set(TaskColumn column, size_t position, bool value)
+{
+    uint64_t &word = _bitmaps[static_cast<size_t>(column)][position / kWordBits];
+    const uint64_t bit = uint64_t(1) << (position % kWordBits);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+TaskSelection::TaskSelection(const TaskColumns &columns, bool selectAll)
+    : _columns(&columns)
+    , _words(wordCount(columns.size()), selectAll ? ~uint64_t(0) : 0)
+{
+    if (!_words.empty())
+        _words.back() &= lastWordMask(columns.size());
+}
+
+TaskSelection &TaskSelection::with(TaskColumn column)
+{
+    const auto bitmap = _columns->bitmap(column);
+    for (size_t i = 0; i < _words.size(); ++i) {
+        _words[i] &= bitmap[i];
+    }
+    return *this;
+}
+
+TaskSelection &TaskSelection::without(TaskColumn column)
+{
+    const auto bitmap = _columns->bitmap(column);
+    for (size_t i = 0; i < _words.size(); ++i) {
+        _words[i] &= ~bitmap[i];
+    }
+    return *this;
+}
+
+TaskSelection &TaskSelection::dueBetween(int64_t fromMs, int64_t toMs)
+{
+    return intersectRange(_columns->dueDates(), fromMs, toMs);
+}
+
+TaskSelection &TaskSelection::dueBefore(int64_t ms)
+{
+    return intersectRange(_columns->dueDates(), std::numeric_limits<int64_t>::min(), ms);
+}
+
+TaskSelection &TaskSelection::modifiedBefore(int64_t ms)
+{
+    return intersectRange(_columns->modificationTimestamps(), TaskColumns::NoModification, ms);
+}
+
+TaskSelection &TaskSelection::withoutDueDate()
+{
+    const auto dueDates = _columns->dueDates();
+    for (size_t i = 0; i < dueDates.size(); ++i) {
+        if (dueDates[i] != TaskColumns::NoDueDate)
+            _words[i / kWordBits] &= ~(uint64_t(1) << (i % kWordBits));
+    }
+    return *this;
+}
+
+void TaskSelection::add(size_t position)
+{
+    _words[position / kWordBits] |= uint64_t(1) << (position % kWordBits);
+}
+
+TaskSelection &TaskSelection::unite(const TaskSelection &other)
+{
+    for (size_t i = 0; i < _words.size(); ++i) {
+        _words[i] |= other._words[i];
+    }
+    return *this;
+}
+
+TaskSelection &TaskSelection::subtract(const TaskSelection &other)
+{
+    for (size_t i = 0; i < _words.size(); ++i) {
+        _words[i] &= ~other._words[i];
+    }
+    return *this;
+}
+
+bool TaskSelection::contains(size_t position) const
+{
+    return ((_words[position / kWordBits] >> (position % kWordBits)) & 1) != 0;
+}
+
+size_t TaskSelection::count() const
+{
+    size_t result = 0;
+    for (uint64_t word : _words) {
+        result += static_cast<size_t>(std::popcount(word));
+    }
+    return result;
+}
+
+PositionRange TaskSelection::positionsView() const
+{
+    return { _words, _columns->size(), false };
+}
+
+std::vector<uint32_t> TaskSelection::positions() const
+{
+    std::vector<uint32_t> result;
+    result.reserve(count());
+    for (size_t position : positionsView()) {
+        result.push_back(static_cast<uint32_t>(position));
+    }
+    return result;
+}
+
+TaskSelection TaskSelection::cleanupCandidates(const TaskColumns &columns, std::chrono::system_clock::time_point now)
+{
+    const auto twoWeeksAgo = now - std::chrono::days(14);
+    TaskSelection result(columns);
+    result.with(TaskColumn::Done).without(TaskColumn::Yearly).modifiedBefore(TaskColumns::toMilliseconds(twoWeeksAgo));
+    return result;
+}
+
+TaskSelection &TaskSelection::intersectRange(std::span<const int64_t> values, int64_t fromMs, int64_t toMs)
+{
+    ColumnKernels::intersectRange(values, fromMs, toMs, _words);
+    return *this;
+}
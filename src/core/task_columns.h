@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace pointless::core {
+
+enum class TaskColumn : uint8_t {
+    Done,
+    NeedsSyncToServer,
+    Important,
+    Goal,
+    Yearly,
+    New,
+    TagSoon,
+    TagCurrent,
+    TagEvening,
+    HasNotes,
+    Count
+};
+
+/// Positions of the set (or cleared) bits of a bitmap, visited a word at a time.
+class PositionRange : public std::ranges::view_interface<PositionRange>
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = size_t;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(std::span<const uint64_t> words, uint64_t lastWordMask, bool inverted, size_t wordIndex);
+
+        size_t operator*() const
+        {
+            return (_wordIndex * 64) + static_cast<size_t>(std::countr_zero(_bits));
+        }
+
+        iterator &operator++();
+        iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const iterator &other) const
+        {
+            return _wordIndex == other._wordIndex && _bits == other._bits;
+        }
+
+    private:
+        void skipEmptyWords();
+        [[nodiscard]] uint64_t word(size_t index) const;
+
+        std::span<const uint64_t> _words;
+        uint64_t _lastWordMask = 0;
+        bool _inverted = false;
+        size_t _wordIndex = 0;
+        uint64_t _bits = 0;
+    };
+
+    PositionRange() = default;
+    PositionRange(std::span<const uint64_t> words, size_t size, bool inverted);
+
+    [[nodiscard]] iterator begin() const;
+    [[nodiscard]] iterator end() const;
+
+private:
+    std::span<const uint64_t> _words;
+    uint64_t _lastWordMask = 0;
+    bool _inverted = false;
+};
+
+/// Structure-of-arrays copy of the task fields that filters look at, kept parallel to the
+/// task vector by Data. Flags are bitmaps, dates are milliseconds since epoch.
+class TaskColumns
+{
+public:
+    static constexpr int64_t NoDueDate = std::numeric_limits<int64_t>::max();
+    static constexpr int64_t NoModification = std::numeric_limits<int64_t>::min();
+
+    void rebuild(std::span<const Task> tasks);
+    void append(const Task &task);
+    void assign(size_t position, const Task &task);
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool test(TaskColumn column, size_t position) const;
+    [[nodiscard]] std::span<const uint64_t> bitmap(TaskColumn column) const;
+    [[nodiscard]] PositionRange positions(TaskColumn column, bool value = true) const;
+
+    [[nodiscard]] int64_t dueDate(size_t position) const;
+    [[nodiscard]] std::span<const int64_t> dueDates() const;
+    [[nodiscard]] std::span<const int64_t> modificationTimestamps() const;
+
+    /// Changes on every mutation and is unique across instances, for caching derived results
+    [[nodiscard]] uint64_t version() const;
+
+    static int64_t toMilliseconds(std::chrono::system_clock::time_point time);
+
+private:
+    void bumpVersion();
+
+    void set(TaskColumn column, size_t position, bool value);
+
+    std::array<std::vector<uint64_t>, static_cast<size_t>(TaskColumn::Count)> _bitmaps;
+    std::vector<int64_t> _dueDates;
+    std::vector<int64_t> _modificationTimestamps;
+    size_t _size = 0;
+    uint64_t _version = 0;
+};
+
+/// A set of task positions as a bitmap, narrowed column by column.
+/// Starts with every task selected (or none), date filters run as SIMD kernels where available.
+class TaskSelection
+{
+public:
+    explicit TaskSelection(const TaskColumns &columns, bool selectAll = true);
+
+    TaskSelection &with(TaskColumn column);
+    TaskSelection &without(TaskColumn column);
+
+    /// [from, to) on the due date. Tasks without a due date never match
+    TaskSelection &dueBetween(int64_t fromMs, int64_t toMs);
+    TaskSelection &dueBefore(int64_t ms);
+
+    /// Tasks without a modification timestamp always match
+    TaskSelection &modifiedBefore(int64_t ms);
+    TaskSelection &withoutDueDate();
+
+    void add(size_t position);
+
+    TaskSelection &unite(const TaskSelection &other);
+    TaskSelection &subtract(const TaskSelection &other);
+
+    [[nodiscard]] bool contains(size_t position) const;
+    [[nodiscard]] size_t count() const;
+    [[nodiscard]] PositionRange positionsView() const;
+
+    /// The selection vector
+    [[nodiscard]] std::vector<uint32_t> positions() const;
+
+    /// Same semantics as Task::shouldBeCleanedUp()
+    static TaskSelection cleanupCandidates(const TaskColumns &columns, std::chrono::system_clock::time_point now);
+
+private:
+    TaskSelection &intersectRange(std::span<const int64_t> values, int64_t fromMs, int64_t toMs);
+
+    const TaskColumns *_columns;
+    std::vector<uint64_t> _words;
+};
+
+namespace ColumnKernels {
+
+/// Clears the bits of @p words whose value isn't in [from, to)
+void intersectRange(std::span<const int64_t> values, int64_t from, int64_t to, std::span<uint64_t> words);
+
+/// Name of the kernel picked for this CPU, for logs and tests
+const char *rangeKernelName();
+
+}
+
+}
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "task_notes.h"
+
+using namespace pointless::core;
+
+TaskNotes::TaskNotes(std::nullopt_t)
+{
+}
+
+TaskNotes::TaskNotes(std::string text)
+    : _text(std::make_shared<const std::string>(std::move(text)))
+{
+}
+
+TaskNotes::TaskNotes(const char *text)
+    : TaskNotes(std::string(text))
+{
+}
+
+bool TaskNotes::has_value() const
+{
+    return _text != nullptr || _state != State::None;
+}
+
+TaskNotes::operator bool() const
+{
+    return has_value();
+}
+
+const std::string &TaskNotes::operator*() const
+{
+    return *text();
+}
+
+const std::string *TaskNotes::operator->() const
+{
+    return text();
+}
+
+bool TaskNotes::hasText() const
+{
+    return state() == State::Text;
+}
+
+bool TaskNotes::operator==(const TaskNotes &other) const
+{
+    if (state() != other.state())
+        return false;
+    if (_text && _text == other._text)
+        return true;
+    if (const auto ref = coldRef(); ref.section != nullptr && ref == other.coldRef())
+        return true;
+    return state() == State::None || *text() == *other.text();
+}
+
+TaskNotes::State TaskNotes::state() const
+{
+    if (_text)
+        return _text->empty() ? State::Empty : State::Text;
+    return _state;
+}
+
+TaskNotes TaskNotes::deferred(State state)
+{
+    TaskNotes notes;
+    notes._state = state <= State::Text ? state : State::None;
+    return notes;
+}
+
+void TaskNotes::setColdSection(const std::shared_ptr<const ColdSection> &section, uint32_t index)
+{
+    _section = section;
+    _index = index;
+}
+
+ColdSection::Ref TaskNotes::coldRef() const
+{
+    if (_text || !_section)
+        return {};
+    return { .section = _section.get(), .index = _index };
+}
+
+const std::string *TaskNotes::text() const
+{
+    if (_text || _state == State::None)
+        return _text.get();
+
+    static const std::string empty;
+    if (_state == State::Empty || !_section)
+        return &empty;
+
+    // The cold section is only decoded here, the first time the notes are shown or compared
+    const auto &description = _section->entry(_index).description;
+    return description ? description.get() : &empty;
+}
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "cold_section.h"
+
+#include <glaze/glaze.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace pointless::core {
+
+/// The notes of a task, kept out of the Task itself: tasks hold a handle to immutable text that
+/// copies share, so copying, filtering and merging tasks doesn't touch the notes.
+/// Reads like std::optional<std::string>, assigning replaces the shared text.
+/// Loaded from a binary snapshot, only whether there are notes is known up front, the text stays
+/// in the snapshot's cold section until it's first read.
+class TaskNotes
+{
+public:
+    /// What a binary snapshot stores next to the task
+    enum class State : uint8_t {
+        None,
+        Empty,
+        Text
+    };
+
+    TaskNotes() = default;
+    TaskNotes(std::nullopt_t); // NOLINT(google-explicit-constructor)
+    TaskNotes(std::string text); // NOLINT(google-explicit-constructor)
+    TaskNotes(const char *text); // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] bool has_value() const; // NOLINT(readability-identifier-naming)
+    explicit operator bool() const;
+
+    const std::string &operator*() const;
+    const std::string *operator->() const;
+
+    /// True if there's text, as opposed to no notes or an empty string
+    [[nodiscard]] bool hasText() const;
+
+    bool operator==(const TaskNotes &other) const;
+
+    [[nodiscard]] State state() const;
+
+    /// Notes whose text is still in a cold section, see setColdSection()
+    static TaskNotes deferred(State state);
+
+    /// Where deferred notes are read from
+    void setColdSection(const std::shared_ptr<const ColdSection> &section, uint32_t index);
+    [[nodiscard]] ColdSection::Ref coldRef() const;
+
+private:
+    [[nodiscard]] const std::string *text() const;
+
+    std::shared_ptr<const std::string> _text;
+
+    // Deferred notes, while _text is unset
+    std::shared_ptr<const ColdSection> _section;
+    uint32_t _index = 0;
+    State _state = State::None;
+};
+
+}
+
+namespace glz {
+
+template<>
+struct from<JSON, pointless::core::TaskNotes>
+{
+    template<auto Opts>
+    static void op(pointless::core::TaskNotes &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::optional<std::string> text;
+        parse<JSON>::op<Opts>(text, ctx, it, end);
+        value = text ? pointless::core::TaskNotes(std::move(*text)) : pointless::core::TaskNotes();
+    }
+};
+
+template<>
+struct to<JSON, pointless::core::TaskNotes>
+{
+    template<auto Opts>
+    static void op(const pointless::core::TaskNotes &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        const std::optional<std::string_view> text = value ? std::optional<std::string_view>(*value) : std::nullopt;
+        serialize<JSON>::op<Opts>(text, ctx, b, ix);
+    }
+};
+
+// A binary snapshot keeps only the state with the task, Data::toBinary() writes the text to its cold section
+template<>
+struct from<BEVE, pointless::core::TaskNotes>
+{
+    template<auto Opts>
+    static void op(pointless::core::TaskNotes &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        uint8_t state = 0;
+        parse<BEVE>::op<Opts>(state, ctx, it, end);
+        value = pointless::core::TaskNotes::deferred(static_cast<pointless::core::TaskNotes::State>(state));
+    }
+};
+
+template<>
+struct to<BEVE, pointless::core::TaskNotes>
+{
+    template<auto Opts>
+    static void op(const pointless::core::TaskNotes &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        const auto state = static_cast<uint8_t>(value.state());
+        serialize<BEVE>::op<Opts>(state, ctx, b, ix);
+    }
+};
+
+}
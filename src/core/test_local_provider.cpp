@@ -2,8 +2,12 @@
 // SPDX-License-Identifier: MIT
 
 #include "test_local_provider.h"
+#include "file_io.h"
 #include "logger.h"
+#include "md5.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -39,17 +43,23 @@ bool TestLocalDataProvider::isAuthenticated()
 
 std::expected<std::string, TraceableError> TestLocalDataProvider::pullData()
 {
+    _documentVersion.clear();
+
     std::ifstream file(_filePath);
     if (!file.is_open()) {
         return TraceableError::create("Failed to open file for reading: " + _filePath);
     }
     std::stringstream buffer;
     buffer << file.rdbuf();
-    return buffer.str();
+    std::string contents = buffer.str();
+    _documentVersion = pointless::core::Md5::hexDigest(contents);
+    return contents;
 }
 
 std::expected<void, TraceableError> TestLocalDataProvider::pushData(const std::string &data)
 {
+    _documentVersion.clear();
+
     std::ofstream file(_filePath);
     if (!file.is_open()) {
         const std::string msg = "Failed to open file for writing: " + _filePath;
@@ -57,6 +67,116 @@ std::expected<void, TraceableError> TestLocalDataProvider::pushData(const std::s
         return TraceableError::create(msg);
     }
     file << data;
+
+    _documentVersion = pointless::core::Md5::hexDigest(data);
+    return {};
+}
+
+std::expected<void, TraceableError> TestLocalDataProvider::pushDocument(const pointless::core::DocumentWriter &writeDocument)
+{
+    _documentVersion.clear();
+
+    std::string version;
+    auto result = pointless::core::writeFileAtomically(_filePath, [&](pointless::core::OutputSink &sink) -> std::expected<void, std::string> {
+        pointless::core::Md5Sink md5(sink);
+        if (auto written = writeDocument(md5); !written) {
+            return written;
+        }
+        version = md5.hexDigest();
+        return {};
+    });
+    if (!result) {
+        P_LOG_ERROR("{}", result.error());
+        return TraceableError::create(result.error());
+    }
+
+    _documentVersion = version;
+    return {};
+}
+
+std::expected<std::string, TraceableError> TestLocalDataProvider::pullDocumentVersion()
+{
+    std::ifstream file(_filePath);
+    if (!file.is_open()) {
+        return std::string();
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return pointless::core::Md5::hexDigest(buffer.str());
+}
+
+std::string TestLocalDataProvider::documentVersion() const
+{
+    return _documentVersion;
+}
+
+std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> TestLocalDataProvider::pullChanges(int sinceRevision)
+{
+    auto changes = readChanges();
+    if (!changes) {
+        return std::unexpected(changes.error());
+    }
+
+    std::erase_if(*changes, [sinceRevision](const auto &change) { return change.revision <= sinceRevision; });
+    std::ranges::sort(*changes, {}, &pointless::core::ChangeSet::revision);
+    return changes;
+}
+
+std::expected<void, TraceableError> TestLocalDataProvider::pushChanges(const pointless::core::ChangeSet &changes)
+{
+    auto existing = readChanges();
+    if (!existing) {
+        return std::unexpected(existing.error());
+    }
+
+    // Like the unique key on the server's table
+    if (std::ranges::find(*existing, changes.revision, &pointless::core::ChangeSet::revision) != existing->end()) {
+        return TraceableError::create("Revision " + std::to_string(changes.revision) + " was pushed by another client");
+    }
+
+    existing->push_back(changes);
+    return writeChanges(*existing);
+}
+
+std::expected<void, TraceableError> TestLocalDataProvider::pruneChanges(int beforeRevision)
+{
+    auto changes = readChanges();
+    if (!changes) {
+        return std::unexpected(changes.error());
+    }
+
+    std::erase_if(*changes, [beforeRevision](const auto &change) { return change.revision < beforeRevision; });
+    return writeChanges(*changes);
+}
+
+std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> TestLocalDataProvider::readChanges() const
+{
+    const std::string path = _filePath + ".changes";
+    if (!std::filesystem::exists(path)) {
+        return std::vector<pointless::core::ChangeSet> {};
+    }
+
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::vector<pointless::core::ChangeSet> changes;
+    if (glz::read_json(changes, buffer.str())) {
+        return TraceableError::create("Failed to parse change log: " + path);
+    }
+    return changes;
+}
+
+std::expected<void, TraceableError> TestLocalDataProvider::writeChanges(const std::vector<pointless::core::ChangeSet> &changes) const
+{
+    auto json = glz::write_json(changes);
+    if (!json) {
+        return TraceableError::create("Failed to serialize change log");
+    }
+
+    if (auto result = pointless::core::writeFileAtomically(_filePath + ".changes", *json); !result) {
+        return TraceableError::create(result.error());
+    }
     return {};
 }
 
@@ -20,6 +20,16 @@ public:
     [[nodiscard]] bool isAuthenticated() override;
     std::expected<std::string, TraceableError> pullData() override;
     std::expected<void, TraceableError> pushData(const std::string &data) override;
+    std::expected<void, TraceableError> pushDocument(const pointless::core::DocumentWriter &writeDocument) override;
+
+    /// The MD5 of the file, so anything that rewrites it changes the version, like on the server
+    std::expected<std::string, TraceableError> pullDocumentVersion() override;
+    [[nodiscard]] std::string documentVersion() const override;
+
+    /// The change log is a JSON array next to the file, so tests can exercise delta sync offline
+    std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> pullChanges(int sinceRevision) override;
+    std::expected<void, TraceableError> pushChanges(const pointless::core::ChangeSet &changes) override;
+    std::expected<void, TraceableError> pruneChanges(int beforeRevision) override;
 
     [[nodiscard]] std::string accessToken() const override;
     [[nodiscard]] std::string refreshToken() const override;
@@ -30,5 +40,9 @@ public:
     bool refreshAccessToken() override;
 
 private:
+    std::expected<std::vector<pointless::core::ChangeSet>, TraceableError> readChanges() const;
+    std::expected<void, TraceableError> writeChanges(const std::vector<pointless::core::ChangeSet> &changes) const;
+
     std::string _filePath;
+    std::string _documentVersion;
 };
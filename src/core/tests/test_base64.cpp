@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "base64.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pointless::core;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t size, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto &byte : bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+std::string encode(std::span<const uint8_t> bytes)
+{
+    std::string encoded(bytes.size() / 3 * 4, '\0');
+    Base64::encodeTriples(bytes, encoded.data());
+    return encoded;
+}
+
+}
+
+TEST(Base64Test, KernelMatchesScalar)
+{
+    // Sizes around every block size, so each kernel's tail goes through the scalar code
+    for (size_t triples = 0; triples < 100; ++triples) {
+        const auto bytes = randomBytes(triples * 3, triples);
+
+        const std::string encoded = encode(bytes);
+        std::string scalarEncoded(encoded.size(), '\0');
+        Base64::encodeTriplesScalar(bytes, scalarEncoded.data());
+        ASSERT_EQ(encoded, scalarEncoded) << "triples=" << triples << " kernel=" << Base64::kernelName();
+
+        std::vector<uint8_t> decoded(bytes.size());
+        ASSERT_FALSE(Base64::decodeQuads(encoded, decoded.data()));
+        ASSERT_EQ(decoded, bytes) << "triples=" << triples << " kernel=" << Base64::kernelName();
+    }
+}
+
+TEST(Base64Test, InvalidCharactersAreReportedWhereTheyAre)
+{
+    const auto bytes = randomBytes(300, 42);
+    const std::string encoded = encode(bytes);
+
+    for (const char bad : { '=', ' ', '\n', '-', '_', '\0', '\x80', '\xff' }) {
+        for (size_t position : { size_t(0), size_t(5), size_t(31), size_t(64), size_t(200), encoded.size() - 1 }) {
+            std::string corrupted = encoded;
+            corrupted[position] = bad;
+
+            std::vector<uint8_t> decoded(bytes.size());
+            const auto invalid = Base64::decodeQuads(corrupted, decoded.data());
+            ASSERT_TRUE(invalid) << "position=" << position << " kernel=" << Base64::kernelName();
+            EXPECT_EQ(*invalid, position) << "kernel=" << Base64::kernelName();
+
+            // Everything before the bad quad is decoded
+            const size_t validBytes = position / 4 * 3;
+            EXPECT_TRUE(std::equal(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(validBytes), decoded.begin()));
+        }
+    }
+}
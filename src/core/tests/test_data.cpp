@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "data.h"
+#include "output_sink.h"
 
 #include <gtest/gtest.h>
 #include <glaze/glaze.hpp>
@@ -55,6 +56,95 @@ TEST(DataTest, SerializeDeserialize)
     EXPECT_EQ(deletedTags[0], "deleted-tag-1");
 }
 
+TEST(DataTest, SerializeDeserializeBinary)
+{
+    Data originalData;
+    originalData.setRevision(42);
+
+    Task task;
+    task.uuid = "task-1";
+    task.title = "Task 1";
+    task.tags.add("tag-1");
+    task.dueDate = std::chrono::system_clock::time_point(std::chrono::milliseconds(1700000000000));
+    originalData.addTask(task);
+
+    Tag tag;
+    tag.name = "tag-1";
+    originalData.addTag(tag);
+    originalData.addDeletedTaskUuid("deleted-task-1");
+
+    auto binaryResult = originalData.toBinary();
+    ASSERT_TRUE(binaryResult.has_value());
+    EXPECT_TRUE(Data::isBinary(*binaryResult));
+    EXPECT_FALSE(Data::isBinary(originalData.toJson().value_or("")));
+
+    auto deserializedResult = Data::fromBinary(*binaryResult);
+    ASSERT_TRUE(deserializedResult.has_value());
+    const Data &deserializedData = deserializedResult.value();
+
+    EXPECT_EQ(deserializedData.revision(), 42);
+    ASSERT_EQ(deserializedData.taskCount(), 1);
+    EXPECT_EQ(deserializedData.taskAt(0).title, "Task 1");
+    EXPECT_EQ(deserializedData.taskAt(0).dueDate, task.dueDate);
+    EXPECT_TRUE(deserializedData.taskAt(0).tags.contains("tag-1"));
+    EXPECT_EQ(deserializedData.tagCount(), 1);
+    ASSERT_EQ(deserializedData.deletedTaskUuids().size(), 1);
+    EXPECT_EQ(deserializedData.deletedTaskUuids()[0], "deleted-task-1");
+
+    // A future format version is rejected instead of misread
+    std::string newerVersion = *binaryResult;
+    newerVersion[4] = 3;
+    EXPECT_FALSE(Data::fromBinary(newerVersion).has_value());
+}
+
+TEST(DataTest, BinarySnapshotDefersNotes)
+{
+    Data original;
+    Task withNotes;
+    withNotes.uuid = "task-1";
+    withNotes.description = "Long notes";
+    withNotes.lastCompletions = std::vector<int> { 1, 2, 3 };
+    original.addTask(withNotes);
+    Task emptyNotes;
+    emptyNotes.uuid = "task-2";
+    emptyNotes.description = "";
+    original.addTask(emptyNotes);
+    Task noNotes;
+    noNotes.uuid = "task-3";
+    original.addTask(noNotes);
+
+    auto binary = original.toBinary();
+    ASSERT_TRUE(binary.has_value());
+    auto loaded = Data::fromBinary(*binary);
+    ASSERT_TRUE(loaded.has_value());
+
+    // Known without decoding the cold section
+    const Task &first = *loaded->taskForUuid("task-1");
+    EXPECT_NE(first.description.coldRef().section, nullptr);
+    EXPECT_TRUE(first.description.hasText());
+    EXPECT_TRUE(loaded->columns().test(TaskColumn::HasNotes, *loaded->indexOfTask("task-1")));
+    EXPECT_TRUE(loaded->taskForUuid("task-2")->description.has_value());
+    EXPECT_FALSE(loaded->taskForUuid("task-2")->description.hasText());
+    EXPECT_FALSE(loaded->taskForUuid("task-3")->description.has_value());
+
+    EXPECT_EQ(*first.description, "Long notes");
+    EXPECT_EQ(first.lastCompletions.values(), (std::vector<int> { 1, 2, 3 }));
+    EXPECT_EQ(loaded->toJson().value_or(""), original.toJson().value_or(""));
+
+    // Saved again, the untouched entries are copied over as they were
+    Task edited = *loaded->taskForUuid("task-2");
+    edited.description = "Edited";
+    loaded->setTask(edited);
+    auto resaved = loaded->toBinary();
+    ASSERT_TRUE(resaved.has_value());
+    auto reloaded = Data::fromBinary(*resaved);
+    ASSERT_TRUE(reloaded.has_value());
+    EXPECT_EQ(*reloaded->taskForUuid("task-1")->description, "Long notes");
+    EXPECT_EQ(reloaded->taskForUuid("task-1")->lastCompletions.values(), (std::vector<int> { 1, 2, 3 }));
+    EXPECT_EQ(*reloaded->taskForUuid("task-2")->description, "Edited");
+    EXPECT_FALSE(reloaded->taskForUuid("task-3")->description.has_value());
+}
+
 TEST(DataTest, FindDuplicateCalendarTaskUuids_NoDuplicates)
 {
     Data data;
@@ -359,3 +449,377 @@ TEST(DataTest, SerializeEmptyDeletedLists)
     EXPECT_TRUE(deserializedData.deletedTaskUuids().empty());
     EXPECT_TRUE(deserializedData.deletedTagNames().empty());
 }
+
+TEST(DataTest, TaskLookupByUuidSurvivesMutations)
+{
+    Data data;
+    for (int i = 0; i < 100; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.title = "Task " + std::to_string(i);
+        data.addTask(task);
+    }
+
+    ASSERT_EQ(data.indexOfTask("task-42"), 42);
+    ASSERT_NE(data.taskForUuid("task-99"), nullptr);
+    EXPECT_EQ(data.taskForUuid("task-99")->title, "Task 99");
+    EXPECT_EQ(data.taskForUuid("nonexistent"), nullptr);
+
+    EXPECT_TRUE(data.removeTask("task-10"));
+    EXPECT_FALSE(data.removeTask("task-10"));
+    EXPECT_EQ(data.taskForUuid("task-10"), nullptr);
+    EXPECT_EQ(data.indexOfTask("task-42"), 41);
+    EXPECT_EQ(data.taskForUuid("task-42")->title, "Task 42");
+
+    Task duplicate;
+    duplicate.uuid = "task-42";
+    duplicate.title = "Duplicate";
+    data.addTask(duplicate);
+    EXPECT_EQ(data.taskCount(), 99);
+    EXPECT_EQ(data.taskForUuid("task-42")->title, "Task 42");
+
+    auto json = data.toJson();
+    ASSERT_TRUE(json.has_value());
+    auto loaded = Data::fromJson(*json);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->indexOfTask("task-42"), 41);
+    EXPECT_EQ(loaded->taskForUuid("task-10"), nullptr);
+
+    data.clearTasks();
+    EXPECT_EQ(data.taskForUuid("task-42"), nullptr);
+    EXPECT_FALSE(data.indexOfTask("task-0").has_value());
+}
+
+TEST(DataTest, TagCountsFollowTaskMutations)
+{
+    Data data;
+    data.addTag(Tag { .name = "work" });
+    data.addTag(Tag { .name = "home" });
+    data.addTag(Tag { .name = "unused" });
+
+    Task first;
+    first.uuid = "task-1";
+    first.tags = { "work" };
+    data.addTask(first);
+
+    Task second;
+    second.uuid = "task-2";
+    second.tags = { "work", "home" };
+    second.isDone = true;
+    second.needsSyncToServer = true;
+    data.addTask(second);
+
+    EXPECT_EQ(data.taskCountForTag("work"), 2);
+    EXPECT_EQ(data.visibleTaskCountForTag("work"), 2);
+    EXPECT_EQ(data.taskCountForTag("unused"), 0);
+    EXPECT_EQ(data.getTasksByTag("home").size(), 1);
+    EXPECT_EQ(data.getUsedTags().size(), 2);
+    EXPECT_EQ(data.getUnusedTags().size(), 1);
+
+    data.clearServerSyncBits();
+    EXPECT_EQ(data.taskCountForTag("work"), 2);
+    EXPECT_EQ(data.visibleTaskCountForTag("work"), 1);
+
+    first.tags = { "home" };
+    EXPECT_TRUE(data.updateTask(first, false));
+    EXPECT_EQ(data.taskCountForTag("work"), 1);
+    EXPECT_EQ(data.taskCountForTag("home"), 2);
+    EXPECT_EQ(data.visibleTaskCountForTag("home"), 1);
+
+    EXPECT_TRUE(data.renameTag("home", "house"));
+    EXPECT_EQ(data.taskCountForTag("home"), 0);
+    EXPECT_EQ(data.taskCountForTag("house"), 2);
+    EXPECT_EQ(data.getTasksByTag("house").size(), 2);
+
+    // Any goal flag hides a task from the visible count, as it always did
+    Task goal;
+    goal.uuid = "task-3";
+    goal.tags = { "work" };
+    goal.isGoal = false;
+    data.addTask(goal);
+    EXPECT_EQ(data.taskCountForTag("work"), 2);
+    EXPECT_EQ(data.visibleTaskCountForTag("work"), 0);
+
+    EXPECT_TRUE(data.removeTask("task-1"));
+    EXPECT_EQ(data.taskCountForTag("house"), 1);
+    EXPECT_EQ(data.getTasksByTag("house").front().uuid, "task-2");
+
+    data.removeUnusedTags();
+    EXPECT_FALSE(data.containsTag("unused"));
+    EXPECT_TRUE(data.containsTag("house"));
+}
+
+TEST(DataTest, QueryViewsDontCopy)
+{
+    Data data;
+
+    Task parent;
+    parent.uuid = "parent";
+    parent.isImportant = true;
+    parent.tags = { "work" };
+    data.addTask(parent);
+
+    Task child;
+    child.uuid = "child";
+    child.parentUuid = "parent";
+    child.isDone = true;
+    child.revision = 1;
+    child.needsSyncToServer = true;
+    child.uuidInDeviceCalendar = "event-1";
+    data.addTask(child);
+
+    EXPECT_EQ(data.tasks().size(), 2);
+    EXPECT_EQ(&data.tasks().front(), &data.taskAt(0));
+
+    EXPECT_EQ(std::ranges::distance(data.completedTasksView()), 1);
+    EXPECT_EQ(data.completedTasksView().front().uuid, "child");
+    EXPECT_EQ(data.pendingTasksView().front().uuid, "parent");
+    EXPECT_EQ(data.importantTasksView().front().uuid, "parent");
+    EXPECT_EQ(&data.tasksByParentView("parent").front(), data.taskForUuid("child"));
+    EXPECT_TRUE(data.tasksByParentView("child").empty());
+    EXPECT_EQ(&data.tasksByTagView("work").front(), data.taskForUuid("parent"));
+    EXPECT_TRUE(data.tasksByTagView("home").empty());
+    EXPECT_EQ(data.newTasksView().front().uuid, "parent");
+    EXPECT_EQ(data.modifiedTasksView().front().uuid, "child");
+    EXPECT_EQ(data.newTasks().size(), 1);
+    EXPECT_EQ(data.modifiedTasks().size(), 1);
+
+    EXPECT_EQ(data.taskForUuidInDeviceCalendar("event-1"), data.taskForUuid("child"));
+    EXPECT_EQ(data.taskForUuidInDeviceCalendar("event-2"), nullptr);
+}
+
+TEST(DataTest, DueDateRangeQueries)
+{
+    const auto now = std::chrono::system_clock::now();
+    const auto hours = [now](int h) { return now + std::chrono::hours(h); };
+
+    Data data;
+    for (int i = 0; i < 6; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        if (i != 5)
+            task.dueDate = hours(48 - (i * 24)); // 48h, 24h, now, -24h, -48h, none
+        task.isDone = i == 4;
+        data.addTask(task);
+    }
+
+    const auto uuidsOf = [](auto &&view) {
+        std::vector<Uuid> result;
+        for (const Task &task : view) {
+            result.push_back(task.uuid);
+        }
+        return result;
+    };
+
+    EXPECT_EQ(uuidsOf(data.tasksDueBetweenView(hours(-1), hours(49))), (std::vector<Uuid> { "task-2", "task-1", "task-0" }));
+    EXPECT_EQ(uuidsOf(data.tasksDueBetweenView(hours(-48), now)), (std::vector<Uuid> { "task-4", "task-3" }));
+    EXPECT_TRUE(uuidsOf(data.tasksDueBetweenView(hours(1), hours(1))).empty());
+    EXPECT_EQ(uuidsOf(data.overdueTasksView(now)), (std::vector<Uuid> { "task-3" }));
+
+    Task moved = *data.taskForUuid("task-0");
+    moved.dueDate = hours(-72);
+    data.updateTask(moved, false);
+    Task cleared = *data.taskForUuid("task-1");
+    cleared.dueDate.reset();
+    data.updateTask(cleared, false);
+    EXPECT_EQ(uuidsOf(data.overdueTasksView(now)), (std::vector<Uuid> { "task-0", "task-3" }));
+    EXPECT_EQ(uuidsOf(data.tasksDueBetweenView(hours(-1), hours(49))), (std::vector<Uuid> { "task-2" }));
+
+    data.removeTask("task-3");
+    EXPECT_EQ(uuidsOf(data.overdueTasksView(now)), (std::vector<Uuid> { "task-0" }));
+    EXPECT_EQ(data.selectDueBetween(hours(-100), hours(100)).count(), 3);
+}
+
+TEST(DataTest, DeferredDueDateIndexUpdates)
+{
+    const auto now = std::chrono::system_clock::now();
+    const auto hours = [now](int h) { return now + std::chrono::hours(h); };
+
+    Data data;
+    Task existing;
+    existing.uuid = "existing";
+    existing.dueDate = hours(2);
+    data.addTask(existing);
+
+    data.deferIndexUpdates();
+    for (int i = 0; i < 3; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.dueDate = hours(3 - i);
+        data.addTask(task);
+    }
+    Task moved = *data.taskForUuid("task-0");
+    moved.dueDate = hours(-1);
+    data.setTask(moved);
+
+    // Not sorted in yet, but a copy is
+    EXPECT_EQ(data.selectDueBetween(hours(-10), hours(10)).count(), 1);
+    const Data copy = data;
+    EXPECT_EQ(copy.selectDueBetween(hours(-10), hours(10)).count(), 4);
+
+    data.flushIndexUpdates();
+    EXPECT_FALSE(data.isDeferringIndexUpdates());
+    std::vector<Uuid> ordered;
+    for (const Task &task : data.tasksDueBetweenView(hours(-10), hours(10))) {
+        ordered.push_back(task.uuid);
+    }
+    EXPECT_EQ(ordered, (std::vector<Uuid> { "task-0", "task-2", "existing", "task-1" }));
+}
+
+TEST(DataTest, DirtySetFollowsMutations)
+{
+    const auto uuidsOf = [](auto &&view) {
+        std::vector<Uuid> result;
+        for (const Task &task : view) {
+            result.push_back(task.uuid);
+        }
+        return result;
+    };
+
+    Data data;
+    for (int i = 0; i < 4; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.revision = i == 0 ? -1 : 1;
+        task.tags.add("work");
+        data.addTask(task);
+    }
+
+    EXPECT_EQ(data.newTaskCount(), 1);
+    EXPECT_EQ(data.modifiedTaskCount(), 0);
+    EXPECT_EQ(data.pendingChangeCount(), 1);
+
+    Task edited = *data.taskForUuid("task-2");
+    edited.needsSyncToServer = true;
+    data.updateTask(edited, false);
+    EXPECT_EQ(uuidsOf(data.modifiedTasksView()), (std::vector<Uuid> { "task-2" }));
+    EXPECT_EQ(data.pendingChangeCount(), 2);
+
+    Tag tag;
+    tag.name = "work";
+    data.addTag(tag);
+    EXPECT_TRUE(data.renameTag("work", "job"));
+    EXPECT_EQ(uuidsOf(data.modifiedTasksView()), (std::vector<Uuid> { "task-0", "task-1", "task-2", "task-3" }));
+    EXPECT_EQ(uuidsOf(data.newTasksView()), (std::vector<Uuid> { "task-0" }));
+    EXPECT_EQ(data.modifiedTaskCount(), 4);
+
+    data.removeTask("task-1");
+    data.addDeletedTaskUuid("task-1");
+    EXPECT_EQ(uuidsOf(data.modifiedTasksView()), (std::vector<Uuid> { "task-0", "task-2", "task-3" }));
+    EXPECT_EQ(data.pendingChangeCount(), 5); // 3 tasks, the deleted task and the renamed tag
+
+    data.clearServerSyncBits();
+    EXPECT_EQ(data.newTaskCount(), 0);
+    EXPECT_EQ(data.modifiedTaskCount(), 0);
+    EXPECT_TRUE(uuidsOf(data.modifiedTasksView()).empty());
+    EXPECT_EQ(data.taskForUuid("task-0")->revision, 0);
+    EXPECT_EQ(data.taskCountForTag("job"), 3);
+}
+
+TEST(DataTest, NotesAreSharedBetweenCopies)
+{
+    Task task;
+    task.uuid = "task-1";
+    task.description = "Long notes";
+
+    Task copy = task;
+    EXPECT_EQ(&*copy.description, &*task.description);
+    EXPECT_EQ(copy, task);
+
+    copy.description = "Changed";
+    EXPECT_EQ(*task.description, "Long notes");
+    EXPECT_NE(copy, task);
+
+    Data data;
+    data.addTask(task);
+    Task empty;
+    empty.uuid = "task-2";
+    empty.description = "";
+    data.addTask(empty);
+
+    EXPECT_TRUE(data.columns().test(TaskColumn::HasNotes, 0));
+    EXPECT_FALSE(data.columns().test(TaskColumn::HasNotes, 1));
+
+    task.description = std::nullopt;
+    data.updateTask(task, false);
+    EXPECT_FALSE(data.taskAt(0).description.has_value());
+    EXPECT_FALSE(data.columns().test(TaskColumn::HasNotes, 0));
+}
+
+TEST(DataTest, StreamedJsonMatchesToJson)
+{
+    Data data;
+    data.setRevision(7);
+    for (int i = 0; i < 200; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.title = "Task " + std::to_string(i);
+        task.addTag(i % 2 == 0 ? "work" : "home");
+        data.addTask(task);
+    }
+
+    Tag tag;
+    tag.name = "work";
+    data.addTag(tag);
+    data.addDeletedTaskUuid("deleted-task-1");
+    data.addDeletedTagName("deleted-tag-1");
+
+    class ChunkRecorder : public OutputSink
+    {
+    public:
+        std::expected<void, std::string> write(std::string_view bytes) override
+        {
+            largestChunk = std::max(largestChunk, bytes.size());
+            ++chunks;
+            contents.append(bytes);
+            return {};
+        }
+
+        std::string contents;
+        size_t largestChunk = 0;
+        size_t chunks = 0;
+    };
+
+    constexpr size_t ChunkSize = 512;
+    ChunkRecorder sink;
+    ASSERT_TRUE(data.writeJson(sink, ChunkSize));
+
+    auto json = data.toJson();
+    ASSERT_TRUE(json.has_value());
+    EXPECT_EQ(sink.contents, *json);
+    EXPECT_GT(sink.chunks, 1);
+
+    // A chunk overshoots by at most one task
+    EXPECT_LT(sink.largestChunk, ChunkSize + 512);
+}
+
+TEST(DataTest, ParallelParseMatchesSequential)
+{
+    Data data;
+    data.setRevision(11);
+    for (int i = 0; i < 5000; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.title = "Task \"" + std::to_string(i) + "\", with [brackets]";
+        task.addTag(i % 3 == 0 ? "work" : "home");
+        data.addTask(task);
+    }
+    data.addDeletedTaskUuid("deleted-task-1");
+
+    auto json = data.toJson();
+    ASSERT_TRUE(json.has_value());
+
+    auto parallel = Data::fromJsonInParallel(*json, 4);
+    ASSERT_TRUE(parallel.has_value());
+    EXPECT_EQ(parallel->taskCount(), data.taskCount());
+    EXPECT_EQ(parallel->revision(), 11);
+    EXPECT_EQ(parallel->toJson(), json);
+    ASSERT_NE(parallel->taskForUuid("task-4999"), nullptr);
+
+    // Errors come from the single-threaded parse, with the same message
+    std::string invalid = *json;
+    invalid.replace(invalid.find(R"("title")"), 7, R"("bogus")");
+    auto parallelError = Data::fromJsonInParallel(invalid, 4);
+    ASSERT_FALSE(parallelError.has_value());
+    EXPECT_EQ(parallelError.error(), Data::fromJsonInParallel(invalid, 1).error());
+}
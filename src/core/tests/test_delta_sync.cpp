@@ -0,0 +1,488 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "delta_sync.h"
+#include "md5.h"
+#include "supabase.h"
+#include "test_local_provider.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace pointless::core;
+
+namespace {
+
+Task createTask(const std::string &uuid, int revision)
+{
+    Task task;
+    task.uuid = uuid;
+    task.title = "Task " + uuid;
+    task.revision = revision;
+    return task;
+}
+
+/// What a server at revision 3 and a client that synced with it both have
+Data syncedData()
+{
+    Data data;
+    data.addTask(createTask("delta-1", 1));
+    data.addTask(createTask("delta-2", 3));
+    data.addTag(Tag { .revision = 0, .name = "work" });
+    data.setRevision(3);
+    return data;
+}
+
+ChangeSet changeAt(int revision)
+{
+    ChangeSet changes;
+    changes.revision = revision;
+    return changes;
+}
+
+std::string freshPath(const std::string &name)
+{
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".changes");
+    return path.string();
+}
+
+/// Just enough of PostgREST's Changes and Documents tables and GoTrue's /user for SupabaseProvider,
+/// one request per connection
+class PostgrestStandIn
+{
+public:
+    PostgrestStandIn()
+    {
+        _socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)); // NOLINT
+        ::listen(_socket, 8);
+
+        socklen_t length = sizeof(address);
+        ::getsockname(_socket, reinterpret_cast<sockaddr *>(&address), &length); // NOLINT
+        _port = ntohs(address.sin_port);
+
+        _thread = std::thread([this] { serve(); });
+    }
+
+    ~PostgrestStandIn()
+    {
+        ::shutdown(_socket, SHUT_RDWR);
+        ::close(_socket);
+        _thread.join();
+    }
+
+    PostgrestStandIn(const PostgrestStandIn &) = delete;
+    PostgrestStandIn &operator=(const PostgrestStandIn &) = delete;
+
+    [[nodiscard]] std::string baseUrl() const
+    {
+        return "http://127.0.0.1:" + std::to_string(_port);
+    }
+
+    [[nodiscard]] size_t rowCount()
+    {
+        const std::scoped_lock lock(_mutex);
+        return _rows.size();
+    }
+
+    /// Like a push by a client that doesn't know about data_md5
+    void setDocumentData(const std::string &data)
+    {
+        const std::scoped_lock lock(_mutex);
+        _documentData = data;
+    }
+
+    /// A server the migration wasn't applied to
+    void dropVersionColumn()
+    {
+        const std::scoped_lock lock(_mutex);
+        _hasVersionColumn = false;
+    }
+
+private:
+    struct Row
+    {
+        int revision = -1;
+        ChangeSet data;
+    };
+
+    struct Request
+    {
+        std::string method;
+        std::string target;
+        std::string body;
+    };
+
+    void serve()
+    {
+        while (true) {
+            const int connection = ::accept(_socket, nullptr, nullptr);
+            if (connection < 0)
+                return;
+
+            if (auto request = readRequest(connection)) {
+                const std::string response = handle(*request);
+                ::send(connection, response.data(), response.size(), MSG_NOSIGNAL);
+            }
+            ::close(connection);
+        }
+    }
+
+    static std::optional<Request> readRequest(int connection)
+    {
+        std::string buffer;
+        std::array<char, 4096> chunk {};
+        size_t headerEnd = std::string::npos;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            const ssize_t length = ::recv(connection, chunk.data(), chunk.size(), 0);
+            if (length <= 0)
+                return std::nullopt;
+            buffer.append(chunk.data(), static_cast<size_t>(length));
+        }
+
+        Request request;
+        const size_t methodEnd = buffer.find(' ');
+        request.method = buffer.substr(0, methodEnd);
+        request.target = buffer.substr(methodEnd + 1, buffer.find(' ', methodEnd + 1) - methodEnd - 1);
+
+        size_t contentLength = 0;
+        std::string headers = buffer.substr(0, headerEnd);
+        std::ranges::transform(headers, headers.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (const size_t pos = headers.find("content-length:"); pos != std::string::npos)
+            contentLength = std::stoul(headers.substr(pos + 15));
+
+        request.body = buffer.substr(headerEnd + 4);
+        while (request.body.size() < contentLength) {
+            const ssize_t length = ::recv(connection, chunk.data(), chunk.size(), 0);
+            if (length <= 0)
+                return std::nullopt;
+            request.body.append(chunk.data(), static_cast<size_t>(length));
+        }
+        return request;
+    }
+
+    /// The value of a PostgREST filter such as revision=gt.3
+    static int filterValue(const std::string &target, const std::string &filter)
+    {
+        const size_t pos = target.find(filter);
+        return pos == std::string::npos ? 0 : std::stoi(target.substr(pos + filter.size()));
+    }
+
+    std::string handle(const Request &request)
+    {
+        if (request.target.starts_with("/auth/v1/user"))
+            return reply(200, R"({"id":"stand-in"})");
+
+        const std::scoped_lock lock(_mutex);
+        if (request.target.starts_with("/rest/v1/Documents"))
+            return handleDocument(request);
+
+        if (!request.target.starts_with("/rest/v1/Changes"))
+            return reply(404, "{}");
+
+        if (request.method == "GET") {
+            const int since = filterValue(request.target, "revision=gt.");
+            std::vector<Row> rows;
+            for (const auto &[revision, data] : _rows) {
+                if (revision > since)
+                    rows.push_back({ .revision = revision, .data = data });
+            }
+            return reply(200, glz::write_json(rows).value_or("[]"));
+        }
+
+        if (request.method == "POST") {
+            Row row;
+            if (glz::read_json(row, request.body))
+                return reply(400, "{}");
+            // The primary key
+            if (!_rows.try_emplace(row.revision, row.data).second)
+                return reply(409, R"({"code":"23505"})");
+            return reply(201, "");
+        }
+
+        if (request.method == "DELETE") {
+            const int before = filterValue(request.target, "revision=lt.");
+            std::erase_if(_rows, [before](const auto &entry) { return entry.first < before; });
+            return reply(204, "");
+        }
+
+        return reply(405, "{}");
+    }
+
+    /// The data is kept as pushed, base64 has nothing to escape. data_md5 is generated from it
+    std::string handleDocument(const Request &request)
+    {
+        if (request.method == "GET" && request.target.find("select=data_md5") != std::string::npos) {
+            if (!_hasVersionColumn)
+                return reply(400, R"({"code":"42703"})");
+            if (_documentData.empty())
+                return reply(200, "[]");
+            return reply(200, R"([{"data_md5":")" + Md5::hexDigest(_documentData) + R"("}])");
+        }
+
+        if (request.method == "GET") {
+            return reply(200, R"([{"data":")" + _documentData + R"("}])");
+        }
+
+        if (request.method == "POST") {
+            // PostgREST rejects columns the table doesn't have, the generated one can't be written either
+            if (request.body.find(R"("data_md5")") != std::string::npos || request.body.find(R"("revision")") != std::string::npos)
+                return reply(400, R"({"code":"PGRST204"})");
+
+            const size_t dataBegin = request.body.find(R"("data":")") + 8;
+            _documentData = request.body.substr(dataBegin, request.body.find('"', dataBegin) - dataBegin);
+            return reply(201, "");
+        }
+
+        return reply(405, "{}");
+    }
+
+    static std::string reply(int status, const std::string &body)
+    {
+        return "HTTP/1.1 " + std::to_string(status) + " Stand-in\r\nContent-Type: application/json\r\nContent-Length: "
+            + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    }
+
+    int _socket = -1;
+    uint16_t _port = 0;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::map<int, ChangeSet> _rows;
+    std::string _documentData;
+    bool _hasVersionColumn = true;
+};
+
+}
+
+TEST(DeltaSyncTest, ServerViewLeavesOutWhatWasNeverPushed)
+{
+    Data local = syncedData();
+    local.addTask(createTask("delta-new", -1));
+    local.addTag(Tag { .revision = -1, .name = "new" });
+    local.removeTasks(std::vector<Uuid> { Uuid("delta-1") });
+    local.addDeletedTaskUuid(Uuid("delta-1"));
+
+    const Data view = serverViewOf(local);
+    EXPECT_EQ(view.revision(), 3);
+    EXPECT_EQ(view.taskForUuid(Uuid("delta-new")), nullptr);
+    EXPECT_NE(view.taskForUuid(Uuid("delta-2")), nullptr);
+    EXPECT_FALSE(view.containsTag("new"));
+    EXPECT_TRUE(view.containsTag("work"));
+    EXPECT_TRUE(view.deletedTaskUuids().empty());
+    EXPECT_NE(view.taskForUuid(Uuid("delta-1")), nullptr) << "so the merge uploads the deletion";
+}
+
+TEST(DeltaSyncTest, ChangeSetsApplyInRevisionOrder)
+{
+    Data data = syncedData();
+
+    ChangeSet first = changeAt(4);
+    first.tasks.push_back(createTask("delta-3", 0));
+    Task modified = createTask("delta-2", 4);
+    modified.title = "Renamed";
+    first.tasks.push_back(modified);
+
+    ChangeSet second = changeAt(5);
+    second.deletedTaskUuids.push_back(Uuid("delta-1"));
+    second.tags.push_back(Tag { .revision = 0, .name = "home" });
+    second.deletedTagNames.emplace_back("work");
+
+    const std::vector<ChangeSet> changes = { first, second };
+    ASSERT_TRUE(applyChangeSets(data, changes));
+
+    EXPECT_EQ(data.revision(), 5);
+    EXPECT_EQ(data.taskCount(), 2U);
+    EXPECT_EQ(data.taskForUuid(Uuid("delta-1")), nullptr);
+    ASSERT_NE(data.taskForUuid(Uuid("delta-2")), nullptr);
+    EXPECT_EQ(data.taskForUuid(Uuid("delta-2"))->title, "Renamed");
+    EXPECT_TRUE(data.containsTag("home"));
+    EXPECT_FALSE(data.containsTag("work"));
+}
+
+TEST(DeltaSyncTest, GapsAndSnapshotsNeedTheWholeDocument)
+{
+    Data data = syncedData();
+    const std::vector<ChangeSet> gap = { changeAt(5) };
+    EXPECT_FALSE(applyChangeSets(data, gap));
+
+    ChangeSet snapshot = changeAt(4);
+    snapshot.snapshot = true;
+    const std::vector<ChangeSet> compacted = { snapshot };
+    EXPECT_FALSE(applyChangeSets(data, compacted));
+    EXPECT_EQ(data.revision(), 3);
+}
+
+TEST(DeltaSyncTest, ChangeSetHasOnlyWhatChanged)
+{
+    const Data remote = syncedData();
+
+    Data local = syncedData();
+    local.addTask(createTask("delta-new", -1));
+    local.removeTasks(std::vector<Uuid> { Uuid("delta-1") });
+    local.addDeletedTaskUuid(Uuid("delta-1"));
+
+    Data merged = remote;
+    merged.addTask(createTask("delta-new", 0));
+    merged.removeTasks(std::vector<Uuid> { Uuid("delta-1") });
+
+    const ChangeSet changes = changeSetBetween(remote, merged, local);
+    ASSERT_EQ(changes.tasks.size(), 1U);
+    EXPECT_EQ(changes.tasks.front().uuid, Uuid("delta-new"));
+    EXPECT_EQ(changes.deletedTaskUuids, std::vector<Uuid> { Uuid("delta-1") });
+    EXPECT_TRUE(changes.tags.empty());
+    EXPECT_TRUE(changes.deletedTagNames.empty());
+
+    EXPECT_TRUE(changeSetBetween(remote, remote, remote).isEmpty());
+}
+
+TEST(DeltaSyncTest, LocalProviderKeepsAChangeLog)
+{
+    TestLocalDataProvider provider(freshPath("pointless_test_delta_sync.json"));
+
+    ChangeSet changes = changeAt(4);
+    changes.tasks.push_back(createTask("delta-3", 0));
+    ASSERT_TRUE(provider.pushChanges(changes));
+    ASSERT_TRUE(provider.pushChanges(changeAt(5)));
+    EXPECT_FALSE(provider.pushChanges(changeAt(5))) << "a revision is pushed once";
+
+    auto pulled = provider.pullChanges(4);
+    ASSERT_TRUE(pulled);
+    ASSERT_EQ(pulled->size(), 1U);
+    EXPECT_EQ(pulled->front().revision, 5);
+
+    ASSERT_TRUE(provider.pruneChanges(5));
+    pulled = provider.pullChanges(0);
+    ASSERT_TRUE(pulled);
+    ASSERT_EQ(pulled->size(), 1U);
+}
+
+TEST(DeltaSyncTest, SupabaseProviderAgainstPostgrestStandIn)
+{
+    PostgrestStandIn server;
+    SupabaseProvider provider(server.baseUrl(), "anon");
+    provider.setAccessToken("token");
+
+    ChangeSet changes = changeAt(4);
+    changes.tasks.push_back(createTask("delta-3", 0));
+    changes.deletedTaskUuids.push_back(Uuid("delta-1"));
+    ASSERT_TRUE(provider.pushChanges(changes));
+    ASSERT_TRUE(provider.pushChanges(changeAt(5)));
+
+    auto conflict = provider.pushChanges(changeAt(5));
+    ASSERT_FALSE(conflict);
+
+    auto pulled = provider.pullChanges(3);
+    ASSERT_TRUE(pulled);
+    ASSERT_EQ(pulled->size(), 2U);
+    EXPECT_EQ(pulled->front().revision, 4);
+    ASSERT_EQ(pulled->front().tasks.size(), 1U);
+    EXPECT_EQ(pulled->front().tasks.front().uuid, Uuid("delta-3"));
+
+    Data data = syncedData();
+    ASSERT_TRUE(applyChangeSets(data, *pulled));
+    EXPECT_EQ(data.revision(), 5);
+    EXPECT_EQ(data.taskForUuid(Uuid("delta-1")), nullptr);
+
+    ASSERT_TRUE(provider.pruneChanges(5));
+    EXPECT_EQ(server.rowCount(), 1U);
+}
+
+TEST(DeltaSyncTest, DocumentVersionFollowsTheData)
+{
+    PostgrestStandIn server;
+    SupabaseProvider provider(server.baseUrl(), "anon");
+    provider.setAccessToken("token");
+
+    auto version = provider.pullDocumentVersion();
+    ASSERT_TRUE(version);
+    EXPECT_TRUE(version->empty()) << "nothing pushed yet";
+
+    const Data data = syncedData();
+    ASSERT_TRUE(provider.pushDocument([&data](OutputSink &sink) { return data.writeJson(sink); }));
+    const std::string pushed = provider.documentVersion();
+    EXPECT_FALSE(pushed.empty());
+    version = provider.pullDocumentVersion();
+    ASSERT_TRUE(version);
+    EXPECT_EQ(*version, pushed);
+
+    ASSERT_TRUE(provider.pullData());
+    EXPECT_EQ(provider.documentVersion(), pushed);
+
+    // Another client's push changes it, even though it knows nothing about versions
+    server.setDocumentData("H4sIAAAAAAAAA6uuBQBDv6ajAgAAAA==");
+    version = provider.pullDocumentVersion();
+    ASSERT_TRUE(version);
+    EXPECT_NE(*version, pushed);
+
+    ASSERT_TRUE(provider.pullData());
+    EXPECT_EQ(provider.documentVersion(), *version);
+}
+
+TEST(DeltaSyncTest, DocumentSyncWorksWithoutTheVersionColumn)
+{
+    PostgrestStandIn server;
+    server.dropVersionColumn();
+    SupabaseProvider provider(server.baseUrl(), "anon");
+    provider.setAccessToken("token");
+
+    const Data data = syncedData();
+    ASSERT_TRUE(provider.pushDocument([&data](OutputSink &sink) { return data.writeJson(sink); }));
+    ASSERT_TRUE(provider.pushData("{}"));
+    EXPECT_FALSE(provider.pullDocumentVersion()) << "so the document is pulled instead";
+
+    auto pulled = provider.pullData();
+    ASSERT_TRUE(pulled);
+    EXPECT_EQ(*pulled, "{}");
+}
+
+TEST(DeltaSyncTest, LocalProviderVersionFollowsTheFile)
+{
+    const std::string path = freshPath("pointless_test_document_version.json");
+    TestLocalDataProvider provider(path);
+
+    EXPECT_EQ(provider.pullDocumentVersion().value_or("x"), "");
+
+    const Data data = syncedData();
+    ASSERT_TRUE(provider.pushDocument([&data](OutputSink &sink) { return data.writeJson(sink); }));
+    const std::string pushed = provider.documentVersion();
+    EXPECT_EQ(provider.pullDocumentVersion().value_or(""), pushed);
+
+    TestLocalDataProvider otherClient(path);
+    ASSERT_TRUE(otherClient.pushData("{}"));
+    EXPECT_NE(provider.pullDocumentVersion().value_or(pushed), pushed);
+}
+
+TEST(DeltaSyncTest, DocumentIsDecodedAsItDownloads)
+{
+    PostgrestStandIn server;
+    SupabaseProvider provider(server.baseUrl(), "anon");
+    provider.setAccessToken("token");
+
+    std::string document;
+    for (int i = 0; i < 20000; ++i) {
+        document += "{\"title\":\"task " + std::to_string(i) + "\"},";
+    }
+    ASSERT_TRUE(provider.pushData(document));
+
+    auto pulled = provider.pullData();
+    ASSERT_TRUE(pulled);
+    EXPECT_EQ(*pulled, document);
+}
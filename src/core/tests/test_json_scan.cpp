@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "json_scan.h"
+
+#include <gtest/gtest.h>
+
+using namespace pointless::core;
+
+TEST(JsonScanTest, SplitsTheArrayAtElementBoundaries)
+{
+    const std::string_view json = R"( { "revision": 3, "tags": [{"name":"a]"}],
+        "tasks" : [ {"title":"with \"quotes\", commas and ] brackets","tags":["x","y"]} ,
+                    {"nested":{"a":[1,2,{"b":"}"}]}}, 42, null ],
+        "deletedTagNames": [] } )";
+
+    const auto layout = findTopLevelArray(json, "tasks");
+    ASSERT_TRUE(layout.has_value());
+    EXPECT_EQ(json[layout->begin], '[');
+    EXPECT_EQ(json[layout->end - 1], ']');
+
+    ASSERT_EQ(layout->elements.size(), 4);
+    EXPECT_EQ(layout->elements[0], R"({"title":"with \"quotes\", commas and ] brackets","tags":["x","y"]})");
+    EXPECT_EQ(layout->elements[1], R"({"nested":{"a":[1,2,{"b":"}"}]}})");
+    EXPECT_EQ(layout->elements[2], "42");
+    EXPECT_EQ(layout->elements[3], "null");
+}
+
+TEST(JsonScanTest, EmptyArray)
+{
+    const auto layout = findTopLevelArray(R"({"tasks":[ ]})", "tasks");
+    ASSERT_TRUE(layout.has_value());
+    EXPECT_TRUE(layout->elements.empty());
+}
+
+TEST(JsonScanTest, RejectsWhatItCantSplitSafely)
+{
+    EXPECT_FALSE(findTopLevelArray(R"({"tags":[]})", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"({"tasks":[],"tasks":[]})", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"({"t\u0061sks":[]})", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"({"tasks":{}})", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"({"tasks":[{"a":1}, )", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"([{"tasks":[]}])", "tasks"));
+    EXPECT_FALSE(findTopLevelArray(R"({"tasks":[1 2]})", "tasks"));
+}
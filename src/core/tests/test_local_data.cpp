@@ -4,13 +4,57 @@
 #include "local_data.h"
 #include "data.h"
 #include "context.h"
+#include "file_io.h"
+#include "sqlite_store.h"
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
 
 using namespace pointless::core;
 
+namespace {
+
+/// A directory of its own for the running test, so tests can run in parallel. Removed when the
+/// test ends, whether it passed or not
+class TempDir
+{
+public:
+    TempDir()
+    {
+        const std::string prefix = std::string("pointless_test_") + testing::UnitTest::GetInstance()->current_test_info()->name() + "_";
+        std::random_device random;
+        do {
+            _path = std::filesystem::temp_directory_path() / (prefix + std::to_string(random()));
+        } while (!std::filesystem::create_directory(_path));
+    }
+
+    ~TempDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(_path, ec);
+    }
+
+    TempDir(const TempDir &) = delete;
+    TempDir &operator=(const TempDir &) = delete;
+    TempDir(TempDir &&) = delete;
+    TempDir &operator=(TempDir &&) = delete;
+
+    std::filesystem::path operator/(const std::string &name) const
+    {
+        return _path / name;
+    }
+
+private:
+    std::filesystem::path _path;
+};
+
+}
+
 TEST(LocalDataTest, LoadExistingFile)
 {
     Context::setContext(Context(IDataProvider::Type::TestsLocal, "/tmp/pointless.json"));
@@ -82,10 +126,10 @@ TEST(LocalDataTest, ClearServerSyncBits)
     tag.revision = -1;
     tag.needsSyncToServer = true;
     data.addTag(tag);
+    data.addDeletedTagName("deletedTag1");
+    data.addDeletedTaskUuid("deletedTask1");
 
     localData.setData(data);
-    localData.data().addDeletedTagName("deletedTag1");
-    localData.data().addDeletedTaskUuid("deletedTask1");
 
     localData.clearServerSyncBits();
 
@@ -156,3 +200,484 @@ TEST(LocalDataTest, SaveData)
     // Cleanup
     std::filesystem::remove_all(tempDir);
 }
+
+TEST(LocalDataTest, EditsDuringRebaseAreReplayed)
+{
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, "/tmp/pointless.json"));
+    LocalData localData;
+
+    Data initial;
+    for (const auto *uuid : { "task-1", "task-2", "task-3" }) {
+        Task task;
+        task.uuid = uuid;
+        task.title = "Original";
+        task.revision = 1;
+        initial.addTask(task);
+    }
+    localData.setData(initial);
+
+    auto base = localData.beginRebase();
+    EXPECT_EQ(base, localData.snapshot());
+
+    for (const auto *uuid : { "task-1", "task-2" }) {
+        Task edited = *localData.taskForUuid(uuid);
+        edited.title = "Edited";
+        ASSERT_TRUE(localData.updateTask(edited));
+    }
+    ASSERT_TRUE(localData.removeTask("task-3"));
+    Task added;
+    added.uuid = "task-4";
+    ASSERT_TRUE(localData.addTask(added));
+
+    EXPECT_NE(base, localData.snapshot());
+    EXPECT_EQ(base->taskForUuid("task-1")->title, "Original");
+    EXPECT_NE(base->taskForUuid("task-3"), nullptr);
+
+    // task-1 only had its revision bumped by the sync, task-2 was changed remotely
+    Data merged = *base;
+    Task task1 = *merged.taskForUuid("task-1");
+    task1.revision = 2;
+    merged.setTask(task1);
+    Task task2 = *merged.taskForUuid("task-2");
+    task2.revision = 2;
+    task2.title = "Remote";
+    merged.setTask(task2);
+    merged.setRevision(7);
+
+    localData.finishRebase(merged);
+
+    EXPECT_EQ(localData.data().revision(), 7);
+    EXPECT_TRUE(localData.data().needsLocalSave);
+    EXPECT_EQ(localData.taskForUuid("task-1")->title, "Edited");
+    EXPECT_EQ(localData.taskForUuid("task-1")->revision, 2);
+    EXPECT_TRUE(localData.taskForUuid("task-1")->needsSyncToServer);
+    EXPECT_EQ(localData.taskForUuid("task-2")->title, "Edited");
+    EXPECT_EQ(localData.taskForUuid("task-2")->revision, 1);
+    EXPECT_EQ(localData.taskForUuid("task-3"), nullptr);
+    EXPECT_NE(localData.taskForUuid("task-4"), nullptr);
+
+    Task afterRebase = *localData.taskForUuid("task-4");
+    afterRebase.title = "Not journaled";
+    ASSERT_TRUE(localData.updateTask(afterRebase));
+    localData.finishRebase(merged);
+    EXPECT_EQ(localData.taskForUuid("task-4"), nullptr);
+}
+
+TEST(LocalDataTest, BatchAppliesRemovalsOnCommit)
+{
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, "/tmp/pointless.json"));
+    LocalData localData;
+    for (int i = 0; i < 10; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.uuidInDeviceCalendar = i % 2 == 0 ? std::optional<std::string>("event") : std::nullopt;
+        ASSERT_TRUE(localData.addTask(task));
+    }
+
+    localData.beginBatch();
+    EXPECT_TRUE(localData.isBatching());
+    EXPECT_TRUE(localData.removeTask("task-1"));
+    EXPECT_FALSE(localData.removeTask("task-1"));
+    EXPECT_FALSE(localData.removeTask("missing"));
+    EXPECT_EQ(localData.deleteCalendarTasks(), 5);
+
+    Task added;
+    added.uuid = "task-new";
+    EXPECT_TRUE(localData.addTask(added));
+
+    // Removals are deferred until the outermost commit
+    EXPECT_EQ(localData.taskCount(), 11);
+    EXPECT_EQ(localData.commit(), 7);
+    EXPECT_FALSE(localData.isBatching());
+
+    EXPECT_EQ(localData.taskCount(), 5);
+    EXPECT_EQ(localData.deletedTasks().size(), 6);
+    EXPECT_EQ(localData.taskForUuid("task-0"), nullptr);
+    EXPECT_EQ(localData.taskForUuid("task-1"), nullptr);
+    ASSERT_NE(localData.taskForUuid("task-3"), nullptr);
+    EXPECT_EQ(*localData.data().indexOfTask("task-new"), 4);
+    EXPECT_EQ(std::ranges::distance(localData.data().pendingTasksView()), 5);
+}
+
+TEST(LocalDataTest, BatchRemovalsAreReplayedAfterRebase)
+{
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, "/tmp/pointless.json"));
+    LocalData localData;
+    for (int i = 0; i < 4; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        localData.addTask(task);
+    }
+
+    auto base = localData.beginRebase();
+    localData.beginBatch();
+    localData.removeTask("task-0");
+    localData.removeTask("task-2");
+    localData.commit();
+
+    Data merged = *base;
+    localData.finishRebase(std::move(merged));
+    EXPECT_EQ(localData.taskCount(), 2);
+    EXPECT_EQ(localData.taskForUuid("task-2"), nullptr);
+    EXPECT_EQ(localData.deletedTasks().size(), 2);
+}
+
+TEST(LocalDataTest, EditsAreAppendedToOperationLog)
+{
+    const TempDir tempDir;
+    const std::filesystem::path dataFile = tempDir / "pointless.json";
+    const std::filesystem::path logFile = tempDir / "pointless.json.log";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile));
+
+    LocalData localData;
+    Data initial;
+    for (const auto *uuid : { "task-1", "task-2" }) {
+        Task task;
+        task.uuid = uuid;
+        task.title = "Original";
+        task.tags.add("work");
+        initial.addTask(task);
+    }
+    Tag tag;
+    tag.name = "work";
+    initial.addTag(tag);
+    localData.setData(initial);
+
+    ASSERT_TRUE(localData.save().has_value());
+    const auto snapshotSize = std::filesystem::file_size(dataFile);
+    EXPECT_FALSE(std::filesystem::exists(logFile));
+
+    Task edited = *localData.taskForUuid("task-1");
+    edited.title = "Edited";
+    ASSERT_TRUE(localData.updateTask(edited));
+    ASSERT_TRUE(localData.removeTask("task-2"));
+    Task added;
+    added.uuid = "task-3";
+    ASSERT_TRUE(localData.addTask(added));
+    ASSERT_TRUE(localData.renameTag("work", "job"));
+
+    // A duplicate uuid is refused and doesn't reach the log
+    Task duplicate;
+    duplicate.uuid = "task-1";
+    duplicate.title = "Duplicate";
+    EXPECT_FALSE(localData.addTask(duplicate));
+    EXPECT_EQ(localData.taskForUuid("task-1")->title, "Edited");
+
+    // Only the edits are written, the snapshot is untouched
+    ASSERT_TRUE(localData.save().has_value());
+    EXPECT_EQ(std::filesystem::file_size(dataFile), snapshotSize);
+    EXPECT_TRUE(std::filesystem::exists(logFile));
+
+    LocalData reloaded;
+    ASSERT_TRUE(reloaded.loadDataFromFile().has_value());
+    EXPECT_EQ(reloaded.taskCount(), 2);
+    ASSERT_NE(reloaded.taskForUuid("task-1"), nullptr);
+    EXPECT_EQ(reloaded.taskForUuid("task-1")->title, "Edited");
+    EXPECT_EQ(reloaded.taskForUuid("task-2"), nullptr);
+    EXPECT_NE(reloaded.taskForUuid("task-3"), nullptr);
+    EXPECT_TRUE(reloaded.data().containsTag("job"));
+    EXPECT_EQ(reloaded.deletedTasks().size(), 1);
+
+    // Replacing the data wholesale writes a new snapshot and drops the log
+    reloaded.setData(reloaded.data());
+    ASSERT_TRUE(reloaded.save().has_value());
+    EXPECT_FALSE(std::filesystem::exists(logFile));
+}
+
+TEST(LocalDataTest, LogOfAnOlderSnapshotIsNotReplayed)
+{
+    const TempDir tempDir;
+    const std::filesystem::path dataFile = tempDir / "pointless.json";
+    const std::filesystem::path logFile = tempDir / "pointless.json.log";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile));
+
+    LocalData localData;
+    Data initial;
+    Task task;
+    task.uuid = "task-1";
+    task.title = "Original";
+    initial.addTask(task);
+    localData.setData(initial);
+    ASSERT_TRUE(localData.save().has_value());
+
+    task.title = "Edited before the sync";
+    ASSERT_TRUE(localData.updateTask(task));
+    ASSERT_TRUE(localData.save().has_value());
+    const std::filesystem::path oldLog = tempDir / "old.log";
+    std::filesystem::copy_file(logFile, oldLog);
+
+    Data synced = localData.data();
+    Task merged = *synced.taskForUuid("task-1");
+    merged.title = "Merged by the sync";
+    synced.setTask(merged);
+    localData.setData(synced);
+    ASSERT_TRUE(localData.save().has_value());
+    EXPECT_FALSE(std::filesystem::exists(logFile));
+
+    // As if a crash came between the snapshot's rename and the log's removal
+    std::filesystem::copy_file(oldLog, logFile);
+
+    LocalData reloaded;
+    ASSERT_TRUE(reloaded.loadDataFromFile().has_value());
+    ASSERT_NE(reloaded.taskForUuid("task-1"), nullptr);
+    EXPECT_EQ(reloaded.taskForUuid("task-1")->title, "Merged by the sync");
+
+    // And new edits don't land behind the old records
+    task = *reloaded.taskForUuid("task-1");
+    task.title = "Edited after the sync";
+    ASSERT_TRUE(reloaded.updateTask(task));
+    ASSERT_TRUE(reloaded.save().has_value());
+
+    LocalData again;
+    ASSERT_TRUE(again.loadDataFromFile().has_value());
+    EXPECT_EQ(again.taskForUuid("task-1")->title, "Edited after the sync");
+}
+
+TEST(LocalDataTest, RefreshKeepsAppendingToTheLog)
+{
+    const TempDir tempDir;
+    const std::filesystem::path dataFile = tempDir / "pointless.json";
+    const std::filesystem::path logFile = tempDir / "pointless.json.log";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile));
+
+    LocalData localData;
+    Data initial;
+    for (const auto *uuid : { "task-1", "task-2" }) {
+        Task task;
+        task.uuid = uuid;
+        task.title = "Original";
+        task.revision = 1;
+        initial.addTask(task);
+    }
+    localData.setData(initial);
+    ASSERT_TRUE(localData.save().has_value());
+    const auto snapshotSize = std::filesystem::file_size(dataFile);
+
+    // A refresh that found nothing new, the data stays shared instead of being copied
+    const auto before = localData.snapshot();
+    localData.finishRebase(*localData.beginRebase());
+    EXPECT_FALSE(localData.data().needsLocalSave);
+    EXPECT_EQ(localData.snapshot(), before);
+    EXPECT_EQ(localData.snapshot().get(), &localData.data());
+
+    // One that brought a remote edit and a new task
+    Data merged = *localData.beginRebase();
+    Task remote = *merged.taskForUuid("task-2");
+    remote.title = "Remote";
+    remote.revision = 2;
+    merged.setTask(remote);
+    Task added;
+    added.uuid = "task-3";
+    merged.addTask(added);
+    localData.finishRebase(merged);
+    EXPECT_TRUE(localData.data().needsLocalSave);
+
+    Task edited = *localData.taskForUuid("task-1");
+    edited.isDone = true;
+    ASSERT_TRUE(localData.updateTask(edited));
+    ASSERT_TRUE(localData.save().has_value());
+
+    EXPECT_EQ(std::filesystem::file_size(dataFile), snapshotSize);
+    EXPECT_TRUE(std::filesystem::exists(logFile));
+
+    LocalData reloaded;
+    ASSERT_TRUE(reloaded.loadDataFromFile().has_value());
+    EXPECT_EQ(reloaded.taskCount(), 3);
+    EXPECT_TRUE(reloaded.taskForUuid("task-1")->isDone);
+    EXPECT_EQ(reloaded.taskForUuid("task-2")->title, "Remote");
+    EXPECT_EQ(reloaded.taskForUuid("task-2")->revision, 2);
+    EXPECT_NE(reloaded.taskForUuid("task-3"), nullptr);
+}
+
+TEST(LocalDataTest, BinarySnapshotLoadsLikeJson)
+{
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, "/tmp/pointless.json"));
+    LocalData localData;
+    const auto fixture = localData.loadDataFromFile((std::filesystem::path(__FILE__).parent_path() / "test.json").string());
+    ASSERT_TRUE(fixture.has_value());
+    ASSERT_GT(fixture->taskCount(), 0);
+
+    const TempDir tempDir;
+
+    const auto binaryFile = tempDir / "pointless.bin";
+    std::ofstream(binaryFile, std::ios::binary) << fixture->toBinary().value_or("");
+    auto loaded = localData.loadDataFromFile(binaryFile.string());
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->taskCount(), fixture->taskCount());
+    EXPECT_EQ(loaded->toJson().value_or(""), fixture->toJson().value_or(""));
+}
+
+TEST(LocalDataTest, BackgroundSavesAreFlushed)
+{
+    const TempDir tempDir;
+    const std::filesystem::path dataFile = tempDir / "pointless.json";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile));
+
+    {
+        LocalData localData;
+        localData.setData(Data {});
+        for (int i = 0; i < 50; ++i) {
+            Task task;
+            task.uuid = "task-" + std::to_string(i);
+            ASSERT_TRUE(localData.addTask(task));
+            localData.saveInBackground();
+        }
+
+        ASSERT_TRUE(localData.flushSaves().has_value());
+        EXPECT_TRUE(std::filesystem::exists(dataFile));
+
+        Task last;
+        last.uuid = "task-last";
+        ASSERT_TRUE(localData.addTask(last));
+        localData.saveInBackground();
+        // Destruction flushes the queued save
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(tempDir / "pointless.json.tmp"));
+
+    LocalData reloaded;
+    ASSERT_TRUE(reloaded.loadDataFromFile().has_value());
+    EXPECT_EQ(reloaded.taskCount(), 51);
+    EXPECT_NE(reloaded.taskForUuid("task-last"), nullptr);
+}
+
+TEST(LocalDataTest, CleanupMovesTasksToArchive)
+{
+    const TempDir tempDir;
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, tempDir / "pointless.json"));
+
+    Data data;
+    const auto longAgo = std::chrono::system_clock::now() - std::chrono::days(30);
+    for (int i = 0; i < 4; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.title = "Old chore " + std::to_string(i);
+        task.isDone = i < 3;
+        task.modificationTimestamp = longAgo;
+        task.revision = 1;
+        data.addTask(task);
+    }
+
+    LocalData localData;
+    localData.setData(data);
+
+    EXPECT_EQ(localData.cleanupOldData(), 3);
+    EXPECT_EQ(localData.taskCount(), 1);
+    EXPECT_EQ(localData.deletedTasks().size(), 3);
+
+    // Archived tasks stay searchable from a fresh instance, without being loaded into Data
+    LocalData reopened;
+    auto matches = reopened.archive().search("chore 1");
+    ASSERT_TRUE(matches.has_value());
+    ASSERT_EQ(matches->size(), 1);
+    EXPECT_EQ((*matches)[0].title, "Old chore 1");
+    EXPECT_EQ(reopened.archive().taskCount().value_or(0), 3);
+    EXPECT_EQ(reopened.taskCount(), 0);
+}
+
+TEST(LocalDataTest, ExternalFileChangesAreDiffedPerTask)
+{
+    const TempDir tempDir;
+    const auto dataFile = tempDir / "pointless.json";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile));
+
+    Data initial;
+    for (const auto *uuid : { "task-1", "task-2", "task-3" }) {
+        Task task;
+        task.uuid = uuid;
+        task.title = "Original";
+        initial.addTask(task);
+    }
+    Tag work;
+    work.name = "work";
+    initial.addTag(work);
+
+    LocalData localData;
+    localData.setData(initial);
+    ASSERT_TRUE(localData.save().has_value());
+
+    // Our own save isn't an external change
+    auto changes = localData.readFileChanges();
+    ASSERT_TRUE(changes.has_value());
+    EXPECT_TRUE(changes->isEmpty());
+
+    // Not saved yet, so it wins over the file
+    Task localEdit = *localData.taskForUuid("task-3");
+    localEdit.title = "Edited here";
+    ASSERT_TRUE(localData.updateTask(localEdit));
+
+    // Another process rewrites the file, like rename_tag does
+    Data external = initial;
+    for (const auto *uuid : { "task-1", "task-3" }) {
+        Task task = *external.taskForUuid(uuid);
+        task.title = "Edited elsewhere";
+        external.setTask(task);
+    }
+    external.removeTask("task-2");
+    Task added;
+    added.uuid = "task-4";
+    external.addTask(added);
+    Tag home;
+    home.name = "home";
+    external.addTag(home);
+    ASSERT_TRUE(writeFileAtomically(dataFile.string(), external.toJson().value()).has_value());
+
+    changes = localData.readFileChanges();
+    ASSERT_TRUE(changes.has_value());
+    ASSERT_EQ(changes->updatedTasks.size(), 1);
+    EXPECT_EQ(changes->updatedTasks[0].uuid, Uuid("task-1"));
+    EXPECT_EQ(changes->removedTasks, std::vector<Uuid> { Uuid("task-2") });
+    ASSERT_EQ(changes->addedTasks.size(), 1);
+    EXPECT_EQ(changes->addedTasks[0].uuid, Uuid("task-4"));
+    ASSERT_EQ(changes->addedTags.size(), 1);
+    EXPECT_EQ(changes->addedTags[0].name, "home");
+    EXPECT_TRUE(changes->removedTags.empty());
+
+    localData.storeTaskFromFile(changes->updatedTasks[0]);
+    EXPECT_EQ(localData.taskForUuid("task-1")->title, "Edited elsewhere");
+    EXPECT_EQ(localData.taskForUuid("task-3")->title, "Edited here");
+}
+
+TEST(LocalDataTest, ExternalDatabaseChangesAreDiffed)
+{
+    const TempDir tempDir;
+    const auto dataFile = tempDir / "pointless.json";
+    Context::setContext(Context(IDataProvider::Type::TestsLocal, dataFile, static_cast<unsigned int>(Context::StartupOption::SqliteStorage)));
+
+    Data initial;
+    Task task;
+    task.uuid = "task-1";
+    task.title = "Original";
+    initial.addTask(task);
+
+    LocalData localData;
+    localData.setData(initial);
+    ASSERT_TRUE(localData.save().has_value());
+
+    const auto database = SqliteStore::pathFor(dataFile.string());
+    EXPECT_EQ(localData.watchedFiles(), (std::vector<std::string> { database, database + "-wal" }));
+
+    auto changes = localData.readFileChanges();
+    ASSERT_TRUE(changes.has_value());
+    EXPECT_TRUE(changes->isEmpty());
+
+    // Another process writes the database, like rename_tag does
+    {
+        LocalData other;
+        ASSERT_TRUE(other.loadDataFromFile().has_value());
+        task.title = "Edited elsewhere";
+        ASSERT_TRUE(other.updateTask(task));
+        Task added;
+        added.uuid = "task-2";
+        ASSERT_TRUE(other.addTask(added));
+        ASSERT_TRUE(other.save().has_value());
+    }
+
+    changes = localData.readFileChanges();
+    ASSERT_TRUE(changes.has_value());
+    ASSERT_EQ(changes->updatedTasks.size(), 1);
+    EXPECT_EQ(changes->updatedTasks[0].title, "Edited elsewhere");
+    ASSERT_EQ(changes->addedTasks.size(), 1);
+    EXPECT_EQ(changes->addedTasks[0].uuid, Uuid("task-2"));
+    EXPECT_TRUE(changes->removedTasks.empty());
+}
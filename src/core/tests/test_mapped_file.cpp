@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "mapped_file.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace pointless::core;
+
+TEST(MappedFileTest, MapsContents)
+{
+    const auto path = std::filesystem::temp_directory_path() / "pointless_test_mapped.json";
+    std::ofstream(path) << R"({"revision":1})";
+
+    auto file = MappedFile::open(path.string());
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->contents(), R"({"revision":1})");
+
+    MappedFile moved = std::move(*file);
+    EXPECT_EQ(moved.contents(), R"({"revision":1})");
+    EXPECT_TRUE(file->contents().empty());
+
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFileTest, SurvivesAtomicReplace)
+{
+    const auto path = std::filesystem::temp_directory_path() / "pointless_test_replaced.json";
+    const auto tmpPath = std::filesystem::temp_directory_path() / "pointless_test_replaced.json.tmp";
+    std::ofstream(path) << "old contents";
+
+    auto file = MappedFile::open(path.string());
+    ASSERT_TRUE(file.has_value());
+
+    // What a save does while a load still holds the mapping
+    std::ofstream(tmpPath) << "new contents, longer than the old ones";
+    std::filesystem::rename(tmpPath, path);
+
+    EXPECT_EQ(file->contents(), "old contents");
+    auto reopened = MappedFile::open(path.string());
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->contents(), "new contents, longer than the old ones");
+
+    std::filesystem::remove(path);
+}
+
+TEST(MappedFileTest, EmptyAndMissingFiles)
+{
+    const auto path = std::filesystem::temp_directory_path() / "pointless_test_empty.json";
+    std::ofstream { path };
+
+    auto file = MappedFile::open(path.string());
+    ASSERT_TRUE(file.has_value());
+    EXPECT_TRUE(file->contents().empty());
+
+    std::filesystem::remove(path);
+    EXPECT_FALSE(MappedFile::open(path.string()).has_value());
+}
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "operation_log.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace pointless::core;
+
+namespace {
+
+const OperationLog::SnapshotId Snapshot = OperationLog::snapshotIdOf("snapshot");
+
+std::string freshLogPath(const std::string &name)
+{
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+}
+
+TEST(OperationLogTest, AppendAndReadBack)
+{
+    OperationLog log(freshLogPath("pointless_test_append.log"));
+    EXPECT_FALSE(log.exists());
+    ASSERT_TRUE(log.readAll(Snapshot).has_value());
+
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TaskDelete, "task-1\n" }, { OperationLog::RecordType::TagRemove, "work" } }, Snapshot));
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRename, std::string("a\nb") } }, Snapshot));
+
+    auto records = log.readAll(Snapshot);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 3);
+    EXPECT_EQ((*records)[0].type, OperationLog::RecordType::TaskDelete);
+    EXPECT_EQ((*records)[0].body, "task-1\n");
+    EXPECT_EQ((*records)[1].body, "work");
+    EXPECT_EQ((*records)[2].type, OperationLog::RecordType::TagRename);
+
+    log.remove();
+    EXPECT_FALSE(log.exists());
+}
+
+TEST(OperationLogTest, TornTailIsDiscarded)
+{
+    OperationLog log(freshLogPath("pointless_test_torn.log"));
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "first" } }, Snapshot));
+    const auto intactSize = log.size();
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "second" } }, Snapshot));
+
+    // Simulate a crash in the middle of the second append
+    std::filesystem::resize_file(log.path(), log.size() - 3);
+    const auto tornSize = log.size();
+
+    // Reading leaves the file alone
+    const OperationLog reader(log.path());
+    auto records = reader.readAll(Snapshot);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 1);
+    EXPECT_EQ((*records)[0].body, "first");
+    EXPECT_EQ(log.size(), tornSize);
+
+    // The next writer cuts the tail off before appending, as if the process had restarted
+    OperationLog writer(log.path());
+    ASSERT_TRUE(writer.append({ { OperationLog::RecordType::TagRemove, "third" } }, Snapshot));
+    records = reader.readAll(Snapshot);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 2);
+    EXPECT_EQ((*records)[1].body, "third");
+    EXPECT_EQ(log.size(), intactSize + 8 + 1 + std::string_view("third").size());
+
+    log.remove();
+}
+
+TEST(OperationLogTest, CorruptRecordStopsReplay)
+{
+    OperationLog log(freshLogPath("pointless_test_corrupt.log"));
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "first" }, { OperationLog::RecordType::TagRemove, "second" } }, Snapshot));
+
+    {
+        std::fstream file(log.path(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('X');
+    }
+
+    auto records = log.readAll(Snapshot);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 1);
+    EXPECT_EQ((*records)[0].body, "first");
+
+    log.remove();
+}
+
+TEST(OperationLogTest, LogOfAnotherSnapshotIsNotReplayed)
+{
+    OperationLog log(freshLogPath("pointless_test_other_snapshot.log"));
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "old" } }, Snapshot));
+
+    // As if a crash came after the next snapshot's rename, before the log was removed
+    const auto newer = OperationLog::snapshotIdOf("newer snapshot");
+    auto records = log.readAll(newer);
+    ASSERT_TRUE(records.has_value());
+    EXPECT_TRUE(records->empty());
+
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "new" } }, newer));
+    records = log.readAll(newer);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 1);
+    EXPECT_EQ((*records)[0].body, "new");
+
+    log.remove();
+}
+
+TEST(OperationLogTest, TornMagicIsStartedOver)
+{
+    OperationLog log(freshLogPath("pointless_test_torn_magic.log"));
+    {
+        std::ofstream file(log.path(), std::ios::binary);
+        file << "PLO";
+    }
+
+    auto torn = log.readAll(Snapshot);
+    ASSERT_TRUE(torn.has_value());
+    EXPECT_TRUE(torn->empty());
+
+    ASSERT_TRUE(log.append({ { OperationLog::RecordType::TagRemove, "first" } }, Snapshot));
+    auto records = log.readAll(Snapshot);
+    ASSERT_TRUE(records.has_value());
+    ASSERT_EQ(records->size(), 1);
+    EXPECT_EQ((*records)[0].body, "first");
+
+    log.remove();
+}
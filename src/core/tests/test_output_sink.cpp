@@ -0,0 +1,233 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "output_sink.h"
+
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <array>
+
+using namespace pointless::core;
+
+namespace {
+
+std::string gunzip(const std::string &compressed)
+{
+    z_stream zs {};
+    EXPECT_EQ(inflateInit2(&zs, MAX_WBITS + 16), Z_OK);
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+    zs.avail_in = static_cast<uInt>(compressed.size());
+
+    std::string result;
+    std::array<char, 1024> buffer {};
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        zs.next_out = reinterpret_cast<Bytef *>(buffer.data());
+        zs.avail_out = static_cast<uInt>(buffer.size());
+        ret = inflate(&zs, Z_NO_FLUSH);
+        result.append(buffer.data(), buffer.size() - zs.avail_out);
+    }
+    inflateEnd(&zs);
+    EXPECT_EQ(ret, Z_STREAM_END);
+    return result;
+}
+
+std::string gzipped(const std::string &input)
+{
+    std::string compressed;
+    StringSink out(compressed);
+    GzipSink gzip(out);
+    EXPECT_TRUE(gzip.write(input));
+    EXPECT_TRUE(gzip.finish());
+    return compressed;
+}
+
+}
+
+TEST(OutputSinkTest, Base64MatchesReferenceVectors)
+{
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+    };
+
+    for (const auto &[input, expected] : vectors) {
+        // Byte by byte, so triples straddle writes
+        std::string encoded;
+        StringSink out(encoded);
+        Base64Sink base64(out);
+        for (char c : input) {
+            ASSERT_TRUE(base64.write(std::string_view(&c, 1)));
+        }
+        ASSERT_TRUE(base64.finish());
+        EXPECT_EQ(encoded, expected) << input;
+    }
+}
+
+TEST(OutputSinkTest, GzipRoundTripsChunkedInput)
+{
+    std::string input;
+    for (int i = 0; i < 20000; ++i) {
+        input += "{\"title\":\"task " + std::to_string(i) + "\"},";
+    }
+
+    std::string compressed;
+    StringSink out(compressed);
+    GzipSink gzip(out);
+    for (size_t offset = 0; offset < input.size(); offset += 1000) {
+        ASSERT_TRUE(gzip.write(std::string_view(input).substr(offset, 1000)));
+    }
+    ASSERT_TRUE(gzip.finish());
+
+    EXPECT_LT(compressed.size(), input.size() / 4);
+    EXPECT_EQ(gunzip(compressed), input);
+}
+
+TEST(OutputSinkTest, Base64DecodesReferenceVectors)
+{
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        { "", "" }, { "Zg==", "f" }, { "Zm8=", "fo" }, { "Zm9v", "foo" },
+        { "Zm9vYg==", "foob" }, { "Zm9vYmE=", "fooba" }, { "Zm9vYmFy", "foobar" }, { "Zm9vYg", "foob" },
+    };
+
+    for (const auto &[input, expected] : vectors) {
+        std::string decoded;
+        StringSink out(decoded);
+        Base64DecodeSink base64(out);
+        for (char c : input) {
+            ASSERT_TRUE(base64.write(std::string_view(&c, 1)));
+        }
+        ASSERT_TRUE(base64.finish());
+        EXPECT_EQ(decoded, expected) << input;
+    }
+}
+
+TEST(OutputSinkTest, Base64DecodesUnalignedWrites)
+{
+    std::string input;
+    for (int i = 0; i < 3000; ++i) {
+        input.push_back(static_cast<char>(i * 7));
+    }
+    std::string encoded;
+    {
+        StringSink out(encoded);
+        Base64Sink base64(out);
+        ASSERT_TRUE(base64.write(input));
+        ASSERT_TRUE(base64.finish());
+    }
+
+    // The first write leaves a partial quad, every later one starts in the middle of one
+    for (const size_t chunk : { 1, 3, 5, 6, 1001 }) {
+        std::string decoded;
+        StringSink out(decoded);
+        Base64DecodeSink base64(out);
+        for (size_t offset = 0; offset < encoded.size(); offset += chunk) {
+            ASSERT_TRUE(base64.write(std::string_view(encoded).substr(offset, chunk)));
+        }
+        ASSERT_TRUE(base64.finish());
+        EXPECT_EQ(decoded, input) << chunk;
+    }
+
+    std::string decoded;
+    StringSink out(decoded);
+    Base64DecodeSink base64(out);
+    ASSERT_TRUE(base64.write("Zm9vY"));
+    EXPECT_FALSE(base64.write("mF!Zm9v"));
+}
+
+TEST(OutputSinkTest, Base64RejectsInvalidInput)
+{
+    for (const std::string input : { "Zm9v!", "Zm 9v", "Zg==Zg==", "Z===", "Zg=" }) {
+        std::string decoded;
+        StringSink out(decoded);
+        Base64DecodeSink base64(out);
+        const bool ok = base64.write(input).has_value() && base64.finish().has_value();
+        EXPECT_FALSE(ok) << input;
+    }
+}
+
+TEST(OutputSinkTest, Md5MatchesReferenceVectors)
+{
+    // RFC 1321, and one that needs a second padding block
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        { "", "d41d8cd98f00b204e9800998ecf8427e" },
+        { "abc", "900150983cd24fb0d6963f7d28e17f72" },
+        { "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+        { "12345678901234567890123456789012345678901234567890123456789012345678901234567890", "57edf4a22be3c955ac49da2e2107b67a" },
+        { std::string(56, 'a'), "3b0c8ac703f828b04c6c197006d17218" },
+    };
+
+    for (const auto &[input, expected] : vectors) {
+        EXPECT_EQ(Md5::hexDigest(input), expected);
+
+        // Byte by byte through the sink, which passes everything on
+        std::string forwarded;
+        StringSink out(forwarded);
+        Md5Sink md5(out);
+        for (char c : input) {
+            ASSERT_TRUE(md5.write(std::string_view(&c, 1)));
+        }
+        ASSERT_TRUE(md5.finish());
+        EXPECT_EQ(md5.hexDigest(), expected);
+        EXPECT_EQ(forwarded, input);
+    }
+}
+
+TEST(OutputSinkTest, JsonStringFieldIsExtractedAcrossWrites)
+{
+    const std::string response = R"([ {"revision": 3, "note": "data", "data" : "Zm9v\/YmFy\"x"} ])";
+
+    std::string field;
+    StringSink out(field);
+    JsonStringFieldSink data("data", out);
+    for (char c : response) {
+        ASSERT_TRUE(data.write(std::string_view(&c, 1)));
+    }
+    ASSERT_TRUE(data.finish());
+    EXPECT_EQ(field, "Zm9v/YmFy\"x");
+
+    std::string missing;
+    StringSink missingOut(missing);
+    JsonStringFieldSink other("other", missingOut);
+    ASSERT_TRUE(other.write(response));
+    EXPECT_FALSE(other.finish());
+}
+
+TEST(OutputSinkTest, PushedDocumentDecodesAsAStream)
+{
+    std::string document;
+    for (int i = 0; i < 20000; ++i) {
+        document += "{\"title\":\"task " + std::to_string(i) + "\"},";
+    }
+
+    // What a push sends
+    std::string body = R"([{"data":")";
+    {
+        StringSink out(body);
+        Base64Sink base64(out);
+        GzipSink gzip(base64);
+        ASSERT_TRUE(gzip.write(document));
+        ASSERT_TRUE(gzip.finish());
+    }
+    body += R"("}])";
+
+    // And how a pull reads it, in uneven chunks
+    std::string decoded;
+    StringSink out(decoded);
+    GunzipSink gunzip(out);
+    Base64DecodeSink base64(gunzip);
+    JsonStringFieldSink data("data", base64);
+    for (size_t offset = 0; offset < body.size(); offset += 777) {
+        ASSERT_TRUE(data.write(std::string_view(body).substr(offset, 777)));
+    }
+    ASSERT_TRUE(data.finish());
+    EXPECT_EQ(decoded, document);
+
+    std::string truncated;
+    StringSink truncatedOut(truncated);
+    GunzipSink truncatedGunzip(truncatedOut);
+    ASSERT_TRUE(truncatedGunzip.write(std::string_view(gzipped(document)).substr(0, 100)));
+    EXPECT_FALSE(truncatedGunzip.finish());
+}
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "sqlite_store.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+using namespace pointless::core;
+
+namespace {
+
+std::string freshDatabasePath(const std::string &name)
+{
+    const auto path = std::filesystem::temp_directory_path() / name;
+    for (const char *suffix : { "", "-wal", "-shm" }) {
+        std::filesystem::remove(path.string() + suffix);
+    }
+    return path.string();
+}
+
+Task createTask(const std::string &uuid, const std::vector<std::string> &tags, bool isDone = false)
+{
+    Task task;
+    task.uuid = uuid;
+    task.title = "Task " + uuid;
+    task.setTags(tags);
+    task.isDone = isDone;
+    task.creationTimestamp = std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now());
+    return task;
+}
+
+Data sampleData()
+{
+    const auto today = std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+
+    Data data;
+    Task dueSoon = createTask("sqlite-1", { "work" });
+    dueSoon.dueDate = today + std::chrono::days(2);
+    data.addTask(dueSoon);
+    data.addTask(createTask("sqlite-2", { "work", "home" }, true));
+    Task dueLater = createTask("sqlite-3", { "home" });
+    dueLater.dueDate = today + std::chrono::days(20);
+    data.addTask(dueLater);
+
+    data.addTag(Tag { .name = "work" });
+    data.addTag(Tag { .name = "home" });
+    data.addDeletedTaskUuid(Uuid("sqlite-old"));
+    data.setRevision(7);
+    return data;
+}
+
+}
+
+TEST(SqliteStoreTest, ExportMatchesTheImportedJson)
+{
+    const auto path = freshDatabasePath("pointless_test_roundtrip.sqlite");
+    const Data data = sampleData();
+    {
+        auto store = SqliteStore::open(path);
+        ASSERT_TRUE(store) << store.error();
+        ASSERT_TRUE(store->importData(data));
+    }
+
+    // A fresh connection reads it back from disk
+    auto store = SqliteStore::open(path);
+    ASSERT_TRUE(store) << store.error();
+    auto exported = store->exportJson();
+    ASSERT_TRUE(exported) << exported.error();
+    EXPECT_EQ(*exported, data.toJson().value());
+}
+
+TEST(SqliteStoreTest, RecordsApplyAsRowUpdates)
+{
+    auto store = SqliteStore::open(freshDatabasePath("pointless_test_apply.sqlite"));
+    ASSERT_TRUE(store) << store.error();
+    ASSERT_TRUE(store->importData(sampleData()));
+
+    Task added = createTask("sqlite-4", { "errands" });
+    const std::vector<OperationLog::Record> records = {
+        { OperationLog::RecordType::TaskUpsert, glz::write_json(added).value_or("") },
+        { OperationLog::RecordType::TaskDelete, "sqlite-1\nsqlite-missing" },
+        { OperationLog::RecordType::TagRemove, "home" },
+        { OperationLog::RecordType::TagAdd, R"({"name":"errands"})" },
+    };
+    ASSERT_TRUE(store->apply(records));
+
+    auto exported = store->exportData();
+    ASSERT_TRUE(exported) << exported.error();
+    EXPECT_EQ(exported->taskCount(), 3);
+    EXPECT_FALSE(exported->taskForUuid("sqlite-1"));
+    EXPECT_TRUE(exported->taskForUuid("sqlite-4"));
+    EXPECT_EQ(exported->revision(), 7);
+
+    // Only what was actually removed leaves a tombstone
+    const std::vector<Uuid> expectedDeletedTasks = { Uuid("sqlite-old"), Uuid("sqlite-1") };
+    EXPECT_EQ(exported->deletedTaskUuids(), expectedDeletedTasks);
+    EXPECT_EQ(exported->deletedTagNames(), std::vector<std::string> { "home" });
+}
+
+TEST(SqliteStoreTest, TagRenamesAreRejected)
+{
+    auto store = SqliteStore::open(freshDatabasePath("pointless_test_rename.sqlite"));
+    ASSERT_TRUE(store) << store.error();
+
+    const std::vector<OperationLog::Record> records = { { OperationLog::RecordType::TagRename, "work\njob" } };
+    EXPECT_FALSE(SqliteStore::canApply(records));
+    EXPECT_FALSE(store->apply(records));
+}
@@ -2,10 +2,15 @@
 // SPDX-License-Identifier: MIT
 
 #include "tag.h"
+#include "tag_list.h"
 
 #include <gtest/gtest.h>
 #include <glaze/glaze.hpp>
 
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace pointless::core;
 
 TEST(TagTest, SerializeDeserializeJson)
@@ -28,3 +33,73 @@ TEST(TagTest, SerializeDeserializeJson)
     EXPECT_EQ(original_tag.name, deserialized_tag.name);
     EXPECT_EQ(original_tag, deserialized_tag);
 }
+
+TEST(TagTest, TagListInternsNames)
+{
+    EXPECT_EQ(TagDictionary::intern(BUILTIN_TAG_SOON), BUILTIN_TAG_ID_SOON);
+    EXPECT_EQ(TagDictionary::intern(BUILTIN_TAG_EVENING), BUILTIN_TAG_ID_EVENING);
+    EXPECT_TRUE(tagIsBuiltin(BUILTIN_TAG_ID_CURRENT));
+    EXPECT_FALSE(tagIsBuiltin(TagDictionary::intern("work")));
+    EXPECT_FALSE(TagDictionary::find("never-interned-tag").has_value());
+
+    TagList tags { "work", "soon" };
+    EXPECT_TRUE(tags.contains("work"));
+    EXPECT_TRUE(tags.contains(BUILTIN_TAG_ID_SOON));
+    EXPECT_FALSE(tags.contains(BUILTIN_TAG_ID_CURRENT));
+    EXPECT_FALSE(tags.contains("never-interned-tag"));
+    EXPECT_FALSE(tags.add("work"));
+    EXPECT_TRUE(tags.add("home"));
+    EXPECT_EQ(tags.size(), 3);
+    EXPECT_EQ(tags[2], "home");
+
+    EXPECT_TRUE(tags.replace(TagDictionary::intern("work"), TagDictionary::intern("office")));
+    EXPECT_FALSE(tags.contains("work"));
+    EXPECT_EQ(tags[0], "office");
+
+    EXPECT_TRUE(tags.remove(BUILTIN_TAG_ID_SOON));
+    EXPECT_FALSE(tags.contains(BUILTIN_TAG_ID_SOON));
+    const std::vector<std::string> names(tags.begin(), tags.end());
+    EXPECT_EQ(names, (std::vector<std::string> { "office", "home" }));
+
+    // 64 apart shares a mask bit, the lookup must still be exact
+    for (int i = 0; i < 70; ++i) {
+        TagDictionary::intern("filler-" + std::to_string(i));
+    }
+    const TagId first = TagDictionary::intern("filler-0");
+    TagList single;
+    single.append(first);
+    EXPECT_FALSE(single.contains(first + 64));
+}
+
+TEST(TagTest, DictionaryIsSafeToShareBetweenThreads)
+{
+    // Enough names to fill several chunks and grow the table while others read it
+    std::vector<std::jthread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 5000; ++i) {
+                const std::string name = "shared-" + std::to_string((i * 7 + t) % 3000);
+                const TagId id = TagDictionary::intern(name);
+                EXPECT_EQ(TagDictionary::name(id), name);
+                EXPECT_EQ(TagDictionary::find(name), id);
+            }
+        });
+    }
+    threads.clear();
+
+    EXPECT_EQ(TagDictionary::name(TagDictionary::intern("shared-42")), "shared-42");
+    EXPECT_EQ(TagDictionary::name(BUILTIN_TAG_ID_CURRENT), BUILTIN_TAG_CURRENT);
+}
+
+TEST(TagTest, TagListJsonKeepsNames)
+{
+    TagList tags { "work", "work", "current" };
+
+    auto json = glz::write_json(tags);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_EQ(*json, R"(["work","work","current"])");
+
+    TagList deserialized;
+    EXPECT_FALSE(glz::read_json(deserialized, *json));
+    EXPECT_EQ(deserialized, tags);
+}
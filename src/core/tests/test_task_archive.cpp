@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "task_archive.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace pointless::core;
+
+namespace {
+
+std::string freshArchivePath(const std::string &name)
+{
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".idx");
+    return path.string();
+}
+
+Task completedTask(const std::string &title, int daysAgo)
+{
+    const auto now = std::chrono::system_clock::now();
+    Task task;
+    task.uuid = "archived_" + std::to_string(daysAgo);
+    task.title = title;
+    task.creationTimestamp = now - std::chrono::days(daysAgo + 30);
+    task.isDone = true;
+    task.completionDate = std::chrono::floor<std::chrono::milliseconds>(now - std::chrono::days(daysAgo));
+    return task;
+}
+
+std::vector<std::string> titles(const std::vector<TaskArchive::Entry> &entries)
+{
+    std::vector<std::string> result;
+    for (const auto &entry : entries) {
+        result.push_back(entry.title);
+    }
+    return result;
+}
+
+}
+
+TEST(TaskArchiveTest, SearchesTheIndexNewestFirst)
+{
+    const auto path = freshArchivePath("pointless_test_search.archive");
+    {
+        TaskArchive archive(path);
+        const std::vector<Task> first = { completedTask("Buy milk", 20), completedTask("Call plumber", 40) };
+        const std::vector<Task> second = { completedTask("Buy bread", 15) };
+        ASSERT_TRUE(archive.append(first));
+        ASSERT_TRUE(archive.append(second));
+        EXPECT_EQ(archive.taskCount().value_or(0), 3);
+    }
+
+    // A fresh instance reads the index back from disk
+    TaskArchive archive(path);
+    auto all = archive.search("");
+    ASSERT_TRUE(all.has_value());
+    EXPECT_EQ(titles(*all), (std::vector<std::string> { "Buy bread", "Buy milk", "Call plumber" }));
+
+    auto matches = archive.search("BUY");
+    ASSERT_TRUE(matches.has_value());
+    EXPECT_EQ(titles(*matches), (std::vector<std::string> { "Buy bread", "Buy milk" }));
+    EXPECT_NE((*matches)[0].batchOffset, (*matches)[1].batchOffset);
+
+    auto limited = archive.search("", 1);
+    ASSERT_TRUE(limited.has_value());
+    EXPECT_EQ(titles(*limited), (std::vector<std::string> { "Buy bread" }));
+}
+
+TEST(TaskArchiveTest, LoadsOnlyTheMatchingTasks)
+{
+    const auto path = freshArchivePath("pointless_test_load.archive");
+    TaskArchive archive(path);
+    const std::vector<Task> tasks = { completedTask("Renew passport", 30), completedTask("Water plants", 20) };
+    ASSERT_TRUE(archive.append(tasks));
+
+    auto matches = archive.search("passport");
+    ASSERT_TRUE(matches.has_value());
+    ASSERT_EQ(matches->size(), 1);
+
+    auto loaded = archive.loadTasks(*matches);
+    ASSERT_TRUE(loaded.has_value()) << loaded.error();
+    ASSERT_EQ(loaded->size(), 1);
+    EXPECT_EQ((*loaded)[0].uuid, tasks[0].uuid);
+    EXPECT_EQ((*loaded)[0].title, "Renew passport");
+    EXPECT_TRUE((*loaded)[0].isDone);
+}
+
+TEST(TaskArchiveTest, TornIndexTailIsDiscarded)
+{
+    const auto path = freshArchivePath("pointless_test_torn.archive");
+    {
+        TaskArchive archive(path);
+        const std::vector<Task> tasks = { completedTask("Kept", 20) };
+        ASSERT_TRUE(archive.append(tasks));
+    }
+
+    {
+        std::ofstream index(path + ".idx", std::ios::binary | std::ios::app);
+        // Header of a 64 byte frame, cut short
+        constexpr std::string_view torn("\x40\x00\x00\x00garbage", 11);
+        index.write(torn.data(), torn.size());
+    }
+
+    const auto tornSize = std::filesystem::file_size(path + ".idx");
+    TaskArchive archive(path);
+    EXPECT_EQ(archive.taskCount().value_or(0), 1);
+    ASSERT_TRUE(archive.search("Kept").has_value());
+    // Reading leaves the file alone, only append() cuts the tail off
+    EXPECT_EQ(std::filesystem::file_size(path + ".idx"), tornSize);
+
+    const std::vector<Task> more = { completedTask("Appended after", 10) };
+    ASSERT_TRUE(archive.append(more));
+
+    TaskArchive reopened(path);
+    auto all = reopened.search("");
+    ASSERT_TRUE(all.has_value());
+    EXPECT_EQ(titles(*all), (std::vector<std::string> { "Appended after", "Kept" }));
+}
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "data.h"
+#include "task_columns.h"
+#include "Clock.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace pointless::core;
+
+namespace {
+
+std::vector<uint32_t> positionsWhere(const Data &data, auto pred)
+{
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i < data.taskCount(); ++i) {
+        if (pred(data.taskAt(i)))
+            result.push_back(static_cast<uint32_t>(i));
+    }
+    return result;
+}
+
+Data randomData(std::chrono::system_clock::time_point now, size_t count)
+{
+    std::mt19937 rng(42); // NOLINT
+    Data data;
+    for (size_t i = 0; i < count; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.isDone = rng() % 3 == 0;
+        task.needsSyncToServer = rng() % 4 == 0;
+        task.isImportant = rng() % 5 == 0;
+        if (rng() % 4 == 0)
+            task.isYearly = rng() % 2 == 0;
+        if (rng() % 6 == 0)
+            task.tags = { BUILTIN_TAG_SOON };
+        else if (rng() % 6 == 0)
+            task.tags = { BUILTIN_TAG_CURRENT, "work" };
+
+        // Offsets away from millisecond and midnight boundaries
+        const auto offset = std::chrono::hours(static_cast<int>(rng() % 1200) - 600) + std::chrono::minutes(17);
+        if (rng() % 3 != 0)
+            task.dueDate = now + offset;
+        if (rng() % 3 != 0)
+            task.modificationTimestamp = now + offset - std::chrono::days(10);
+
+        data.addTask(task);
+    }
+    return data;
+}
+
+}
+
+TEST(TaskColumnsTest, RangeKernelMatchesScalar)
+{
+    std::mt19937_64 rng(7); // NOLINT
+    for (size_t size : { 0, 1, 63, 64, 65, 200, 1000 }) {
+        std::vector<int64_t> values(size);
+        for (auto &v : values) {
+            v = static_cast<int64_t>(rng() % 2000) - 1000;
+        }
+        values.push_back(TaskColumns::NoDueDate);
+        values.push_back(TaskColumns::NoModification);
+
+        std::vector<uint64_t> words((values.size() + 63) / 64, ~uint64_t(0));
+        ColumnKernels::intersectRange(values, -250, 500, words);
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            const bool expected = values[i] >= -250 && values[i] < 500;
+            EXPECT_EQ(((words[i / 64] >> (i % 64)) & 1) != 0, expected) << "size=" << size << " i=" << i << " kernel=" << ColumnKernels::rangeKernelName();
+        }
+    }
+}
+
+TEST(TaskColumnsTest, PositionRangeMasksTail)
+{
+    const std::vector<uint64_t> words = { 0b1010, 0 };
+    const PositionRange set(words, 70, false);
+    EXPECT_EQ(std::vector<size_t>(set.begin(), set.end()), (std::vector<size_t> { 1, 3 }));
+
+    const PositionRange cleared(words, 70, true);
+    const std::vector<size_t> positions(cleared.begin(), cleared.end());
+    EXPECT_EQ(positions.size(), 68);
+    EXPECT_EQ(positions.front(), 0);
+    EXPECT_EQ(positions.back(), 69);
+}
+
+TEST(TaskColumnsTest, SelectionsMatchTaskPredicates)
+{
+    const auto now = Clock::now();
+    const Data data = randomData(now, 300);
+    const auto &columns = data.columns();
+    ASSERT_EQ(columns.size(), data.taskCount());
+
+    EXPECT_EQ(data.selectCurrent(now).positions(), positionsWhere(data, [](const Task &t) { return t.isCurrent(); }));
+    EXPECT_EQ(data.selectSoon(now).positions(), positionsWhere(data, [](const Task &t) { return t.isSoon(); }));
+    EXPECT_EQ(data.selectLater(now).positions(), positionsWhere(data, [](const Task &t) { return t.isLater(); }));
+    EXPECT_EQ(data.selectOverdue(now).positions(), positionsWhere(data, [](const Task &t) { return t.isOverdue(); }));
+    EXPECT_EQ(TaskSelection::cleanupCandidates(columns, now).positions(), positionsWhere(data, [](const Task &t) { return t.shouldBeCleanedUp(); }));
+
+    TaskSelection hidden(columns);
+    hidden.with(TaskColumn::Done).without(TaskColumn::NeedsSyncToServer);
+    EXPECT_EQ(hidden.positions(), positionsWhere(data, [](const Task &t) { return t.isDone && !t.needsSyncToServer; }));
+    EXPECT_EQ(hidden.count(), hidden.positions().size());
+}
+
+TEST(TaskColumnsTest, ColumnsFollowDataMutations)
+{
+    Data data;
+    for (int i = 0; i < 70; ++i) {
+        Task task;
+        task.uuid = "task-" + std::to_string(i);
+        task.isImportant = i % 2 == 0;
+        data.addTask(task);
+    }
+
+    EXPECT_EQ(std::ranges::distance(data.importantTasksView()), 35);
+    EXPECT_EQ(std::ranges::distance(data.pendingTasksView()), 70);
+    EXPECT_EQ(std::ranges::distance(data.completedTasksView()), 0);
+
+    Task task = *data.taskForUuid("task-69");
+    task.isDone = true;
+    task.dueDate = Clock::now();
+    data.updateTask(task, true);
+    EXPECT_TRUE(data.columns().test(TaskColumn::Done, 69));
+    EXPECT_EQ(data.columns().dueDate(69), TaskColumns::toMilliseconds(*task.dueDate));
+    ASSERT_EQ(std::ranges::distance(data.completedTasksView()), 1);
+    EXPECT_EQ(data.completedTasksView().front().uuid, Uuid("task-69"));
+    EXPECT_EQ(std::ranges::distance(data.pendingTasksView()), 69);
+
+    data.removeTask("task-0");
+    EXPECT_EQ(data.columns().size(), 69);
+    EXPECT_EQ(std::ranges::distance(data.importantTasksView()), 34);
+    EXPECT_TRUE(data.columns().test(TaskColumn::Done, 68));
+    for (const Task &important : data.importantTasksView()) {
+        EXPECT_TRUE(important.isImportant);
+    }
+
+    data.clearServerSyncBits();
+    EXPECT_EQ(std::ranges::distance(data.newTasksView()), 0);
+
+    data.clearTasks();
+    EXPECT_EQ(data.columns().size(), 0);
+    EXPECT_TRUE(std::ranges::empty(data.pendingTasksView()));
+}
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "uuid.h"
+#include "task.h"
+
+#include <gtest/gtest.h>
+#include <glaze/glaze.hpp>
+
+#include <unordered_set>
+
+using namespace pointless::core;
+
+TEST(UuidTest, CanonicalRoundtrip)
+{
+    const std::string text = "3f2504e0-4f89-41d3-9a0c-0305e82c3301";
+    const Uuid uuid(text);
+    EXPECT_EQ(uuid.toString(), text);
+    EXPECT_EQ(uuid, Uuid(text));
+    EXPECT_NE(uuid, Uuid("3f2504e0-4f89-41d3-9a0c-0305e82c3302"));
+    EXPECT_FALSE(uuid.isEmpty());
+    EXPECT_EQ(fmt::format("{}", uuid), text);
+}
+
+TEST(UuidTest, NonCanonicalStringsAreKeptVerbatim)
+{
+    for (const char *text : { "task-1", "3F2504E0-4F89-41D3-9A0C-0305E82C3301",
+                              "00000000-0000-0000-0000-000000000000", "3f2504e0-4f89-41d3-ea0c-0305e82c3301" }) {
+        const Uuid uuid(text);
+        EXPECT_EQ(uuid.toString(), text);
+        EXPECT_EQ(uuid, Uuid(std::string(text)));
+        EXPECT_FALSE(uuid.isEmpty());
+    }
+
+    EXPECT_NE(Uuid("task-1"), Uuid("task-2"));
+    EXPECT_NE(Uuid("00000000-0000-0000-0000-000000000000"), Uuid());
+}
+
+TEST(UuidTest, UppercaseIsKeptVerbatim)
+{
+    const std::string text = "3F2504E0-4F89-41D3-9A0C-0305E82C3301";
+    const Uuid upper(text);
+    EXPECT_EQ(upper.toString(), text);
+    EXPECT_EQ(upper, Uuid(text));
+
+    // Like the other clients' string comparison
+    EXPECT_NE(upper, Uuid("3f2504e0-4f89-41d3-9a0c-0305e82c3301"));
+    EXPECT_NE(upper, Uuid("3f2504e0-4f89-41d3-9a0C-0305e82C3301"));
+
+    Task task;
+    task.uuid = upper;
+    auto json = glz::write_json(task);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_NE(json->find(R"("uuid":"3F2504E0-4F89-41D3-9A0C-0305E82C3301")"), std::string::npos);
+
+    Task deserialized;
+    EXPECT_FALSE(glz::read_json(deserialized, *json));
+    EXPECT_EQ(deserialized.uuid, upper);
+    EXPECT_EQ(glz::write_json(deserialized).value_or(""), *json);
+}
+
+TEST(UuidTest, EmptyAndHashing)
+{
+    EXPECT_TRUE(Uuid().isEmpty());
+    EXPECT_TRUE(Uuid("").isEmpty());
+    EXPECT_EQ(Uuid().toString(), "");
+
+    std::unordered_set<Uuid> set { Uuid("a"), Uuid("b"), Uuid("3f2504e0-4f89-41d3-9a0c-0305e82c3301") };
+    EXPECT_TRUE(set.contains(Uuid("a")));
+    EXPECT_TRUE(set.contains(Uuid("3f2504e0-4f89-41d3-9a0c-0305e82c3301")));
+    EXPECT_FALSE(set.contains(Uuid("c")));
+}
+
+TEST(UuidTest, JsonIsUnchanged)
+{
+    Task task;
+    task.uuid = "3f2504e0-4f89-41d3-9a0c-0305e82c3301";
+    task.parentUuid = "Parent-Uuid";
+
+    auto json = glz::write_json(task);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_NE(json->find(R"("uuid":"3f2504e0-4f89-41d3-9a0c-0305e82c3301")"), std::string::npos);
+    EXPECT_NE(json->find(R"("parentUuid":"Parent-Uuid")"), std::string::npos);
+
+    Task deserialized;
+    EXPECT_FALSE(glz::read_json(deserialized, *json));
+    EXPECT_EQ(deserialized.uuid, task.uuid);
+    EXPECT_EQ(deserialized.parentUuid, task.parentUuid);
+}
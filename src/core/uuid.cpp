@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "uuid.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace pointless::core;
+
+namespace {
+
+constexpr size_t kVariantByte = 8;
+constexpr uint8_t kInternedMarker = 0xE0; // RFC 4122 "reserved" variant, never produced by generators
+constexpr std::array<size_t, 4> kDashPositions = { 8, 13, 18, 23 };
+constexpr std::string_view kHexDigits = "0123456789abcdef";
+
+struct InternPool
+{
+    std::mutex mutex;
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, uint64_t> indexes;
+};
+
+InternPool &internPool()
+{
+    static InternPool pool;
+    return pool;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    // Uppercase ids are interned, the bytes alone would write them back in lowercase
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool parseCanonical(std::string_view str, std::array<uint8_t, 16> &bytes)
+{
+    if (str.size() != std::tuple_size_v<Uuid::TextBuffer>)
+        return false;
+
+    size_t byteIndex = 0;
+    for (size_t i = 0; i < str.size();) {
+        if (std::ranges::find(kDashPositions, i) != kDashPositions.end()) {
+            if (str[i] != '-')
+                return false;
+            ++i;
+            continue;
+        }
+
+        const int high = hexValue(str[i]);
+        const int low = hexValue(str[i + 1]);
+        if (high < 0 || low < 0)
+            return false;
+
+        bytes[byteIndex++] = static_cast<uint8_t>((high << 4) | low);
+        i += 2;
+    }
+
+    // The nil uuid and reserved variants can't be told apart from empty and interned values
+    if ((bytes[kVariantByte] & kInternedMarker) == kInternedMarker)
+        return false;
+    return std::ranges::any_of(bytes, [](uint8_t b) { return b != 0; });
+}
+
+uint64_t intern(std::string_view str)
+{
+    auto &pool = internPool();
+    std::lock_guard lock(pool.mutex);
+
+    if (auto it = pool.indexes.find(str); it != pool.indexes.end())
+        return it->second;
+
+    const uint64_t index = pool.strings.size();
+    const std::string &stored = pool.strings.emplace_back(str);
+    pool.indexes.emplace(stored, index);
+    return index;
+}
+
+std::string_view internedString(uint64_t index)
+{
+    auto &pool = internPool();
+    std::lock_guard lock(pool.mutex);
+    return pool.strings[index];
+}
+
+}
+
+Uuid::Uuid(std::string_view str)
+{
+    if (str.empty() || parseCanonical(str, _bytes))
+        return;
+
+    const uint64_t index = intern(str);
+    _bytes = {};
+    std::memcpy(_bytes.data(), &index, sizeof(index));
+    _bytes[kVariantByte] = kInternedMarker;
+}
+
+Uuid::Uuid(const std::string &str)
+    : Uuid(std::string_view(str))
+{
+}
+
+Uuid::Uuid(const char *str)
+    : Uuid(std::string_view(str))
+{
+}
+
+bool Uuid::isEmpty() const
+{
+    return *this == Uuid();
+}
+
+bool Uuid::isInterned() const
+{
+    return _bytes[kVariantByte] == kInternedMarker;
+}
+
+std::string Uuid::toString() const
+{
+    TextBuffer buffer;
+    return std::string(toStringView(buffer));
+}
+
+std::string_view Uuid::toStringView(TextBuffer &buffer) const
+{
+    if (isEmpty())
+        return {};
+
+    if (isInterned()) {
+        uint64_t index = 0;
+        std::memcpy(&index, _bytes.data(), sizeof(index));
+        return internedString(index);
+    }
+
+    size_t out = 0;
+    for (size_t i = 0; i < _bytes.size(); ++i) {
+        if (std::ranges::find(kDashPositions, out) != kDashPositions.end())
+            buffer[out++] = '-';
+        buffer[out++] = kHexDigits[_bytes[i] >> 4];
+        buffer[out++] = kHexDigits[_bytes[i] & 0x0F];
+    }
+    return { buffer.data(), buffer.size() };
+}
+
+size_t Uuid::hash() const
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+    std::memcpy(&low, _bytes.data(), sizeof(low));
+    std::memcpy(&high, _bytes.data() + sizeof(low), sizeof(high));
+    return static_cast<size_t>(low ^ (high * 0x9E3779B97F4A7C15ULL));
+}
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glaze/glaze.hpp>
+#include <spdlog/fmt/fmt.h>
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace pointless::core {
+
+/// 16 byte value type for task uuids.
+/// Canonical lowercase uuids are stored as their bytes. Any other string, uppercase uuids included
+/// (tests and older clients use arbitrary ids), is interned in a process-wide pool and stored as its
+/// pool index, so the text form always round-trips unchanged. Other clients compare ids as strings.
+/// The pool only grows, by one entry per distinct id, for the lifetime of the process.
+/// An empty string is the all-zero value.
+class Uuid
+{
+public:
+    using TextBuffer = std::array<char, 36>;
+
+    Uuid() = default;
+    Uuid(std::string_view str); // NOLINT(google-explicit-constructor)
+    Uuid(const std::string &str); // NOLINT(google-explicit-constructor)
+    Uuid(const char *str); // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] std::string toString() const;
+
+    /// Text form without allocating. Canonical uuids are written into @p buffer,
+    /// interned ones point into the pool, which is never freed.
+    [[nodiscard]] std::string_view toStringView(TextBuffer &buffer) const;
+
+    [[nodiscard]] size_t hash() const;
+
+    bool operator==(const Uuid &other) const = default;
+    auto operator<=>(const Uuid &other) const = default;
+
+private:
+    [[nodiscard]] bool isInterned() const;
+
+    std::array<uint8_t, 16> _bytes {};
+};
+
+static_assert(sizeof(Uuid) == 16);
+static_assert(std::is_trivially_copyable_v<Uuid>);
+
+}
+
+template<>
+struct std::hash<pointless::core::Uuid>
+{
+    size_t operator()(const pointless::core::Uuid &uuid) const noexcept
+    {
+        return uuid.hash();
+    }
+};
+
+template<>
+struct fmt::formatter<pointless::core::Uuid> : fmt::formatter<std::string_view>
+{
+    auto format(const pointless::core::Uuid &uuid, format_context &ctx) const -> decltype(ctx.out())
+    {
+        pointless::core::Uuid::TextBuffer buffer;
+        return fmt::formatter<std::string_view>::format(uuid.toStringView(buffer), ctx);
+    }
+};
+
+namespace glz {
+
+template<>
+struct from<JSON, pointless::core::Uuid>
+{
+    template<auto Opts>
+    static void op(pointless::core::Uuid &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::string str;
+        parse<JSON>::op<Opts>(str, ctx, it, end);
+        value = pointless::core::Uuid(str);
+    }
+};
+
+template<>
+struct to<JSON, pointless::core::Uuid>
+{
+    template<auto Opts>
+    static void op(const pointless::core::Uuid &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        pointless::core::Uuid::TextBuffer buffer;
+        serialize<JSON>::op<Opts>(value.toStringView(buffer), ctx, b, ix);
+    }
+};
+
+template<>
+struct from<BEVE, pointless::core::Uuid>
+{
+    template<auto Opts>
+    static void op(pointless::core::Uuid &value, is_context auto &&ctx, auto &&it, auto &&end)
+    {
+        std::string str;
+        parse<BEVE>::op<Opts>(str, ctx, it, end);
+        value = pointless::core::Uuid(str);
+    }
+};
+
+template<>
+struct to<BEVE, pointless::core::Uuid>
+{
+    template<auto Opts>
+    static void op(const pointless::core::Uuid &value, is_context auto &&ctx, auto &&b, auto &&ix) noexcept
+    {
+        pointless::core::Uuid::TextBuffer buffer;
+        serialize<BEVE>::op<Opts>(value.toStringView(buffer), ctx, b, ix);
+    }
+};
+
+}
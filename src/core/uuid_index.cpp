@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "uuid_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+using namespace pointless::core;
+
+namespace {
+constexpr size_t kMinCapacity = 16;
+}
+
+uint32_t UuidIndex::hashOf(const Uuid &uuid)
+{
+    const auto hash = uuid.hash();
+    return static_cast<uint32_t>(hash ^ (static_cast<uint64_t>(hash) >> 32U));
+}
+
+void UuidIndex::rebuild(const std::vector<Task> &tasks)
+{
+    clear();
+    reserveFor(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        insert(tasks, i);
+    }
+}
+
+void UuidIndex::insert(const std::vector<Task> &tasks, size_t position)
+{
+    const Uuid &uuid = tasks[position].uuid;
+
+    // On duplicate uuids the first one wins, like a linear search would
+    if (find(tasks, uuid).has_value())
+        return;
+
+    reserveFor(_size + 1);
+    insertSlot({ .hash = hashOf(uuid), .position = static_cast<uint32_t>(position) });
+    ++_size;
+}
+
+void UuidIndex::clear()
+{
+    _slots.clear();
+    _size = 0;
+}
+
+std::optional<size_t> UuidIndex::find(const std::vector<Task> &tasks, const Uuid &uuid) const
+{
+    if (_slots.empty())
+        return std::nullopt;
+
+    const uint32_t hash = hashOf(uuid);
+    const size_t mask = _slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot &slot = _slots[i];
+        if (slot.position == EmptySlot)
+            return std::nullopt;
+
+        if (slot.hash == hash && slot.position < tasks.size() && tasks[slot.position].uuid == uuid)
+            return slot.position;
+    }
+}
+
+size_t UuidIndex::size() const
+{
+    return _size;
+}
+
+void UuidIndex::reserveFor(size_t count)
+{
+    // Keep the load factor at or below 0.5 so probe sequences stay short
+    if (count * 2 <= _slots.size())
+        return;
+
+    const size_t capacity = std::max(kMinCapacity, std::bit_ceil(count * 2));
+    std::vector<Slot> oldSlots = std::exchange(_slots, std::vector<Slot>(capacity));
+    for (const Slot &slot : oldSlots) {
+        if (slot.position != EmptySlot)
+            insertSlot(slot);
+    }
+}
+
+void UuidIndex::insertSlot(Slot slot)
+{
+    const size_t mask = _slots.size() - 1;
+    size_t i = slot.hash & mask;
+    while (_slots[i].position != EmptySlot) {
+        i = (i + 1) & mask;
+    }
+    _slots[i] = slot;
+}
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "task.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace pointless::core {
+
+/// Open-addressing map from task uuid to its position in a task vector.
+/// Keys aren't stored, slots only hold a hash fragment and the position, the uuid is
+/// compared against the task vector that was indexed.
+class UuidIndex
+{
+public:
+    void rebuild(const std::vector<Task> &tasks);
+    void insert(const std::vector<Task> &tasks, size_t position);
+    void clear();
+
+    [[nodiscard]] std::optional<size_t> find(const std::vector<Task> &tasks, const Uuid &uuid) const;
+    [[nodiscard]] size_t size() const;
+
+private:
+    struct Slot
+    {
+        uint32_t hash = 0;
+        uint32_t position = EmptySlot;
+    };
+
+    static constexpr uint32_t EmptySlot = UINT32_MAX;
+
+    static uint32_t hashOf(const Uuid &uuid);
+    void reserveFor(size_t count);
+    void insertSlot(Slot slot);
+
+    std::vector<Slot> _slots;
+    size_t _size = 0;
+};
+
+}
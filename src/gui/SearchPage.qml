@@ -63,5 +63,46 @@ Page {
             showsTagsInSecondLine: true
             showsDate: true
         }
+
+        Text {
+            Layout.fillWidth: true
+            visible: archiveView.count > 0
+            text: "Archived"
+            color: Style.sectionTextColor
+            font.pixelSize: Style.sectionFontSize
+        }
+
+        ListView {
+            id: archiveView
+            Layout.fillWidth: true
+            Layout.preferredHeight: Math.min(contentHeight, root.height / 3)
+            visible: count > 0
+            clip: true
+            spacing: Style.fromPixel(4)
+
+            // Archived tasks aren't in the task model, they're looked up in the archive index on demand
+            model: root.visible ? GuiController.searchArchive(searchInput.text) : []
+
+            delegate: RowLayout {
+                id: archivedTask
+                required property var modelData
+                width: ListView.view.width
+                spacing: Style.fromPixel(8)
+
+                Text {
+                    Layout.fillWidth: true
+                    text: archivedTask.modelData.title
+                    color: Style.taskCompletedTextColor
+                    font.pixelSize: Style.fromPixel(14)
+                    elide: Text.ElideRight
+                }
+
+                Text {
+                    text: Qt.formatDate(archivedTask.modelData.completionDate, "d MMM yyyy")
+                    color: Style.taskSecondaryTextColor
+                    font.pixelSize: Style.fromPixel(12)
+                }
+            }
+        }
     }
 }
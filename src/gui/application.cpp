@@ -50,6 +50,15 @@ Application::Application(int &argc, char **argv, const QString &orgName, Options
     QCommandLineOption noRestoreAuthOption(QStringLiteral("no-restore-auth"), QStringLiteral("Do not restore authentication on startup"));
     parser.addOption(noRestoreAuthOption);
 
+    QCommandLineOption binarySnapshotOption(QStringLiteral("binary-snapshot"), QStringLiteral("Store local data as a binary snapshot instead of JSON"));
+    parser.addOption(binarySnapshotOption);
+
+    QCommandLineOption sqliteStorageOption(QStringLiteral("sqlite-storage"), QStringLiteral("Store local data in an SQLite database instead of a JSON file"));
+    parser.addOption(sqliteStorageOption);
+
+    QCommandLineOption deltaSyncOption(QStringLiteral("delta-sync"), QStringLiteral("Sync only changed tasks, every client of the account must use it"));
+    parser.addOption(deltaSyncOption);
+
     QCommandLineOption debugOption(QStringLiteral("debug"), QStringLiteral("Enable debug features"));
     parser.addOption(debugOption);
 
@@ -82,6 +91,19 @@ Application::Application(int &argc, char **argv, const QString &orgName, Options
             startupOptions = static_cast<unsigned int>(core::Context::StartupOption::None);
         }
 
+        // Startup time matters most on the Pi
+        if (parser.isSet(binarySnapshotOption) || GuiController::isYocto()) {
+            startupOptions |= static_cast<unsigned int>(core::Context::StartupOption::BinarySnapshot);
+        }
+
+        if (parser.isSet(sqliteStorageOption)) {
+            startupOptions |= static_cast<unsigned int>(core::Context::StartupOption::SqliteStorage);
+        }
+
+        if (parser.isSet(deltaSyncOption)) {
+            startupOptions |= static_cast<unsigned int>(core::Context::StartupOption::DeltaSync);
+        }
+
         core::Context::setContext(parser.isSet(testSupabaseOption) ? core::Context::defaultContextForSupabaseTesting(startupOptions)
                                                                    : core::Context::defaultContextForSupabaseRelease(startupOptions));
     }
@@ -2,10 +2,12 @@
 // SPDX-License-Identifier: MIT
 
 #include "data_controller.h"
+#include "data_file_watcher.h"
 #include "taskmodel.h"
 #include "tagmodel.h"
 
 #include "core/data_provider.h"
+#include "core/delta_sync.h"
 #include "core/logger.h"
 #include "core/context.h"
 #include "utils.h"
@@ -27,6 +29,7 @@ DataController::DataController(QObject *parent)
     , _dataProvider(IDataProvider::createProvider())
     , _taskModel(new TaskModel(this))
     , _tagModel(new TagModel(this))
+    , _dataFileWatcher(new DataFileWatcher(this))
     , _refreshWatcher(new QFutureWatcher<std::expected<core::Data, TraceableError>>(this))
     , _loginWatcher(new QFutureWatcher<bool>(this))
 {
@@ -39,12 +42,7 @@ DataController::DataController(QObject *parent)
             return;
         }
 
-        auto saveResult = _localData.save();
-        if (!saveResult) {
-            P_LOG_ERROR("Failed to save data to disk: {}", saveResult.error());
-        } else {
-            P_LOG_DEBUG("Data saved to disk");
-        }
+        _localData.saveInBackground();
     });
 
     _tokenCheckTimer.setInterval(std::chrono::minutes(5));
@@ -79,10 +77,17 @@ DataController::DataController(QObject *parent)
     });
     _tokenCheckTimer.start();
 
+    // rename_tag and friends edit the file while we're running
+    connect(_dataFileWatcher, &DataFileWatcher::changed, this, &DataController::onDataFileChanged);
+
     connect(_refreshWatcher, &QFutureWatcherBase::finished, this, [this] {
-        _isRefreshing = false;
+        const auto installed = installRefreshResult();
+        if (!installed) {
+            // waitForAsyncOperations() got to it first
+            return;
+        }
 
-        auto result = _refreshWatcher->result();
+        const auto &result = *installed;
         if (result) {
             P_LOG_INFO("Async refresh completed successfully");
             Q_EMIT refreshFinished(true, QString());
@@ -254,7 +259,7 @@ void DataController::setUserId(const std::string &userId)
 bool DataController::updateTask(const core::Task &task)
 {
     if (_localData.updateTask(task)) {
-        _saveToDiskTimer.start();
+        onTasksChanged(/*needsReset=*/false);
         return true;
     }
     return false;
@@ -263,7 +268,7 @@ bool DataController::updateTask(const core::Task &task)
 bool DataController::addTask(const pointless::core::Task &task)
 {
     if (_localData.addTask(task)) {
-        _saveToDiskTimer.start();
+        onTasksChanged(/*needsReset=*/false);
         return true;
     }
     return false;
@@ -276,7 +281,7 @@ bool DataController::addTag(const QString &tagName)
 
     pointless::core::Tag tag;
     tag.name = tagName.toStdString();
-    _localData.data().addTag(tag);
+    _localData.addTag(tag);
     _saveToDiskTimer.start();
     _tagModel->reload();
     return true;
@@ -299,7 +304,7 @@ bool DataController::removeTag(const QString &tagName)
 
 bool DataController::renameTag(const QString &oldName, const QString &newName)
 {
-    if (_localData.data().renameTag(oldName.toStdString(), newName.toStdString())) {
+    if (_localData.renameTag(oldName.toStdString(), newName.toStdString())) {
         _saveToDiskTimer.start();
         _tagModel->reload();
         _taskModel->reload();
@@ -311,8 +316,7 @@ bool DataController::renameTag(const QString &oldName, const QString &newName)
 bool DataController::removeTask(const QString &taskUuid)
 {
     if (_localData.removeTask(taskUuid.toStdString())) {
-        _saveToDiskTimer.start();
-        _taskModel->reload();
+        onTasksChanged(/*needsReset=*/true);
         return true;
     }
     return false;
@@ -321,25 +325,87 @@ bool DataController::removeTask(const QString &taskUuid)
 void DataController::cleanupOldData()
 {
     if (_localData.cleanupOldData() > 0) {
-        _saveToDiskTimer.start();
-        _taskModel->reload();
+        onTasksChanged(/*needsReset=*/true);
     }
 }
 
 void DataController::deleteCalendarTasks()
 {
     if (_localData.deleteCalendarTasks() > 0) {
-        _saveToDiskTimer.start();
-        _taskModel->reload();
+        onTasksChanged(/*needsReset=*/true);
     }
 }
 
 void DataController::deduplicateCalendarTasks()
 {
     if (_localData.deduplicateCalendarTasks() > 0) {
-        _saveToDiskTimer.start();
-        _taskModel->reload();
+        onTasksChanged(/*needsReset=*/true);
+    }
+}
+
+void DataController::beginBatch()
+{
+    _localData.beginBatch();
+}
+
+void DataController::commitBatch()
+{
+    const size_t editCount = _localData.commit();
+    if (editCount > 0) {
+        P_LOG_DEBUG("Committed batch of {} edits", editCount);
+        onTasksChanged(/*needsReset=*/true);
+    }
+}
+
+bool DataController::isBatching() const
+{
+    return _localData.isBatching();
+}
+
+int DataController::pendingChangeCount() const
+{
+    return static_cast<int>(_localData.data().pendingChangeCount());
+}
+
+void DataController::onDataFileChanged()
+{
+    auto changes = _localData.readFileChanges();
+    if (!changes) {
+        P_LOG_WARNING_NOABORT("Failed to read changes to the data file: {}", changes.error());
+        return;
+    }
+
+    if (changes->isEmpty())
+        return;
+
+    P_LOG_INFO("Data file changed on disk, addedTasks={}, updatedTasks={}, removedTasks={}, addedTags={}, removedTags={}", changes->addedTasks.size(),
+               changes->updatedTasks.size(), changes->removedTasks.size(), changes->addedTags.size(), changes->removedTags.size());
+
+    _taskModel->applyFileChanges(*changes);
+
+    if (!changes->addedTags.empty() || !changes->removedTags.empty()) {
+        for (const auto &tag : changes->addedTags) {
+            _localData.addTag(tag);
+        }
+        for (const auto &tagName : changes->removedTags) {
+            _localData.removeTag(tagName);
+        }
+        _tagModel->reload();
     }
+
+    // Logged right away, so the next change to the file isn't mistaken for unsaved local edits
+    _localData.saveInBackground();
+}
+
+void DataController::onTasksChanged(bool needsReset)
+{
+    // commitBatch() does it once for the whole batch
+    if (_localData.isBatching())
+        return;
+
+    _saveToDiskTimer.start();
+    if (needsReset)
+        _taskModel->reload();
 }
 
 std::expected<core::Data, TraceableError> DataController::pullRemoteData()
@@ -370,10 +436,36 @@ std::expected<core::Data, TraceableError> DataController::pullRemoteData()
 
     // in case it got to the server somehow
     result->clearServerSyncBits();
+    result->remoteDocumentVersion = _dataProvider->documentVersion();
 
     return *result;
 }
 
+std::optional<core::Data> DataController::unchangedRemoteData(const core::Data &localData)
+{
+    if (localData.remoteDocumentVersion.empty()) {
+        return std::nullopt;
+    }
+
+    // Pulled or pushed by any client, the version changes with the contents, so a match means
+    // the server still has exactly what the local data was synced with
+    auto version = _dataProvider->pullDocumentVersion();
+    if (!version) {
+        P_LOG_INFO("Pulling the document, probe failed: {}", version.error().toString());
+        return std::nullopt;
+    }
+
+    if (*version != localData.remoteDocumentVersion) {
+        P_LOG_INFO("Pulling the document, remote.version={} local.version={}", *version, localData.remoteDocumentVersion);
+        return std::nullopt;
+    }
+
+    P_LOG_INFO("Remote is unchanged at revision {}, skipping the download", localData.revision());
+    core::Data remoteData = core::serverViewOf(localData);
+    remoteData.remoteDocumentVersion = *version;
+    return remoteData;
+}
+
 std::expected<core::Data, TraceableError> DataController::pushRemoteData(core::Data data)
 {
     data.clearServerSyncBits();
@@ -383,21 +475,110 @@ std::expected<core::Data, TraceableError> DataController::pushRemoteData(core::D
         return TraceableError::create("Not authenticated");
     }
 
-    auto jsonStrResult = data.toJson();
-    if (!jsonStrResult) {
-        return TraceableError::create("Failed to serialize data to JSON: " + jsonStrResult.error());
-    }
-
-    const auto &jsonStr = jsonStrResult.value();
-    auto result = _dataProvider->pushData(jsonStr);
+    // Serialized in chunks straight into the provider, never as one big string
+    auto result = _dataProvider->pushDocument([&data](core::OutputSink &sink) { return data.writeJson(sink); });
     if (!result) {
         return TraceableError::create("Failed to push data to remote", result.error());
     }
+    data.remoteDocumentVersion = _dataProvider->documentVersion();
 
-    P_LOG_INFO("Data pushed to remote successfully {} bytes", jsonStr.size());
+    P_LOG_INFO("Data pushed to remote successfully, numTasks={}", data.taskCount());
     return data;
 }
 
+std::expected<core::Data, TraceableError> DataController::pushFullRemoteData(core::Data data)
+{
+    if (!core::Context::self().deltaSync()) {
+        return pushRemoteData(std::move(data));
+    }
+
+    // The marker claims the revision in the change log first, so a concurrent delta push conflicts
+    // instead of landing in a log that the new document doesn't include
+    core::ChangeSet marker;
+    marker.revision = data.revision() + 1;
+    marker.snapshot = true;
+    if (auto result = _dataProvider->pushChanges(marker); !result) {
+        return TraceableError::create("Failed to claim revision for the whole document", result.error());
+    }
+
+    auto pushed = pushRemoteData(std::move(data));
+    if (!pushed) {
+        return pushed;
+    }
+
+    // The document has all of it now, leftovers are harmless, pruning is retried at the next compaction
+    if (auto result = _dataProvider->pruneChanges(pushed->revision()); !result) {
+        P_LOG_WARNING_NOABORT("Failed to prune the change log: {}", result.error().toString());
+    }
+
+    return pushed;
+}
+
+std::expected<void, TraceableError> DataController::applyRemoteChanges(core::Data &data)
+{
+    auto changes = _dataProvider->pullChanges(data.revision());
+    if (!changes) {
+        return std::unexpected(changes.error());
+    }
+
+    if (auto result = core::applyChangeSets(data, *changes); !result) {
+        return TraceableError::create(result.error());
+    }
+
+    return {};
+}
+
+std::expected<core::Data, TraceableError> DataController::pullRemoteChanges(const core::Data &localData)
+{
+    if (localData.revision() >= 0) {
+        core::Data remoteData = core::serverViewOf(localData);
+        auto result = applyRemoteChanges(remoteData);
+        if (result) {
+            P_LOG_INFO("Pulled changes from revision {} to {}", localData.revision(), remoteData.revision());
+            return remoteData;
+        }
+
+        P_LOG_INFO("Pulling the whole document instead of changes: {}", result.error().toString());
+    }
+
+    // Bootstrap, then catch up with what was pushed after the document
+    auto remoteData = pullRemoteData();
+    if (!remoteData) {
+        return remoteData;
+    }
+
+    if (auto result = applyRemoteChanges(*remoteData); !result) {
+        return TraceableError::create("Failed to catch up with the change log", result.error());
+    }
+
+    return remoteData;
+}
+
+std::expected<core::Data, TraceableError> DataController::pushRemoteChanges(const core::Data &remoteData, core::Data mergedData, const core::Data &localData)
+{
+    // Keeps the log short and the document fresh for clients that bootstrap
+    if ((mergedData.revision() + 1) % core::DELTA_SYNC_COMPACTION_INTERVAL == 0) {
+        return pushFullRemoteData(std::move(mergedData));
+    }
+
+    core::ChangeSet changes = core::changeSetBetween(remoteData, mergedData, localData);
+    if (changes.isEmpty()) {
+        return mergedData;
+    }
+
+    changes.revision = mergedData.revision() + 1;
+    if (auto result = _dataProvider->pushChanges(changes); !result) {
+        return TraceableError::create("Failed to push changes to remote", result.error());
+    }
+
+    mergedData.clearServerSyncBits();
+    mergedData.setRevision(changes.revision);
+
+    P_LOG_INFO("Changes pushed to remote successfully, revision={}, numTasks={}, numDeletedTasks={}",
+               changes.revision, changes.tasks.size(), changes.deletedTaskUuids.size());
+    return mergedData;
+}
+
 std::expected<void, TraceableError> DataController::refresh(bool isOfflineMode)
 {
     // Concurrency control: Don't allow multiple simultaneous refreshes
@@ -415,6 +596,7 @@ std::expected<void, TraceableError> DataController::refresh(bool isOfflineMode)
             _isRefreshing = false;
             return TraceableError::create("Failed to load local data", localDataResult.error());
         }
+        _dataFileWatcher->setFiles(_localData.watchedFiles());
     }
 
     if (isOfflineMode) {
@@ -432,9 +614,10 @@ std::expected<void, TraceableError> DataController::refresh(bool isOfflineMode)
 
     Q_EMIT refreshStarted();
 
-    // Launch async refresh
+    // The background thread only sees this immutable snapshot, edits done meanwhile are
+    // journaled and replayed on top of the merged result
     QFuture<std::expected<core::Data, TraceableError>> future =
-        QtConcurrent::run(&DataController::performRefreshInBackground, this);
+        QtConcurrent::run(&DataController::performRefreshInBackground, this, _localData.beginRebase());
 
     _refreshWatcher->setFuture(future);
 
@@ -453,12 +636,18 @@ std::expected<core::Data, TraceableError> DataController::refreshBlocking()
         if (!localDataResult) {
             return TraceableError::create("Failed to load local data", localDataResult.error());
         }
+        _dataFileWatcher->setFiles(_localData.watchedFiles());
     }
 
     Q_EMIT refreshStarted();
 
     // Call the background method directly (synchronously)
-    auto result = performRefreshInBackground();
+    auto result = performRefreshInBackground(_localData.beginRebase());
+    if (!result) {
+        _localData.abortRebase();
+    } else if (auto installResult = installMergedData(*result); !installResult) {
+        result = std::unexpected(installResult.error());
+    }
 
     // Reload models on main thread
     if (result) {
@@ -487,26 +676,41 @@ bool DataController::loginBlocking(const std::string &email, const std::string &
 }
 #endif
 
-std::expected<core::Data, TraceableError> DataController::performRefreshInBackground()
+std::expected<core::Data, TraceableError> DataController::performRefreshInBackground(std::shared_ptr<const core::Data> localData)
 {
     // This runs in a BACKGROUND thread
-    // Do NOT touch Qt models or QML-exposed objects here!
+    // Do NOT touch Qt models, QML-exposed objects or _localData here!
 
     P_LOG_INFO("Starting async refresh in background thread");
 
     // Network operations (safe in background thread)
-    auto remoteDataResult = pullRemoteData();
-    auto mergedResult = merge(remoteDataResult ? std::make_optional(*remoteDataResult) : std::nullopt);
+    // The change log is already small, the document is probed first so an unchanged one isn't downloaded
+    const bool deltaSync = core::Context::self().deltaSync();
+    std::optional<core::Data> remoteData = deltaSync ? std::nullopt : unchangedRemoteData(*localData);
+    if (!remoteData) {
+        auto remoteDataResult = deltaSync ? pullRemoteChanges(*localData) : pullRemoteData();
+        if (remoteDataResult) {
+            remoteData = std::move(*remoteDataResult);
+        }
+    }
+
+    auto mergedResult = merge(*localData, remoteData);
     if (!mergedResult) {
         return mergedResult;
     }
 
     auto mergedData = *mergedResult;
 
+    // Whichever side the merge started from, it's now based on the remote. A push replaces it.
+    // With delta sync the document lags behind the change log, it's never compared
+    mergedData.remoteDocumentVersion = remoteData && !deltaSync ? remoteData->remoteDocumentVersion : std::string();
+
     const bool needsLocalSave = mergedData.needsLocalSave; // since it's overwritten by push
 
     if (mergedData.needsUpload) {
-        auto pushResult = pushRemoteData(mergedData);
+        // Without anything on the server there's nothing to diff against
+        auto pushResult = deltaSync && remoteData ? pushRemoteChanges(*remoteData, mergedData, *localData)
+                                                  : pushFullRemoteData(mergedData);
         if (pushResult) {
             mergedData = *pushResult;
         } else {
@@ -514,32 +718,53 @@ std::expected<core::Data, TraceableError> DataController::performRefreshInBackgr
         }
     }
 
-    if (needsLocalSave) {
-        auto saveResult = _localData.setDataAndSave(mergedData);
-        if (!saveResult) {
-            return TraceableError::create("Failed to save local data: " + saveResult.error());
-        }
-    }
+    mergedData.needsLocalSave = needsLocalSave;
 
-    // Model reload happens in QFutureWatcher::finished() on MAIN thread
+    // Installing into _localData, saving and model reload happen on the MAIN thread
     return mergedData;
 }
 
-std::expected<core::Data, TraceableError> DataController::merge(const std::optional<core::Data> &remoteDataOpt)
+std::optional<std::expected<void, TraceableError>> DataController::installRefreshResult()
+{
+    if (!_isRefreshing.exchange(false)) {
+        return std::nullopt;
+    }
+
+    auto mergedResult = _refreshWatcher->result();
+    if (!mergedResult) {
+        _localData.abortRebase();
+        return std::unexpected(mergedResult.error());
+    }
+
+    return installMergedData(std::move(*mergedResult));
+}
+
+std::expected<void, TraceableError> DataController::installMergedData(core::Data mergedData)
+{
+    _localData.finishRebase(std::move(mergedData));
+    if (_localData.data().needsLocalSave) {
+        // Write errors are logged by the saver, the next save retries with a full snapshot
+        _localData.saveInBackground();
+    }
+
+    return {};
+}
+
+std::expected<core::Data, TraceableError> DataController::merge(const core::Data &localData, const std::optional<core::Data> &remoteDataOpt)
 {
-    core::Data &localData = _localData.data();
     P_LOG_INFO("local.numTasks={}, local.revision={}, local.numModifiedTasks={}, local.numDeletedTasks={}, remoteData.has_value={}",
-               localData.taskCount(), localData.revision(), localData.modifiedTasks().size(), localData._data.deletedTaskUuids.size(), remoteDataOpt.has_value());
+               localData.taskCount(), localData.revision(), localData.modifiedTaskCount(), localData.deletedTaskUuids().size(), remoteDataOpt.has_value());
 
     if (!remoteDataOpt.has_value()) {
         // #1. There's no remote data. Reset revision and use local data.
-        localData.setRevision(0);
-        localData.clearServerSyncBits();
-        localData.needsUpload = true;
-        localData.needsLocalSave = true;
+        core::Data result = localData;
+        result.setRevision(0);
+        result.clearServerSyncBits();
+        result.needsUpload = true;
+        result.needsLocalSave = true;
 
         P_LOG_INFO("No remote data, using local data");
-        return localData;
+        return result;
     }
 
     core::Data remoteData = *remoteDataOpt;
@@ -584,8 +809,7 @@ std::expected<core::Data, TraceableError> DataController::merge(const std::optio
     }
 
     // 5. Add new tasks
-    auto newTasks = localData.newTasks();
-    for (const auto &newLocalTask : newTasks) {
+    for (const auto &newLocalTask : localData.newTasksView()) {
         if (!remoteData.getTask(newLocalTask.uuid)) {
             core::Task newTask = newLocalTask;
             newTask.revision = 0;
@@ -598,8 +822,8 @@ std::expected<core::Data, TraceableError> DataController::merge(const std::optio
     }
 
     // 6. Merge modified tasks
-    auto modifiedTasks = localData.modifiedTasks();
-    for (auto &localTask : modifiedTasks) {
+    for (const auto &modifiedLocalTask : localData.modifiedTasksView()) {
+        core::Task localTask = modifiedLocalTask;
         auto remoteTaskOpt = remoteData.getTask(localTask.uuid);
         localTask.needsSyncToServer = false;
         if (remoteTaskOpt) {
@@ -627,17 +851,16 @@ std::expected<core::Data, TraceableError> DataController::merge(const std::optio
         }
     }
 
-    // 7. deletedTasks
-    for (const auto &deletedTaskUuid : localData._data.deletedTaskUuids) {
-        if (remoteData.removeTask(deletedTaskUuid)) {
-            remoteData.needsLocalSave = true;
-            remoteData.needsUpload = true;
-            P_LOG_DEBUG("Deleted task '{}' from remote data", deletedTaskUuid);
-        }
+    // 7. deletedTasks, in one pass
+    const auto deletedFromRemote = remoteData.removeTasks(localData.deletedTaskUuids());
+    if (!deletedFromRemote.empty()) {
+        remoteData.needsLocalSave = true;
+        remoteData.needsUpload = true;
+        P_LOG_DEBUG("Deleted {} tasks from remote data", deletedFromRemote.size());
     }
 
     // 8. deleteTags
-    for (const auto &deletedTagName : localData._data.deletedTagNames) {
+    for (const auto &deletedTagName : localData.deletedTagNames()) {
         if (remoteData.removeTag(deletedTagName)) {
             remoteData.needsLocalSave = true;
             remoteData.needsUpload = true;
@@ -672,27 +895,12 @@ TagModel *DataController::tagModel() const
 
 int DataController::taskCountForTag(const QString &tagName) const
 {
-    const std::string name = tagName.toStdString();
-    int count = 0;
-    for (size_t i = 0; i < _localData.taskCount(); ++i) {
-        if (_localData.taskAt(i).containsTag(name))
-            ++count;
-    }
-    return count;
+    return _localData.data().taskCountForTag(tagName.toStdString());
 }
 
 int DataController::visibleTaskCountForTag(const QString &tagName) const
 {
-    const std::string name = tagName.toStdString();
-    int count = 0;
-    for (size_t i = 0; i < _localData.taskCount(); ++i) {
-        const auto &task = _localData.taskAt(i);
-        if ((task.isDone && !task.needsSyncToServer) || task.isGoal)
-            continue;
-        if (task.containsTag(name))
-            ++count;
-    }
-    return count;
+    return _localData.data().visibleTaskCountForTag(tagName.toStdString());
 }
 
 bool DataController::containsTag(const QString &tagName) const
@@ -710,9 +918,24 @@ void DataController::waitForAsyncOperations()
     if (_isRefreshing) {
         P_LOG_INFO("Waiting for refresh to finish...");
         _refreshWatcher->waitForFinished();
+
+        // The finished slot won't run anymore. What was merged and pushed must still be installed
+        // and saved, or the local tombstones and sync bits fall out of step with the server
+        if (auto installed = installRefreshResult(); installed && !*installed) {
+            P_LOG_ERROR("Refresh failed while exiting: {}", installed->error().toString());
+        }
     }
     if (_isLoggingIn) {
         P_LOG_INFO("Waiting for login to finish...");
         _loginWatcher->waitForFinished();
     }
+
+    // Saves queued by the timer, or still waiting for it, must reach the disk before exit
+    if (_localData.data().needsLocalSave) {
+        _saveToDiskTimer.stop();
+        _localData.saveInBackground();
+    }
+    if (auto result = _localData.flushSaves(); !result) {
+        P_LOG_ERROR("Failed to save data to disk: {}", result.error());
+    }
 }
@@ -19,8 +19,10 @@
 
 #include <atomic>
 #include <expected>
+#include <memory>
 #include <optional>
 
+class DataFileWatcher;
 class TaskModel;
 class TagModel;
 
@@ -55,6 +57,14 @@ public:
     void deleteCalendarTasks();
     void deduplicateCalendarTasks();
 
+    /// Groups task edits so the task model is reset and the save scheduled once, at commitBatch()
+    void beginBatch();
+    void commitBatch();
+    [[nodiscard]] bool isBatching() const;
+
+    /// Local edits not yet synced to the server
+    [[nodiscard]] Q_INVOKABLE int pendingChangeCount() const;
+
     pointless::core::LocalData &localData();
     LocalSettings &localSettings();
 
@@ -89,9 +99,20 @@ private:
 #endif
     std::expected<pointless::core::Data, TraceableError> pushRemoteData(pointless::core::Data data);
     std::expected<pointless::core::Data, TraceableError> pullRemoteData();
-    std::expected<pointless::core::Data, TraceableError> merge(const std::optional<pointless::core::Data> &remoteData);
-    std::expected<pointless::core::Data, TraceableError> performRefreshInBackground();
+    std::optional<pointless::core::Data> unchangedRemoteData(const pointless::core::Data &localData);
+    std::expected<pointless::core::Data, TraceableError> pushFullRemoteData(pointless::core::Data data);
+    std::expected<pointless::core::Data, TraceableError> pullRemoteChanges(const pointless::core::Data &localData);
+    std::expected<pointless::core::Data, TraceableError> pushRemoteChanges(const pointless::core::Data &remoteData, pointless::core::Data mergedData, const pointless::core::Data &localData);
+    std::expected<void, TraceableError> applyRemoteChanges(pointless::core::Data &data);
+    std::expected<pointless::core::Data, TraceableError> merge(const pointless::core::Data &localData, const std::optional<pointless::core::Data> &remoteData);
+    std::expected<pointless::core::Data, TraceableError> performRefreshInBackground(std::shared_ptr<const pointless::core::Data> localData);
+    std::expected<void, TraceableError> installMergedData(pointless::core::Data mergedData);
+
+    /// Installs the finished background refresh once, nullopt if that already happened
+    std::optional<std::expected<void, TraceableError>> installRefreshResult();
     bool performLoginSync(const std::string &email, const std::string &password);
+    void onTasksChanged(bool needsReset);
+    void onDataFileChanged();
     pointless::core::LocalData _localData;
     LocalSettings _localSettings;
     std::unique_ptr<IDataProvider> _dataProvider;
@@ -99,6 +120,7 @@ private:
     TagModel *_tagModel = nullptr;
     QTimer _saveToDiskTimer;
     QTimer _tokenCheckTimer;
+    DataFileWatcher *_dataFileWatcher = nullptr;
     QFutureWatcher<std::expected<pointless::core::Data, TraceableError>> *_refreshWatcher = nullptr;
     std::atomic<bool> _isRefreshing { false };
     QFutureWatcher<bool> *_loginWatcher = nullptr;
@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#include "data_file_watcher.h"
+#include "qt_logger.h"
+#include "core/logger.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#endif
+
+#include <chrono>
+#include <utility>
+
+DataFileWatcher::DataFileWatcher(QObject *parent)
+    : QObject(parent)
+{
+    // Saves write a temp file and rename it, tools rewrite in place, the log is appended to
+    _debounceTimer.setInterval(std::chrono::milliseconds(200));
+    _debounceTimer.setSingleShot(true);
+    connect(&_debounceTimer, &QTimer::timeout, this, &DataFileWatcher::changed);
+}
+
+DataFileWatcher::~DataFileWatcher()
+{
+    stopWatching();
+}
+
+void DataFileWatcher::setFiles(const std::vector<std::string> &paths)
+{
+    QSet<QString> absolutePaths;
+    QSet<QString> directories;
+    for (const auto &path : paths) {
+        const QFileInfo info(QString::fromStdString(path));
+        absolutePaths.insert(info.absoluteFilePath());
+        directories.insert(info.absolutePath());
+    }
+
+    if (absolutePaths == _paths)
+        return;
+
+    stopWatching();
+    _paths = absolutePaths;
+    if (_paths.isEmpty())
+        return;
+
+    if (!watchWithInotify(directories))
+        watchWithFallback(directories);
+}
+
+bool DataFileWatcher::watchWithInotify(const QSet<QString> &directories)
+{
+#ifdef Q_OS_LINUX
+    _inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyFd < 0) {
+        P_LOG_WARNING_NOABORT("inotify unavailable, errno={}", errno);
+        return false;
+    }
+
+    for (const QString &directory : directories) {
+        const QByteArray encoded = QFile::encodeName(directory);
+        const int descriptor = ::inotify_add_watch(_inotifyFd, encoded.constData(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE);
+        if (descriptor < 0) {
+            P_LOG_WARNING_NOABORT("Failed to watch {} with inotify, errno={}", directory, errno);
+            stopWatching();
+            return false;
+        }
+        _inotifyDirectories.insert(descriptor, directory);
+    }
+
+    _inotifyNotifier = new QSocketNotifier(_inotifyFd, QSocketNotifier::Read, this);
+    connect(_inotifyNotifier, &QSocketNotifier::activated, this, &DataFileWatcher::readInotifyEvents);
+    return true;
+#else
+    Q_UNUSED(directories)
+    return false;
+#endif
+}
+
+void DataFileWatcher::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    // Events name the file relative to the directory their watch descriptor is for
+    alignas(inotify_event) std::array<char, 4096> buffer {};
+    while (true) {
+        const ssize_t length = ::read(_inotifyFd, buffer.data(), buffer.size());
+        if (length <= 0)
+            break;
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset); // NOLINT
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            // The queue dropped events, any of them could have been ours
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                P_LOG_INFO("inotify queue overflowed, assuming the data files changed");
+                _debounceTimer.start();
+                continue;
+            }
+
+            const auto directory = _inotifyDirectories.constFind(event->wd);
+            if (event->len == 0 || directory == _inotifyDirectories.cend())
+                continue;
+
+            // Files in different directories can share a name
+            if (_paths.contains(*directory + QLatin1Char('/') + QFile::decodeName(event->name)))
+                _debounceTimer.start();
+        }
+    }
+#endif
+}
+
+void DataFileWatcher::watchWithFallback(const QSet<QString> &directories)
+{
+    _fallbackWatcher = new QFileSystemWatcher(this);
+    _fallbackWatcher->addPaths(directories.values());
+    for (const QString &path : std::as_const(_paths)) {
+        if (QFileInfo::exists(path))
+            _fallbackWatcher->addPath(path);
+    }
+
+    connect(_fallbackWatcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        // A file replaced by a rename stops being watched
+        if (QFileInfo::exists(path) && !_fallbackWatcher->files().contains(path))
+            _fallbackWatcher->addPath(path);
+        _debounceTimer.start();
+    });
+
+    connect(_fallbackWatcher, &QFileSystemWatcher::directoryChanged, this, [this] {
+        for (const QString &path : std::as_const(_paths)) {
+            if (QFileInfo::exists(path) && !_fallbackWatcher->files().contains(path)) {
+                _fallbackWatcher->addPath(path);
+                _debounceTimer.start();
+            }
+        }
+    });
+}
+
+void DataFileWatcher::stopWatching()
+{
+    _debounceTimer.stop();
+
+    delete _inotifyNotifier;
+    _inotifyNotifier = nullptr;
+#ifdef Q_OS_LINUX
+    if (_inotifyFd >= 0) {
+        ::close(_inotifyFd);
+        _inotifyFd = -1;
+    }
+#endif
+    _inotifyDirectories.clear();
+
+    delete _fallbackWatcher;
+    _fallbackWatcher = nullptr;
+}
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 Sergio Martins
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include <string>
+#include <vector>
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+
+/// Tells when files are written by anyone, us included. Uses inotify on Linux and
+/// QFileSystemWatcher elsewhere. The parent directories are watched as well, so files
+/// replaced by a rename or created later are still seen
+class DataFileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DataFileWatcher(QObject *parent = nullptr);
+    ~DataFileWatcher() override;
+
+    DataFileWatcher(const DataFileWatcher &) = delete;
+    DataFileWatcher &operator=(const DataFileWatcher &) = delete;
+    DataFileWatcher(DataFileWatcher &&) = delete;
+    DataFileWatcher &operator=(DataFileWatcher &&) = delete;
+
+    /// Replaces the watched files, an empty list stops watching
+    void setFiles(const std::vector<std::string> &paths);
+
+Q_SIGNALS:
+    /// Once per burst of writes
+    void changed();
+
+private:
+    bool watchWithInotify(const QSet<QString> &directories);
+    void readInotifyEvents();
+    void watchWithFallback(const QSet<QString> &directories);
+    void stopWatching();
+
+    QSet<QString> _paths;
+    QTimer _debounceTimer;
+
+    int _inotifyFd = -1;
+    QHash<int, QString> _inotifyDirectories; // By watch descriptor
+    QSocketNotifier *_inotifyNotifier = nullptr;
+    QFileSystemWatcher *_fallbackWatcher = nullptr;
+};
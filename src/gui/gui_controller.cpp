@@ -46,6 +46,7 @@
 
 #include <cstdlib>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <chrono>
 
@@ -213,19 +214,17 @@ GuiController::GuiController(QObject *parent)
 
             P_LOG_INFO("Fetched {} calendar events", static_cast<int>(events.size()));
 
-            const auto allTasks = _dataController->localData().data().getAllTasks();
+            // Looked up once, instead of scanning all tasks for every event
+            std::unordered_set<std::string> knownEventIds;
+            for (const auto &task : std::as_const(_dataController->localData()).data().tasks()) {
+                if (task.uuidInDeviceCalendar)
+                    knownEventIds.insert(*task.uuidInDeviceCalendar);
+            }
 
+            _dataController->beginBatch();
             int addedCount = 0;
             for (const auto &event : events) {
-                bool alreadyImported = false;
-                for (const auto &task : allTasks) {
-                    if (task.uuidInDeviceCalendar.has_value() && *task.uuidInDeviceCalendar == event.eventId) {
-                        alreadyImported = true;
-                        break;
-                    }
-                }
-
-                if (alreadyImported) {
+                if (!knownEventIds.insert(event.eventId).second) {
                     continue;
                 }
 
@@ -244,10 +243,13 @@ GuiController::GuiController(QObject *parent)
             P_LOG_INFO("Added {} new tasks from calendar events", addedCount);
 
             _dataController->deduplicateCalendarTasks();
+            _dataController->commitBatch();
 
             _fetchCalendarStatusText = QStringLiteral("Fetched %1 events, added %2").arg(events.size()).arg(addedCount);
             Q_EMIT fetchCalendarStatusTextChanged();
         } catch (const std::exception &e) {
+            if (_dataController->isBatching())
+                _dataController->commitBatch();
             P_LOG_ERROR("Failed to fetch calendar events: {}", e.what());
             _fetchCalendarStatusText = QStringLiteral("Error fetching calendar events");
             Q_EMIT fetchCalendarStatusTextChanged();
@@ -867,16 +869,18 @@ void GuiController::saveTask(QString title, const QString &tag, bool isEvening,
         task->uuid = QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
         // Set default context tags for new tasks
         if (_currentViewType == ViewType::Soon) {
-            task->tags.emplace_back("soon");
+            task->addTag(core::BUILTIN_TAG_SOON);
         } else if (_currentViewType == ViewType::Week) {
-            task->tags.emplace_back("current");
+            task->addTag(core::BUILTIN_TAG_CURRENT);
         }
     } else {
-        task = taskModel()->taskForUuid(_uuidBeingEdited);
-        if (task == nullptr) {
+        const auto *existingTask = taskModel()->taskForUuid(_uuidBeingEdited);
+        if (existingTask == nullptr) {
             P_LOG_ERROR("Task not found for UUID: {}", _uuidBeingEdited.toStdString());
             return;
         }
+        newTask = *existingTask;
+        task = &newTask;
     }
 
     task->title = processedTitle.toStdString();
@@ -962,6 +966,30 @@ int GuiController::numTasks() const
     return static_cast<int>(_dataController->localData().taskCount());
 }
 
+QVariantList GuiController::searchArchive(const QString &query) const
+{
+    constexpr size_t MaxResults = 50;
+
+    QVariantList result;
+    if (query.trimmed().isEmpty())
+        return result;
+
+    auto entries = _dataController->localData().archive().search(query.trimmed().toStdString(), MaxResults);
+    if (!entries) {
+        P_LOG_ERROR("Failed to search the archive: {}", entries.error());
+        return result;
+    }
+
+    for (const auto &entry : *entries) {
+        result.append(QVariantMap {
+            { QStringLiteral("title"), QString::fromStdString(entry.title) },
+            { QStringLiteral("completionDate"), Gui::DateUtils::timepointToQDate(entry.completionDate) },
+        });
+    }
+
+    return result;
+}
+
 void GuiController::dumpTaskDebug(const QString &taskUuid) const
 {
     const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
@@ -1062,7 +1090,7 @@ void GuiController::setTaskBeingEdited(const QString &uuid, QDate date, const QS
         if (task != nullptr) {
             _titleInEditor = QString::fromStdString(task->title);
             _tagInEditor = QString::fromStdString(task->tagName());
-            _isEveningInEditor = task->containsTag("evening");
+            _isEveningInEditor = task->containsTag(core::BUILTIN_TAG_ID_EVENING);
             _isGoalInEditor = task->isGoal.value_or(false);
             _isYearlyInEditor = task->isYearly.value_or(false);
 
@@ -1091,46 +1119,49 @@ void GuiController::stopPomodoroIfRunning(const QString &taskUuid)
 
 void GuiController::moveTaskToCurrent(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
     }
-    task->removeBuiltinTags();
-    task->addTag(pointless::core::BUILTIN_TAG_CURRENT);
-    taskModel()->updateTask(*task);
+    core::Task copy = *task;
+    copy.removeBuiltinTags();
+    copy.addTag(pointless::core::BUILTIN_TAG_CURRENT);
+    taskModel()->updateTask(copy);
 }
 
 void GuiController::moveTaskToSoon(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
     }
     stopPomodoroIfRunning(taskUuid);
-    task->removeBuiltinTags();
-    task->addTag(pointless::core::BUILTIN_TAG_SOON);
-    task->dueDate = std::nullopt;
-    taskModel()->updateTask(*task);
+    core::Task copy = *task;
+    copy.removeBuiltinTags();
+    copy.addTag(pointless::core::BUILTIN_TAG_SOON);
+    copy.dueDate = std::nullopt;
+    taskModel()->updateTask(copy);
 }
 
 void GuiController::moveTaskToLater(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
     }
 
     stopPomodoroIfRunning(taskUuid);
-    task->removeBuiltinTags();
-    taskModel()->updateTask(*task);
+    core::Task copy = *task;
+    copy.removeBuiltinTags();
+    taskModel()->updateTask(copy);
 }
 
 void GuiController::moveTaskToTomorrow(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
@@ -1140,29 +1171,31 @@ void GuiController::moveTaskToTomorrow(const QString &taskUuid)
         return;
 
     stopPomodoroIfRunning(taskUuid);
-    task->removeBuiltinTags();
+    core::Task copy = *task;
+    copy.removeBuiltinTags();
     const QDate tomorrow = Gui::Clock::today().addDays(1);
-    task->dueDate = Gui::DateUtils::qdateToTimepoint(tomorrow);
-    taskModel()->updateTask(*task);
+    copy.dueDate = Gui::DateUtils::qdateToTimepoint(tomorrow);
+    taskModel()->updateTask(copy);
 }
 
 void GuiController::moveTaskToEvening(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
     }
 
     stopPomodoroIfRunning(taskUuid);
-    if (task->addTag(core::BUILTIN_TAG_EVENING)) {
-        taskModel()->updateTask(*task);
+    core::Task copy = *task;
+    if (copy.addTag(core::BUILTIN_TAG_EVENING)) {
+        taskModel()->updateTask(copy);
     }
 }
 
 void GuiController::setTaskImportant(const QString &taskUuid, bool important)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
@@ -1179,17 +1212,18 @@ void GuiController::setTaskImportant(const QString &taskUuid, bool important)
 
 void GuiController::moveTaskToNextMonday(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
     }
 
     stopPomodoroIfRunning(taskUuid);
-    task->removeBuiltinTags();
+    core::Task copy = *task;
+    copy.removeBuiltinTags();
     const QDate nextMonday = Gui::DateUtils::nextMonday(Gui::Clock::today());
-    task->dueDate = Gui::DateUtils::qdateToTimepoint(nextMonday);
-    taskModel()->updateTask(*task);
+    copy.dueDate = Gui::DateUtils::qdateToTimepoint(nextMonday);
+    taskModel()->updateTask(copy);
 }
 
 bool GuiController::addTag(const QString &tagName)
@@ -1245,7 +1279,7 @@ void GuiController::cleanupOldData()
 
 void GuiController::openNotesEditor(const QString &taskUuid)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(taskUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", taskUuid);
         return;
@@ -1262,7 +1296,7 @@ void GuiController::openNotesEditor(const QString &taskUuid)
 
 void GuiController::saveNotes(const QString &notes)
 {
-    auto *task = _dataController->taskModel()->taskForUuid(_notesUuid);
+    const auto *task = _dataController->taskModel()->taskForUuid(_notesUuid);
     if (task == nullptr) {
         P_LOG_ERROR("Invalid task UUID: {}", _notesUuid);
         return;
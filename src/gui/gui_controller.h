@@ -18,6 +18,7 @@
 #include <QtQml/qqmlregistration.h>
 #include <QFutureWatcher>
 #include <QTimer>
+#include <QVariantList>
 #include <QVariantMap>
 
 #include <memory>
@@ -201,6 +202,10 @@ public:
     [[nodiscard]] Q_INVOKABLE int localRevision() const;
     [[nodiscard]] Q_INVOKABLE int numTasks() const;
 
+    /// Archived tasks whose title contains @p query, as { title, completionDate } maps, newest first.
+    /// The archive index is only read once something is searched for
+    [[nodiscard]] Q_INVOKABLE QVariantList searchArchive(const QString &query) const;
+
     Q_INVOKABLE void dumpTaskDebug(const QString &taskUuid) const;
     Q_INVOKABLE void dumpDebug() const;
     Q_INVOKABLE void onBackClicked();
@@ -22,7 +22,7 @@ bool PomodoroController::isRunning() const
 
 bool PomodoroController::isRunningThisTask(const pointless::core::Task &task) const
 {
-    return isRunningThisTask(QString::fromStdString(task.uuid));
+    return isRunningThisTask(QString::fromStdString(task.uuid.toString()));
 }
 
 bool PomodoroController::isRunningThisTask(const QString &taskUuid) const
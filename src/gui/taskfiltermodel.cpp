@@ -9,6 +9,8 @@
 #include "date_utils.h"
 #include "Clock.h"
 
+#include "core/Clock.h"
+#include "core/data.h"
 #include "core/task.h"
 #include "core/logger.h"
 
@@ -68,6 +70,7 @@ void TaskFilterModel::setViewType(ViewType type)
     }
     beginFilterChange();
     _viewType = type;
+    _dateSelection.reset();
     endFilterChange();
 
     emit viewTypeChanged();
@@ -84,6 +87,7 @@ void TaskFilterModel::setTagName(const QString &tagName)
         return;
     beginFilterChange();
     _tagName = tagName;
+    _tagId = pointless::core::TagDictionary::intern(tagName.toStdString());
     endFilterChange();
     Q_EMIT tagNameChanged();
 }
@@ -98,20 +102,26 @@ bool TaskFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source
         return true;
     }
 
-    const pointless::core::Task *task = taskModel->taskAt(source_row);
-    if (task == nullptr) {
+    using pointless::core::TaskColumn;
+
+    // Check the hot columns first, most rows are rejected without touching the Task
+    const auto &columns = taskModel->taskData().columns();
+    const auto row = static_cast<size_t>(source_row);
+    if (source_row < 0 || row >= columns.size()) {
         P_LOG_CRITICAL("Task is null at row {}", source_row);
         return false;
     }
 
-    if (task->isDone && !task->needsSyncToServer) {
+    if (columns.test(TaskColumn::Done, row) && !columns.test(TaskColumn::NeedsSyncToServer, row)) {
         return false;
     }
 
     if (_viewType == ViewType::Goals) {
-        return task->isGoal.value_or(false);
+        return columns.test(TaskColumn::Goal, row);
     }
 
+    const pointless::core::Task *task = taskModel->taskAt(source_row);
+
     auto *pomodoroCtrl = GuiController::instance()->pomodoroController();
     if (pomodoroCtrl->isRunning() && _showImmediateOnly) {
         return pomodoroCtrl->isRunningThisTask(*task);
@@ -122,12 +132,12 @@ bool TaskFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source
         return taskTitle.contains(_searchText, Qt::CaseInsensitive);
     }
 
-    if (_showImmediateOnly && task->isEvening()) {
+    if (_showImmediateOnly && columns.test(TaskColumn::TagEvening, row)) {
         return false;
     }
 
     if (!_tagName.isEmpty()) {
-        return task->containsTag(_tagName.toStdString());
+        return task->containsTag(_tagId);
     }
 
     if (_viewType == ViewType::Week && !_dateFilter.isValid()) {
@@ -136,27 +146,16 @@ bool TaskFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source
         return true;
     }
 
-    if (_viewType == ViewType::Week) {
-        const QDate taskDueDate = Gui::DateUtils::timepointToQDate(task->dueDate);
-        const bool viewIsToday = Gui::DateUtils::isToday(_dateFilter);
-        const bool hasDueDate = taskDueDate.isValid();
-        if (viewIsToday && task->isCurrent() && !hasDueDate) {
-            return true;
-        }
-
-        const bool isOverdue = Gui::DateUtils::isOverdue(taskDueDate, Gui::Clock::today());
-        if (isOverdue && viewIsToday) {
-            return true;
+    if (_viewType == ViewType::Week || _viewType == ViewType::Soon || _viewType == ViewType::Later) {
+        if (!dateSelection().contains(row)) {
+            return false;
         }
 
-        if (!isOverdue && taskDueDate == _dateFilter) {
+        if (_viewType == ViewType::Week) {
             return true;
         }
 
-    } else if ((_viewType == ViewType::Soon && task->isSoon()) || (_viewType == ViewType::Later && task->isLater())) {
-        if (!task->deviceCalendarUuid.has_value() && !task->isGoal.value_or(false)) {
-            return true;
-        }
+        return !task->deviceCalendarUuid.has_value() && !columns.test(TaskColumn::Goal, row);
     }
 
     return false;
@@ -218,6 +217,7 @@ void TaskFilterModel::setDateFilter(QDate date)
         return;
     beginFilterChange();
     _dateFilter = date;
+    _dateSelection.reset();
     endFilterChange();
 
     setObjectName(QStringLiteral("TaskFilterModel_Date_%1").arg(_dateFilter.toString(Qt::ISODate)));
@@ -225,6 +225,49 @@ void TaskFilterModel::setDateFilter(QDate date)
     emit dateFilterChanged();
 }
 
+const pointless::core::TaskSelection &TaskFilterModel::dateSelection() const
+{
+    using pointless::core::TaskColumn;
+    using pointless::core::TaskSelection;
+
+    const auto &data = qobject_cast<TaskModel *>(sourceModel())->taskData();
+    const QDateTime now = Gui::Clock::now();
+    const bool isStale = !_dateSelectionTime.isValid() || _dateSelectionTime.secsTo(now) >= 60 || _dateSelectionTime.date() != now.date();
+    if (_dateSelection && _dateSelectionVersion == data.columns().version() && !isStale)
+        return *_dateSelection;
+
+    _dateSelectionVersion = data.columns().version();
+    _dateSelectionTime = now;
+
+    if (_viewType == ViewType::Soon) {
+        _dateSelection = data.selectSoon(pointless::core::Clock::now());
+    } else if (_viewType == ViewType::Later) {
+        _dateSelection = data.selectLater(pointless::core::Clock::now());
+    } else {
+        const QDate today = Gui::Clock::today();
+        const auto todayStart = *Gui::DateUtils::qdateToTimepoint(today);
+        TaskSelection selection(data.columns(), false);
+
+        if (Gui::DateUtils::isToday(_dateFilter)) {
+            // Current tasks without a due date and anything overdue show up today
+            TaskSelection currentWithoutDueDate(data.columns());
+            currentWithoutDueDate.with(TaskColumn::TagCurrent).withoutDueDate();
+            selection.unite(currentWithoutDueDate);
+            selection.unite(data.selectDueBetween(std::chrono::system_clock::time_point::min(), todayStart));
+        }
+
+        if (_dateFilter >= today) {
+            const auto dayStart = *Gui::DateUtils::qdateToTimepoint(_dateFilter);
+            const auto dayEnd = *Gui::DateUtils::qdateToTimepoint(_dateFilter.addDays(1));
+            selection.unite(data.selectDueBetween(dayStart, dayEnd));
+        }
+
+        _dateSelection = std::move(selection);
+    }
+
+    return *_dateSelection;
+}
+
 void TaskFilterModel::evaluateEmpty()
 {
     const int currentCount = rowCount();
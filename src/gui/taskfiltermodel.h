@@ -3,10 +3,15 @@
 
 #pragma once
 
+#include "core/tag_list.h"
+#include "core/task_columns.h"
+
 #include <QSortFilterProxyModel>
 #include <QtQml/qqmlregistration.h>
 #include <QDate>
 
+#include <optional>
+
 class GuiController;
 
 class TaskFilterModel : public QSortFilterProxyModel
@@ -69,11 +74,18 @@ public:
 
 private:
     void evaluateEmpty();
+    [[nodiscard]] const pointless::core::TaskSelection &dateSelection() const;
 
     ViewType _viewType = ViewType::Week;
     QString _tagName;
+    pointless::core::TagId _tagId = 0;
     QDate _dateFilter;
     int _previousRowCount = 0;
     bool _showImmediateOnly = false;
     QString _searchText;
+
+    // Rows matching the date part of the Week, Soon and Later views, from the due date index
+    mutable std::optional<pointless::core::TaskSelection> _dateSelection;
+    mutable uint64_t _dateSelectionVersion = 0;
+    mutable QDateTime _dateSelectionTime;
 };
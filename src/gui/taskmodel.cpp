@@ -13,8 +13,17 @@
 #include <QString>
 #include <QStringList>
 
+#include <algorithm>
+
 using namespace pointless;
 
+namespace {
+
+// Each removal shifts the rows after it, past this many a reset is cheaper
+constexpr size_t MaxIncrementalRemovals = 64;
+
+}
+
 TaskModel::TaskModel(QObject *parent)
     : QAbstractListModel(parent)
 {
@@ -37,7 +46,7 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
 
     switch (role) {
     case UuidRole:
-        return QString::fromStdString(task.uuid);
+        return QString::fromStdString(task.uuid.toString());
     case TitleRole:
         return QString::fromStdString(task.title);
     case IsDoneRole:
@@ -74,7 +83,7 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
         }
         return {};
     case IsEveningRole:
-        if (task.containsTag(core::BUILTIN_TAG_EVENING))
+        if (task.containsTag(core::BUILTIN_TAG_ID_EVENING))
             return true;
 
         if (task.dueDate) {
@@ -117,7 +126,7 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const
         }
         return QString();
     case HasNotesRole:
-        return task.description.has_value() && !task.description->empty();
+        return localData().data().columns().test(core::TaskColumn::HasNotes, static_cast<size_t>(index.row()));
     case IsGoalRole:
         return task.isGoal.value_or(false);
     case IsYearlyRole:
@@ -178,26 +187,20 @@ const core::Task *TaskModel::taskAt(int row) const
     return &(localData().taskAt(row));
 }
 
-const core::Task *TaskModel::taskForUuid(const QString &taskUuid) const
+const core::Data &TaskModel::taskData() const
 {
-    return localData().taskForUuid(taskUuid.toStdString());
+    return localData().data();
 }
 
-core::Task *TaskModel::taskForUuid(const QString &taskUuid)
+const core::Task *TaskModel::taskForUuid(const QString &taskUuid) const
 {
     return localData().taskForUuid(taskUuid.toStdString());
 }
 
 int TaskModel::indexForTask(const QString &taskUuid) const
 {
-    const auto uuidStr = taskUuid.toStdString();
-    const auto &tasks = localData().data()._data.tasks;
-    for (size_t i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].uuid == uuidStr) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    const auto index = localData().data().indexOfTask(taskUuid.toStdString());
+    return index ? static_cast<int>(*index) : -1;
 }
 
 const core::LocalData &TaskModel::localData() const
@@ -219,6 +222,12 @@ DataController *TaskModel::dataController() const
 
 void TaskModel::addTask(const core::Task &task)
 {
+    // A batch resets the model when committed
+    if (dataController()->isBatching()) {
+        dataController()->addTask(task);
+        return;
+    }
+
     const int numTasks = static_cast<int>(localData().taskCount());
     beginInsertRows(QModelIndex(), numTasks, numTasks);
     dataController()->addTask(task);
@@ -261,7 +270,7 @@ void TaskModel::setTaskDone(const QString &taskUuid, bool isDone)
 
 void TaskModel::updateTask(const core::Task &task)
 {
-    const int idx = indexForTask(QString::fromStdString(task.uuid));
+    const int idx = indexForTask(QString::fromStdString(task.uuid.toString()));
     if (idx == -1) {
         P_LOG_ERROR("Failed to find index for task UUID: {}", task.uuid);
         return;
@@ -271,6 +280,63 @@ void TaskModel::updateTask(const core::Task &task)
     emit dataChanged(index(idx), index(idx));
 }
 
+void TaskModel::applyFileChanges(const core::LocalData::FileChanges &changes)
+{
+    auto &data = localData();
+
+    if (changes.removedTasks.size() > MaxIncrementalRemovals) {
+        beginResetModel();
+        data.beginBatch();
+        for (const auto &uuid : changes.removedTasks) {
+            data.removeTask(uuid);
+        }
+        data.commit();
+        for (const auto &task : changes.updatedTasks) {
+            data.storeTaskFromFile(task);
+        }
+        for (const auto &task : changes.addedTasks) {
+            data.storeTaskFromFile(task);
+        }
+        endResetModel();
+        emit countChanged();
+        return;
+    }
+
+    // Bottom up, so the rows still to remove don't move
+    std::vector<std::pair<size_t, core::Uuid>> removals;
+    removals.reserve(changes.removedTasks.size());
+    for (const auto &uuid : changes.removedTasks) {
+        if (const auto row = taskData().indexOfTask(uuid))
+            removals.emplace_back(*row, uuid);
+    }
+    std::ranges::sort(removals, std::greater {});
+    for (const auto &[row, uuid] : removals) {
+        beginRemoveRows(QModelIndex(), static_cast<int>(row), static_cast<int>(row));
+        data.removeTask(uuid);
+        endRemoveRows();
+    }
+
+    for (const auto &task : changes.updatedTasks) {
+        const auto row = taskData().indexOfTask(task.uuid);
+        if (!row)
+            continue;
+        data.storeTaskFromFile(task);
+        emit dataChanged(index(static_cast<int>(*row)), index(static_cast<int>(*row)));
+    }
+
+    if (!changes.addedTasks.empty()) {
+        const int first = static_cast<int>(data.taskCount());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(changes.addedTasks.size()) - 1);
+        for (const auto &task : changes.addedTasks) {
+            data.storeTaskFromFile(task);
+        }
+        endInsertRows();
+    }
+
+    if (!removals.empty() || !changes.addedTasks.empty())
+        emit countChanged();
+}
+
 void TaskModel::advanceYearlyTask(const QString &taskUuid)
 {
     const auto *task = taskForUuid(taskUuid);
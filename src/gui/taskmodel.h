@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "core/local_data.h"
 #include "core/task.h"
 
 #include <QAbstractListModel>
@@ -11,6 +12,7 @@
 #include <cstdint>
 
 namespace pointless::core {
+class Data;
 class LocalData;
 }
 
@@ -64,14 +66,18 @@ public:
     void reload();
     void addTask(const pointless::core::Task &task);
     [[nodiscard]] const pointless::core::Task *taskAt(int row) const;
+    [[nodiscard]] const pointless::core::Data &taskData() const;
     [[nodiscard]] const pointless::core::Task *taskForUuid(const QString &taskUuid) const;
-    [[nodiscard]] pointless::core::Task *taskForUuid(const QString &taskUuid);
     [[nodiscard]] int indexForTask(const QString &taskUuid) const;
 
     Q_INVOKABLE void setTaskDone(const QString &taskUuid, bool isDone);
     Q_INVOKABLE void advanceYearlyTask(const QString &taskUuid);
     void updateTask(const pointless::core::Task &task);
 
+    /// Applies what another process changed in the data file as row inserts, removals and
+    /// dataChanged, so views keep their state
+    void applyFileChanges(const pointless::core::LocalData::FileChanges &changes);
+
 Q_SIGNALS:
     void countChanged();
 
@@ -81,8 +81,12 @@ TEST(DataControllerTest, Sync)
 
     //-----------------------------------------------------------------------
     // #1: remote data doesn't exist, local data exists -> use local data, reset revision
-    controller._localData.data().setRevision(42);
-    ASSERT_TRUE(controller.merge({}).has_value());
+    core::Data withRevision = controller._localData.data();
+    withRevision.setRevision(42);
+    controller._localData.setData(std::move(withRevision));
+    auto mergedWithoutRemote = controller.merge(*controller._localData.beginRebase(), {});
+    ASSERT_TRUE(mergedWithoutRemote.has_value());
+    controller._localData.finishRebase(*mergedWithoutRemote);
     EXPECT_EQ(controller._localData.data().revision(), 0);
     ASSERT_EQ(controller._localData.data().tagCount(), 1);
     EXPECT_EQ(controller._localData.data().tagAt(0).name, "tag1");
@@ -162,7 +166,7 @@ TEST(DataControllerTest, Sync)
     anotherTask.uuid = "uuid-task-6";
     anotherTask.title = "anotherTask";
     anotherTask.revision = -1;
-    controller._localData.data().addTask(anotherTask);
+    controller._localData.addTask(anotherTask);
     EXPECT_EQ(controller._localData.data().newTasks().size(), 1);
 
     auto syncResult2 = controller.refreshBlocking();
@@ -329,6 +333,35 @@ TEST(DataControllerTest, TimerSavesToDisk)
     EXPECT_TRUE(diskData.data().taskAt(0).isDone);
 }
 
+TEST(DataControllerTest, ExitInstallsRunningRefresh)
+{
+    QGuiApplication _app(g_argc, g_argv);
+    core::Context::setContext({ IDataProvider::Type::TestSupabase, s_filename });
+    DataController controller;
+
+    core::Data localData;
+    core::Task task;
+    task.uuid = "uuid-task-exit";
+    task.title = "Created before exiting";
+    task.revision = -1;
+    task.needsSyncToServer = true;
+    localData.addTask(task);
+
+    initData(controller, localData, core::Data {});
+
+    // The finished slot never runs, there's no event loop while exiting
+    ASSERT_TRUE(controller.refresh(false).has_value());
+    controller.waitForAsyncOperations();
+
+    EXPECT_TRUE(controller._localData.data().newTasks().empty());
+
+    core::LocalData diskData;
+    ASSERT_TRUE(diskData.loadDataFromFile().has_value());
+    ASSERT_EQ(diskData.data().taskCount(), 1);
+    EXPECT_NE(diskData.data().taskAt(0).revision, -1);
+    EXPECT_FALSE(diskData.data().taskAt(0).needsSyncToServer);
+}
+
 TEST(DataControllerTest, MergeNeedsLocalSave)
 {
     QGuiApplication _app(g_argc, g_argv);
@@ -352,7 +385,7 @@ TEST(DataControllerTest, MergeNeedsLocalSave)
     auto pullResult = controller.pullRemoteData();
     ASSERT_TRUE(pullResult.has_value());
 
-    auto result = controller.merge(*pullResult);
+    auto result = controller.merge(controller._localData.data(), *pullResult);
     ASSERT_TRUE(result.has_value());
 
     EXPECT_TRUE(result->needsLocalSave);
@@ -433,7 +466,7 @@ TEST(DataControllerTest, RenameTagRoundtrip)
     EXPECT_EQ(controller._localData.data().taskAt(0).tags[0], "old-tag");
 
     // Rename the tag locally
-    ASSERT_TRUE(controller._localData.data().renameTag("old-tag", "new-tag"));
+    ASSERT_TRUE(controller._localData.renameTag("old-tag", "new-tag"));
 
     // Push via refresh
     auto syncResult2 = controller.refreshBlocking();